@@ -0,0 +1,180 @@
+#include "async_processor.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <cstdio>
+
+#define LOG_TAG "AsyncProcessor"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// Ring wait per iteration; bounds how long stop() takes
+static const int kRingWaitMs = 50;
+
+// Whether a frame runs on the streaming graph. The graph bypasses process(), so
+// settings it cannot honour (the frame scheduler's latency budget, the segment stage
+// and colour edges) keep the frame on process() instead.
+static bool runsStreaming(const StreamParams& params) {
+    return params.engine == ProcessingEngine::GapiStreaming && params.detector == EdgeDetectorType::Canny &&
+           params.budgetMs <= 0.0 && !params.segments && !params.colorEdges && GapiStreamingPipeline::available();
+}
+
+AsyncProcessor::AsyncProcessor(FrameRing& frameRing, std::shared_ptr<StreamContext> context)
+    : ring(frameRing), stream(std::move(context)) {}
+
+AsyncProcessor::~AsyncProcessor() {
+    stop();
+}
+
+bool AsyncProcessor::start(Callback onComplete, ThreadHook onThreadStart, ThreadHook onThreadExit) {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (isRunning.load(std::memory_order_acquire)) {
+        return false;
+    }
+    callback = std::move(onComplete);
+    isRunning.store(true, std::memory_order_release);
+    thread = std::thread(&AsyncProcessor::loop, this, std::move(onThreadStart), std::move(onThreadExit));
+    LOGI("Started completion thread for stream %d", stream->id());
+    return true;
+}
+
+void AsyncProcessor::stop() {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    isRunning.store(false, std::memory_order_release);
+    if (thread.joinable()) {
+        thread.join();
+        // Frames left in the ring would otherwise complete on restart with stale timestamps
+        ring.reset();
+        LOGI("Stopped completion thread for stream %d", stream->id());
+    }
+}
+
+uint64_t AsyncProcessor::submit(const uint8_t* data, int width, int height, int rowStride, int pixelStride,
+                                int64_t sensorTimestampNs) {
+    return submit(FrameView::gray(data, width, height, rowStride, pixelStride), sensorTimestampNs);
+}
+
+uint64_t AsyncProcessor::submit(const FrameView& frame, int64_t sensorTimestampNs) {
+    FrameMeta meta;
+    meta.sensorTimestampNs = sensorTimestampNs;
+    meta.enqueueNs = frameClockNs();
+    // Chroma nobody reads would only double the copy
+    bool chroma = stream->params().colorEdges;
+    uint64_t ticket = ring.push(chroma ? frame : frame.withoutChroma(), meta);
+    if (ticket == 0) {
+        return 0;
+    }
+
+    int64_t submitNs = frameClockNs() - meta.enqueueNs;
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    totalSubmitNs.fetch_add(submitNs, std::memory_order_relaxed);
+    int64_t max = maxSubmitNs.load(std::memory_order_relaxed);
+    while (submitNs > max && !maxSubmitNs.compare_exchange_weak(max, submitNs, std::memory_order_relaxed)) {
+    }
+    return ticket;
+}
+
+void AsyncProcessor::loop(ThreadHook onThreadStart, ThreadHook onThreadExit) {
+    ThreadPlacement::Scope placement(ThreadRole::Latency);
+    if (onThreadStart) {
+        onThreadStart();
+    }
+    streaming.setCallbacks(
+        [this](uint64_t ticket, const cv::Mat& edges, FrameMeta& meta) {
+            stream->publishExternal(edges, meta, &stabilized);
+            const cv::Mat& output = stabilized.empty() ? edges : stabilized;
+            FrameCompletion completion;
+            completion.ticket = ticket;
+            completion.meta = meta;
+            completion.width = output.cols;
+            completion.height = output.rows;
+            completion.edges = output.data;
+            completion.rowStride = static_cast<int>(output.step);
+            deliver(completion);
+        },
+        [this](const cv::Mat& edges, const FrameMeta& meta) { stream->encodeExternal(edges, meta); },
+        onThreadStart, onThreadExit);
+
+    while (isRunning.load(std::memory_order_acquire)) {
+        const FrameRing::Slot* slot = ring.acquire(kRingWaitMs);
+        if (!slot) {
+            continue;
+        }
+
+        uint64_t ticket = slot->sequence.load(std::memory_order_relaxed);
+        StreamParams params = stream->params();
+        if (runsStreaming(params)) {
+            // The pipeline copies the frame, so the slot goes straight back to the ring;
+            // a frame rejected for a full pipeline is skipped like an overwritten one
+            cv::Mat gray(slot->height, slot->width, CV_8UC1, slot->data, slot->width);
+            streaming.push(gray, ticket, slot->meta, params);
+            ring.release(slot);
+            continue;
+        }
+        // Switched away from the streaming engine or to a setting it cannot honour
+        // (no-op if it never ran)
+        streaming.stop();
+
+        // The slot is owned by this thread until released, so it is processed in place
+        FrameCompletion completion;
+        completion.ticket = ticket;
+        completion.width = slot->width;
+        completion.height = slot->height;
+        completion.meta = slot->meta;
+        cv::Mat edges;
+        bool ok = stream->process(FrameRing::viewOf(*slot), &completion.meta, &edges);
+        ring.release(slot);
+        if (!ok) {
+            // Dropped by the frame scheduler or failed; the stream counts it
+            continue;
+        }
+
+        completion.edges = edges.data;
+        completion.rowStride = static_cast<int>(edges.step);
+        deliver(completion);
+    }
+    streaming.stop();
+    if (onThreadExit) {
+        onThreadExit();
+    }
+}
+
+void AsyncProcessor::deliver(const FrameCompletion& completion) {
+    try {
+        if (callback) {
+            callback(completion);
+        }
+    } catch (const std::exception& e) {
+        LOGE("Completion callback failed: %s", e.what());
+    }
+    completed.fetch_add(1, std::memory_order_relaxed);
+    totalCompleteNs.fetch_add(frameClockNs() - completion.meta.enqueueNs, std::memory_order_relaxed);
+}
+
+AsyncProcessor::Stats AsyncProcessor::stats() const {
+    Stats s;
+    s.submitted = submitted.load(std::memory_order_relaxed);
+    s.completed = completed.load(std::memory_order_relaxed);
+    s.skipped = s.submitted > s.completed ? s.submitted - s.completed : 0;
+    if (s.submitted) {
+        s.avgSubmitUs = totalSubmitNs.load(std::memory_order_relaxed) / 1e3 / s.submitted;
+    }
+    s.maxSubmitUs = maxSubmitNs.load(std::memory_order_relaxed) / 1e3;
+    if (s.completed) {
+        s.avgCompleteMs = totalCompleteNs.load(std::memory_order_relaxed) / 1e6 / s.completed;
+    }
+    return s;
+}
+
+std::string AsyncProcessor::statsJson() const {
+    Stats s = stats();
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"running\":%s,\"submitted\":%llu,\"completed\":%llu,\"skipped\":%llu,"
+             "\"avgSubmitUs\":%.1f,\"maxSubmitUs\":%.1f,\"avgCompleteMs\":%.2f}",
+             running() ? "true" : "false", (unsigned long long)s.submitted, (unsigned long long)s.completed,
+             (unsigned long long)s.skipped, s.avgSubmitUs, s.maxSubmitUs, s.avgCompleteMs);
+    std::string json(buf);
+    json.pop_back();
+    json += ",\"streaming\":" + streaming.statsJson() + "}";
+    return json;
+}
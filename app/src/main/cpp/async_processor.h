@@ -0,0 +1,102 @@
+#ifndef ASYNC_PROCESSOR_H
+#define ASYNC_PROCESSOR_H
+
+#include "frame_ring.h"
+#include "gapi_streaming.h"
+#include "stream_registry.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Result of one submitted frame, valid only for the duration of the callback
+struct FrameCompletion {
+    uint64_t ticket = 0;
+    FrameMeta meta;
+    int width = 0;
+    int height = 0;
+    // Edge map (width x height, rowStride apart)
+    const uint8_t* edges = nullptr;
+    int rowStride = 0;
+};
+
+// Asynchronous submit/complete front end of a stream.
+//
+// submit() only copies the frame into the ring and returns a ticket, so the
+// caller (the camera callback) never waits for detection. A native completion
+// thread owns the processing loop and delivers each finished frame through the
+// callback. Frames overwritten in the ring or dropped by the frame scheduler
+// never complete; their tickets are simply skipped.
+//
+// With the G-API streaming engine selected the completion thread only feeds the
+// streaming pipeline, and completions arrive on the pipeline's pull thread (with
+// the same thread hooks), so consecutive frames overlap inside the graph. Frames
+// whose settings the graph cannot honour (budgetMs, segments, colorEdges) are
+// processed on the completion thread as usual.
+class AsyncProcessor {
+public:
+    using Callback = std::function<void(const FrameCompletion&)>;
+    // Run once on the completion thread after it starts / before it exits,
+    // e.g. to attach it to a Java VM
+    using ThreadHook = std::function<void()>;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        // Submitted but not completed: in flight, overwritten, dropped or failed
+        uint64_t skipped = 0;
+        double avgSubmitUs = 0.0;
+        double maxSubmitUs = 0.0;
+        // Enqueue to callback return
+        double avgCompleteMs = 0.0;
+    };
+
+    AsyncProcessor(FrameRing& ring, std::shared_ptr<StreamContext> stream);
+    ~AsyncProcessor();
+
+    AsyncProcessor(const AsyncProcessor&) = delete;
+    AsyncProcessor& operator=(const AsyncProcessor&) = delete;
+
+    // Start the completion thread; false if already running
+    bool start(Callback callback, ThreadHook onThreadStart = nullptr, ThreadHook onThreadExit = nullptr);
+    // Stop and join the completion thread and discard frames still in the ring
+    void stop();
+    bool running() const { return isRunning.load(std::memory_order_acquire); }
+
+    // Copy a frame into the ring; returns its ticket, or 0 if the frame was rejected.
+    // The U/V planes of YUV frames are only copied while the stream has colorEdges on.
+    uint64_t submit(const FrameView& frame, int64_t sensorTimestampNs = 0);
+    // Same for a Y plane
+    uint64_t submit(const uint8_t* data, int width, int height, int rowStride, int pixelStride,
+                    int64_t sensorTimestampNs = 0);
+
+    Stats stats() const;
+    GapiStreamingPipeline::Stats streamingStats() const { return streaming.stats(); }
+    std::string statsJson() const;
+
+private:
+    void loop(ThreadHook onThreadStart, ThreadHook onThreadExit);
+    void deliver(const FrameCompletion& completion);
+
+    FrameRing& ring;
+    std::shared_ptr<StreamContext> stream;
+    Callback callback;
+
+    std::mutex lifecycleMutex;
+    std::thread thread;
+    std::atomic<bool> isRunning{false};
+    GapiStreamingPipeline streaming;
+    // Stabilized edge map of the streaming frame being delivered (pull thread only)
+    cv::Mat stabilized;
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<int64_t> totalSubmitNs{0};
+    std::atomic<int64_t> maxSubmitNs{0};
+    std::atomic<int64_t> totalCompleteNs{0};
+};
+
+#endif // ASYNC_PROCESSOR_H
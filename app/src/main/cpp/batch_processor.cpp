@@ -0,0 +1,74 @@
+#include "batch_processor.h"
+#include "edge_log.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#define LOG_TAG "BatchProcessor"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+namespace {
+// Per-thread scratch, reused across frames and batches. A thread runs one frame at a
+// time because frames never run on the tiles' scheduler (see frameScheduler).
+struct BatchScratch {
+    cv::Mat luma;
+    cv::Mat blur;
+};
+thread_local BatchScratch scratch;
+}
+
+TaskScheduler& BatchProcessor::frameScheduler() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+bool BatchProcessor::valid(const FrameView& in, const MutableView& out) {
+    return in.valid() && out.data && out.width == in.width && out.height == in.height && out.rowStride >= out.width;
+}
+
+BatchProcessor::Result BatchProcessor::processBatch(const FrameView* in, MutableView* out, size_t count,
+                                                    const StreamParams& params, TaskScheduler& scheduler) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+
+    // Validate once so the workers run a tight loop
+    std::vector<int> work;
+    work.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (valid(in[i], out[i])) {
+            work.push_back(static_cast<int>(i));
+        } else {
+            result.failed++;
+        }
+    }
+    if (result.failed) {
+        LOGE("Skipping %zu invalid frame(s) of %zu", result.failed, count);
+    }
+
+    TaskScheduler& frames = &scheduler == &TaskScheduler::instance() ? frameScheduler() : scheduler;
+    std::atomic<size_t> failures{0};
+    // One frame per task: frames are independent, so whole frames balance better than tiles
+    frames.parallelFor(0, static_cast<int>(work.size()), 1, [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const FrameView& src = in[work[k]];
+            MutableView& dst = out[work[k]];
+            try {
+                // Only layouts the blur cannot read in place are staged in the scratch
+                cv::Mat gray = src.luma(scratch.luma);
+                ChromaPlanes chroma = src.chroma();
+                cv::Mat edges(dst.height, dst.width, CV_8UC1, dst.data, dst.rowStride);
+                // The stream path's detection, so engine, hysteresis and colour edges all apply
+                StreamContext::detect(gray, scratch.blur, edges, params, chroma.valid() ? &chroma : nullptr);
+            } catch (const cv::Exception& e) {
+                LOGE("Frame %d: OpenCV exception: %s", work[k], e.what());
+                failures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    result.failed += failures.load();
+    result.processed = count - result.failed;
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
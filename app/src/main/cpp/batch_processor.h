@@ -0,0 +1,48 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include "frame_view.h"
+#include "stream_registry.h"
+#include "task_scheduler.h"
+#include <cstddef>
+#include <cstdint>
+
+// Destination for an edge map; must match the geometry of its input frame
+struct MutableView {
+    uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int rowStride = 0;
+};
+
+// Offline edge detection over many stored frames.
+//
+// The batch is validated once up front, then whole frames are spread across the
+// task scheduler's threads. Each thread keeps its own blur scratch and writes the
+// edge map straight into the caller's output, so the steady state allocates
+// nothing. Every frame goes through StreamContext::detect, so the output is
+// bit-identical to StreamContext::process on the same frame and params for the
+// per-frame engines; the G-API engines run the imperative path here.
+class BatchProcessor {
+public:
+    struct Result {
+        size_t processed = 0;
+        size_t failed = 0;
+        double wallMs = 0.0;
+    };
+
+    // Process `count` frames (any FrameView layout) from `in` into `out` (same index);
+    // invalid pairs are skipped and counted as failed. Frames run on `scheduler`, their
+    // tiles on TaskScheduler::instance().
+    static Result processBatch(const FrameView* in, MutableView* out, size_t count, const StreamParams& params,
+                               TaskScheduler& scheduler = frameScheduler());
+
+    // Scheduler for whole-frame tasks. A thread waiting on its tiles runs whatever its
+    // scheduler has queued, so frames must never share one with the tiles: a frame
+    // started inside another would reuse the same thread's detection scratch.
+    static TaskScheduler& frameScheduler();
+
+    static bool valid(const FrameView& in, const MutableView& out);
+};
+
+#endif // BATCH_PROCESSOR_H
@@ -0,0 +1,192 @@
+#include "buffer_pool.h"
+#include "edge_log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#define LOG_TAG "BufferPool"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+static const size_t kAlignment = 64;
+static const int kMinShift = 6;   // 64 bytes
+static const int kMaxShift = 27;  // blocks above 128 MB are not cached
+static const int kClassesPerOctave = 4;
+// CV_AUTOSTEP from OpenCV's C API: "compute the step from the row size"
+static const size_t kAutoStep = 0x7fffffff;
+
+static size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+BufferPool& BufferPool::instance() {
+    // Never destroyed: Mats released during static destruction still find their pool
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+BufferPool::BufferPool(size_t maxCached) : maxCachedBytes(maxCached) {}
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+int BufferPool::sizeClass(size_t bytes, size_t& rounded) {
+    if (bytes <= (size_t(1) << kMinShift)) {
+        rounded = size_t(1) << kMinShift;
+        return 0;
+    }
+    // 2^k < bytes <= 2^(k+1), split into four steps (at least one cache line each)
+    int k = 63 - __builtin_clzll(static_cast<unsigned long long>(bytes - 1));
+    if (k >= kMaxShift) {
+        rounded = roundUp(bytes, kAlignment);
+        return -1;
+    }
+    size_t step = std::max(size_t(1) << (k - 2), kAlignment);
+    rounded = roundUp(bytes, step);
+    int sub = static_cast<int>((rounded - (size_t(1) << k)) / step);
+    return 1 + (k - kMinShift) * kClassesPerOctave + (sub - 1);
+}
+
+void* BufferPool::allocate(size_t bytes) {
+    size_t rounded = 0;
+    int index = sizeClass(bytes, rounded);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* block = nullptr;
+    if (index >= 0) {
+        SizeClass& cls = classes[index];
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        if (!cls.blocks.empty()) {
+            block = cls.blocks.back();
+            cls.blocks.pop_back();
+        }
+    }
+    if (block) {
+        poolHits.fetch_add(1, std::memory_order_relaxed);
+        cachedBytes.fetch_sub(rounded, std::memory_order_relaxed);
+    } else {
+        if (posix_memalign(&block, kAlignment, rounded) != 0) {
+            LOGE("Failed to allocate %zu bytes", rounded);
+            return nullptr;
+        }
+        systemAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t live = liveBytes.fetch_add(rounded, std::memory_order_relaxed) + rounded;
+    uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return block;
+}
+
+void BufferPool::release(void* block, size_t bytes) {
+    if (!block) {
+        return;
+    }
+    size_t rounded = 0;
+    int index = sizeClass(bytes, rounded);
+    liveBytes.fetch_sub(rounded, std::memory_order_relaxed);
+
+    if (index >= 0 && cachedBytes.load(std::memory_order_relaxed) + rounded <= maxCachedBytes) {
+        SizeClass& cls = classes[index];
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        cls.blocks.push_back(block);
+        cachedBytes.fetch_add(rounded, std::memory_order_relaxed);
+        return;
+    }
+    free(block);
+    systemFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferPool::trim() {
+    for (SizeClass& cls : classes) {
+        std::lock_guard<std::mutex> lock(cls.mutex);
+        for (void* block : cls.blocks) {
+            free(block);
+            systemFrees.fetch_add(1, std::memory_order_relaxed);
+        }
+        cls.blocks.clear();
+        cls.blocks.shrink_to_fit();
+    }
+    cachedBytes.store(0, std::memory_order_relaxed);
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    Stats s;
+    s.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    s.peakBytes = peakBytes.load(std::memory_order_relaxed);
+    s.cachedBytes = cachedBytes.load(std::memory_order_relaxed);
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.poolHits = poolHits.load(std::memory_order_relaxed);
+    s.systemAllocations = systemAllocations.load(std::memory_order_relaxed);
+    s.systemFrees = systemFrees.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::string BufferPool::statsJson() const {
+    Stats s = stats();
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "{\"liveBytes\":%llu,\"peakBytes\":%llu,\"cachedBytes\":%llu,\"allocations\":%llu,"
+             "\"poolHits\":%llu,\"systemAllocations\":%llu,\"systemFrees\":%llu}",
+             (unsigned long long)s.liveBytes, (unsigned long long)s.peakBytes, (unsigned long long)s.cachedBytes,
+             (unsigned long long)s.allocations, (unsigned long long)s.poolHits,
+             (unsigned long long)s.systemAllocations, (unsigned long long)s.systemFrees);
+    return buf;
+}
+
+void PooledMatAllocator::install() {
+    static PooledMatAllocator* allocator = new PooledMatAllocator(BufferPool::instance());
+    if (cv::Mat::getDefaultAllocator() != allocator) {
+        cv::Mat::setDefaultAllocator(allocator);
+        LOGI("Pooled Mat allocator installed");
+    }
+}
+
+cv::UMatData* PooledMatAllocator::allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                                           cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    // Same layout rules as OpenCV's standard allocator: dense steps unless the caller supplied them
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != kAutoStep) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = data0 ? static_cast<uchar*>(data0) : static_cast<uchar*>(pool.allocate(total));
+    if (!data) {
+        CV_Error(cv::Error::StsNoMem, "BufferPool allocation failed");
+    }
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool PooledMatAllocator::allocate(cv::UMatData* u, cv::AccessFlag /*accessFlags*/,
+                                  cv::UMatUsageFlags /*usageFlags*/) const {
+    return u != nullptr;
+}
+
+void PooledMatAllocator::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        pool.release(u->origdata, u->size);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
@@ -0,0 +1,89 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Size-classed pool of 64-byte aligned blocks.
+//
+// Requests are rounded up to one of four classes per power of two (at most 25%
+// slack) and released blocks are cached per class, so a steady stream of
+// same-sized frame buffers and OpenCV temporaries is served without touching the
+// system allocator after the first frame. Blocks above the largest class bypass
+// the cache.
+class BufferPool {
+public:
+    struct Stats {
+        uint64_t liveBytes = 0;
+        uint64_t peakBytes = 0;
+        uint64_t cachedBytes = 0;
+        uint64_t allocations = 0;
+        uint64_t poolHits = 0;
+        // Blocks obtained from / returned to the system allocator
+        uint64_t systemAllocations = 0;
+        uint64_t systemFrees = 0;
+    };
+
+    static BufferPool& instance();
+
+    explicit BufferPool(size_t maxCachedBytes = 64u << 20);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    void* allocate(size_t bytes);
+    // `bytes` must be the size passed to allocate()
+    void release(void* block, size_t bytes);
+    // Return every cached block to the system
+    void trim();
+
+    Stats stats() const;
+    std::string statsJson() const;
+
+private:
+    static const int kClassCount = 1 + (27 - 6) * 4;
+
+    struct alignas(64) SizeClass {
+        std::mutex mutex;
+        std::vector<void*> blocks;
+    };
+
+    static int sizeClass(size_t bytes, size_t& rounded);
+
+    const size_t maxCachedBytes;
+    SizeClass classes[kClassCount];
+
+    std::atomic<uint64_t> liveBytes{0};
+    std::atomic<uint64_t> peakBytes{0};
+    std::atomic<uint64_t> cachedBytes{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> poolHits{0};
+    std::atomic<uint64_t> systemAllocations{0};
+    std::atomic<uint64_t> systemFrees{0};
+};
+
+// cv::Mat allocator backed by BufferPool. Installed as the default allocator, it
+// serves every Mat the processing stages create, including OpenCV's temporaries.
+class PooledMatAllocator : public cv::MatAllocator {
+public:
+    explicit PooledMatAllocator(BufferPool& pool) : pool(pool) {}
+
+    // Make the process-wide pooled allocator the cv::Mat default (idempotent)
+    static void install();
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    BufferPool& pool;
+};
+
+#endif // BUFFER_POOL_H
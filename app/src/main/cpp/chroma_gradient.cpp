@@ -0,0 +1,159 @@
+#include "chroma_gradient.h"
+#include "simd_util.h"
+#include "task_scheduler.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Chroma rows per task, i.e. 32 luma rows
+const int kTileRows = 16;
+
+// Row y of a chroma plane as contiguous samples with one replicated sample on each side
+void unpackRow(const uint8_t* plane, const ChromaPlanes& c, int y, uint8_t* out) {
+    const uint8_t* src = plane + static_cast<size_t>(y) * c.rowStride;
+    if (c.pixelStride == 1) {
+        memcpy(out + 1, src, c.width);
+    } else {
+        for (int x = 0; x < c.width; x++) {
+            out[x + 1] = src[x * c.pixelStride];
+        }
+    }
+    out[0] = out[1];
+    out[c.width + 1] = out[c.width];
+}
+
+// 3x3 Sobel at sample x of unpacked rows a (above), b, c (below)
+inline void sobel(const uint8_t* a, const uint8_t* b, const uint8_t* c, int x, int& dx, int& dy) {
+    dx = (a[x + 2] - a[x]) + 2 * (b[x + 2] - b[x]) + (c[x + 2] - c[x]);
+    dy = (c[x] - a[x]) + 2 * (c[x + 1] - a[x + 1]) + (c[x + 2] - a[x + 2]);
+}
+
+#if CV_SIMD
+inline void sobel(const cv::v_int16* a, const cv::v_int16* b, const cv::v_int16* c, cv::v_int16& dx,
+                  cv::v_int16& dy) {
+    // Index 0, 1, 2: samples x - 1, x, x + 1
+    dx = cv::v_add(cv::v_add(cv::v_sub(a[2], a[0]), cv::v_shl<1>(cv::v_sub(b[2], b[0]))), cv::v_sub(c[2], c[0]));
+    dy = cv::v_add(cv::v_add(cv::v_sub(c[0], a[0]), cv::v_shl<1>(cv::v_sub(c[1], a[1]))), cv::v_sub(c[2], a[2]));
+}
+
+inline cv::v_uint16 magnitude(const cv::v_int16& dx, const cv::v_int16& dy) {
+    return cv::v_add(cv::v_abs(dx), cv::v_abs(dy));
+}
+#endif
+
+// Stronger weighted chroma gradient of each sample of chroma row y
+void chromaRow(const uint8_t* const* u, const uint8_t* const* v, int width, short* cdx, short* cdy) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const int half = cv::VTraits<cv::v_int16>::vlanes();
+    // Loads reach x + 2 + lanes, inside the padded row
+    for (; x + lanes <= width; x += lanes) {
+        cv::v_int16 ua[2][3], ub[2][3], uc[2][3], va[2][3], vb[2][3], vc[2][3];
+        for (int k = 0; k < 3; k++) {
+            expandS16(u[0] + x + k, ua[0][k], ua[1][k]);
+            expandS16(u[1] + x + k, ub[0][k], ub[1][k]);
+            expandS16(u[2] + x + k, uc[0][k], uc[1][k]);
+            expandS16(v[0] + x + k, va[0][k], va[1][k]);
+            expandS16(v[1] + x + k, vb[0][k], vb[1][k]);
+            expandS16(v[2] + x + k, vc[0][k], vc[1][k]);
+        }
+        for (int i = 0; i < 2; i++) {
+            cv::v_int16 udx, udy, vdx, vdy;
+            sobel(ua[i], ub[i], uc[i], udx, udy);
+            sobel(va[i], vb[i], vc[i], vdx, vdy);
+            cv::v_int16 useV = cv::v_reinterpret_as_s16(cv::v_gt(magnitude(vdx, vdy), magnitude(udx, udy)));
+            cv::v_store(cdx + x + i * half, cv::v_shl<ChromaGradient::kWeightShift>(cv::v_select(useV, vdx, udx)));
+            cv::v_store(cdy + x + i * half, cv::v_shl<ChromaGradient::kWeightShift>(cv::v_select(useV, vdy, udy)));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        int udx, udy, vdx, vdy;
+        sobel(u[0], u[1], u[2], x, udx, udy);
+        sobel(v[0], v[1], v[2], x, vdx, vdy);
+        bool useV = std::abs(vdx) + std::abs(vdy) > std::abs(udx) + std::abs(udy);
+        cdx[x] = static_cast<short>((useV ? vdx : udx) * (1 << ChromaGradient::kWeightShift));
+        cdy[x] = static_cast<short>((useV ? vdy : udy) * (1 << ChromaGradient::kWeightShift));
+    }
+}
+
+// Each chroma gradient covers two luma pixels of the row; it wins where it is stronger
+void overlayRow(const short* cdx, const short* cdy, int width, short* dx, short* dy) {
+    int x = 0;
+#if CV_SIMD
+    const int half = cv::VTraits<cv::v_int16>::vlanes();
+    for (; x + 2 * half <= width; x += 2 * half) {
+        cv::v_int16 cx[2], cy[2];
+        cv::v_int16 sx = cv::vx_load(cdx + x / 2);
+        cv::v_int16 sy = cv::vx_load(cdy + x / 2);
+        cv::v_zip(sx, sx, cx[0], cx[1]);
+        cv::v_zip(sy, sy, cy[0], cy[1]);
+        for (int i = 0; i < 2; i++) {
+            cv::v_int16 lx = cv::vx_load(dx + x + i * half);
+            cv::v_int16 ly = cv::vx_load(dy + x + i * half);
+            cv::v_int16 useChroma = cv::v_reinterpret_as_s16(cv::v_gt(magnitude(cx[i], cy[i]), magnitude(lx, ly)));
+            cv::v_store(dx + x + i * half, cv::v_select(useChroma, cx[i], lx));
+            cv::v_store(dy + x + i * half, cv::v_select(useChroma, cy[i], ly));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        short sx = cdx[x / 2];
+        short sy = cdy[x / 2];
+        if (std::abs(sx) + std::abs(sy) > std::abs(dx[x]) + std::abs(dy[x])) {
+            dx[x] = sx;
+            dy[x] = sy;
+        }
+    }
+}
+
+}  // namespace
+
+void ChromaGradient::combine(const ChromaPlanes& chroma, cv::Mat& dx, cv::Mat& dy) {
+    CV_Assert(dx.type() == CV_16SC1 && dy.type() == CV_16SC1 && dx.size() == dy.size());
+    if (!chroma.valid() || chroma.width != (dx.cols + 1) / 2 || chroma.height != (dx.rows + 1) / 2) {
+        return;
+    }
+    const ChromaPlanes c = chroma;
+    cv::Mat* gx = &dx;
+    cv::Mat* gy = &dy;
+    TaskScheduler::instance().parallelFor(0, c.height, kTileRows, [c, gx, gy](int begin, int end) {
+        // Three unpacked rows per plane, indexed by row modulo 3, plus the row's gradients;
+        // per worker, so they are only allocated when the resolution grows
+        const int padded = c.width + 2;
+        thread_local std::vector<uint8_t> rows;
+        thread_local std::vector<short> gradients;
+        rows.resize(static_cast<size_t>(6) * padded);
+        gradients.resize(static_cast<size_t>(2) * c.width);
+        uint8_t* uRows[3];
+        uint8_t* vRows[3];
+        for (int k = 0; k < 3; k++) {
+            uRows[k] = rows.data() + k * padded;
+            vRows[k] = rows.data() + (3 + k) * padded;
+        }
+        short* cdx = gradients.data();
+        short* cdy = cdx + c.width;
+        for (int y = begin - 1; y <= begin; y++) {
+            int clamped = std::max(y, 0);
+            unpackRow(c.u, c, clamped, uRows[(y + 3) % 3]);
+            unpackRow(c.v, c, clamped, vRows[(y + 3) % 3]);
+        }
+        for (int y = begin; y < end; y++) {
+            int below = std::min(y + 1, c.height - 1);
+            unpackRow(c.u, c, below, uRows[(y + 1) % 3]);
+            unpackRow(c.v, c, below, vRows[(y + 1) % 3]);
+            const uint8_t* u[3] = {uRows[(y + 2) % 3], uRows[y % 3], uRows[(y + 1) % 3]};
+            const uint8_t* v[3] = {vRows[(y + 2) % 3], vRows[y % 3], vRows[(y + 1) % 3]};
+            chromaRow(u, v, c.width, cdx, cdy);
+            for (int ly = 2 * y; ly < std::min(2 * y + 2, gx->rows); ly++) {
+                overlayRow(cdx, cdy, gx->cols, gx->ptr<short>(ly), gy->ptr<short>(ly));
+            }
+        }
+        cv::vx_cleanup();
+    });
+}
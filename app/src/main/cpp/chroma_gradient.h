@@ -0,0 +1,36 @@
+#ifndef CHROMA_GRADIENT_H
+#define CHROMA_GRADIENT_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+// U and V planes of a 4:2:0 frame, (width + 1) / 2 x (height + 1) / 2 samples each,
+// read in place through their row and pixel strides (pixel stride 1 for I420, 2 for
+// the interleaved NV12 / NV21 planes)
+struct ChromaPlanes {
+    const uint8_t* u = nullptr;
+    const uint8_t* v = nullptr;
+    int width = 0;
+    int height = 0;
+    int rowStride = 0;
+    int pixelStride = 1;
+
+    bool valid() const {
+        return u && v && width > 0 && height > 0 && pixelStride > 0 && rowStride >= (width - 1) * pixelStride + 1;
+    }
+};
+
+// Colour edges for Canny without an RGB conversion: one pass over the chroma planes
+// at their own half resolution adds the edges between regions of equal brightness.
+class ChromaGradient {
+public:
+    // Chroma contrast is compressed against luma in YUV; chroma gradients count double
+    static const int kWeightShift = 1;
+
+    // 3x3 Sobel of U and V; the stronger of the two (weighted) replaces the luma
+    // gradient in its 2x2 block of `dx`/`dy` wherever its |dx| + |dy| is larger.
+    // `dx`/`dy` are the CV_16SC1 3x3 Sobel gradients of the full-resolution luma.
+    static void combine(const ChromaPlanes& chroma, cv::Mat& dx, cv::Mat& dy);
+};
+
+#endif // CHROMA_GRADIENT_H
@@ -0,0 +1,218 @@
+#include "contour_encoder.h"
+#include "edge_encoder.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Step order when following a chain: 4-neighbours first so staircases are walked
+// pixel by pixel instead of leaving their corners behind as one-pixel chains
+const int kStepX[8] = {1, 0, -1, 0, 1, -1, 1, -1};
+const int kStepY[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+// Shortest chains that can close into a loop
+const size_t kMinClosedPoints = 4;
+
+// Working copy of the packed bitmap; pixels are cleared as chains consume them
+class BitPlane {
+public:
+    BitPlane(const uint8_t* packed, int width, int height)
+        : width(width), height(height), rowBytes(EdgeEncoder::packedRowBytes(width)),
+          bits(packed, packed + static_cast<size_t>(rowBytes) * height) {}
+
+    uint8_t* row(int y) { return bits.data() + static_cast<size_t>(y) * rowBytes; }
+    int bytesPerRow() const { return rowBytes; }
+
+    // Clear and return the pixel if it is set
+    bool take(int x, int y) {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return false;
+        }
+        uint8_t& byte = row(y)[x >> 3];
+        uint8_t mask = static_cast<uint8_t>(0x80 >> (x & 7));
+        if (!(byte & mask)) {
+            return false;
+        }
+        byte &= static_cast<uint8_t>(~mask);
+        return true;
+    }
+
+    // Follow unconsumed neighbours from `from`, appending each step to `chain`
+    void follow(cv::Point from, std::vector<cv::Point>& chain) {
+        for (;;) {
+            int k = 0;
+            while (k < 8 && !take(from.x + kStepX[k], from.y + kStepY[k])) {
+                k++;
+            }
+            if (k == 8) {
+                return;
+            }
+            from = cv::Point(from.x + kStepX[k], from.y + kStepY[k]);
+            chain.push_back(from);
+        }
+    }
+
+private:
+    int width;
+    int height;
+    int rowBytes;
+    std::vector<uint8_t> bits;
+};
+
+inline bool adjacent(const cv::Point& a, const cv::Point& b) {
+    return std::abs(a.x - b.x) <= 1 && std::abs(a.y - b.y) <= 1;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint32_t zigzag(int value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int unzigzag(uint32_t value) {
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+void ContourEncoder::trace(const uint8_t* packed, int width, int height, double epsilon,
+                           std::vector<EdgePolyline>& polylines) {
+    polylines.clear();
+    if (!packed || width <= 0 || height <= 0) {
+        return;
+    }
+    BitPlane plane(packed, width, height);
+    const int rowBytes = plane.bytesPerRow();
+    std::vector<cv::Point> chain;
+    std::vector<cv::Point> back;
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = plane.row(y);
+        for (int i = 0; i < rowBytes; i++) {
+            // Re-read the byte each time: tracing clears pixels to the right as well
+            while (row[i]) {
+                int bit = 0;
+                while (!(row[i] & (0x80 >> bit))) {
+                    bit++;
+                }
+                int x = i * 8 + bit;
+                plane.take(x, y);
+                cv::Point start(x, y);
+
+                // Scanning starts a chain at its first pixel in raster order, which may
+                // sit mid-chain, so walk both ways and join the halves
+                chain.assign(1, start);
+                plane.follow(start, chain);
+                back.clear();
+                plane.follow(start, back);
+                if (!back.empty()) {
+                    chain.insert(chain.begin(), back.rbegin(), back.rend());
+                }
+
+                EdgePolyline polyline;
+                polyline.closed = back.empty() && chain.size() >= kMinClosedPoints &&
+                                  adjacent(chain.front(), chain.back());
+                if (epsilon > 0 && chain.size() > 2) {
+                    cv::approxPolyDP(chain, polyline.points, epsilon, polyline.closed);
+                } else {
+                    polyline.points = chain;
+                }
+                polylines.push_back(std::move(polyline));
+            }
+        }
+    }
+}
+
+void ContourEncoder::encode(const std::vector<EdgePolyline>& polylines, int width, int height,
+                            std::vector<uint8_t>& out) {
+    out.clear();
+    out.push_back('E');
+    out.push_back('C');
+    out.push_back(kVersion);
+    putVarint(out, static_cast<uint32_t>(width));
+    putVarint(out, static_cast<uint32_t>(height));
+    putVarint(out, static_cast<uint32_t>(polylines.size()));
+    for (const EdgePolyline& polyline : polylines) {
+        putVarint(out, (static_cast<uint32_t>(polyline.points.size()) << 1) | (polyline.closed ? 1u : 0u));
+        cv::Point last(0, 0);
+        for (size_t i = 0; i < polyline.points.size(); i++) {
+            const cv::Point& p = polyline.points[i];
+            if (i == 0) {
+                putVarint(out, static_cast<uint32_t>(p.x));
+                putVarint(out, static_cast<uint32_t>(p.y));
+            } else {
+                putVarint(out, zigzag(p.x - last.x));
+                putVarint(out, zigzag(p.y - last.y));
+            }
+            last = p;
+        }
+    }
+}
+
+bool ContourEncoder::decode(const uint8_t* data, size_t size, int& width, int& height,
+                            std::vector<EdgePolyline>& polylines) {
+    polylines.clear();
+    if (!data || size < 3 || data[0] != 'E' || data[1] != 'C' || data[2] != kVersion) {
+        return false;
+    }
+    const uint8_t* p = data + 3;
+    const uint8_t* end = data + size;
+    uint32_t w, h, count;
+    if (!getVarint(p, end, w) || !getVarint(p, end, h) || !getVarint(p, end, count)) {
+        return false;
+    }
+    width = static_cast<int>(w);
+    height = static_cast<int>(h);
+    for (uint32_t c = 0; c < count; c++) {
+        uint32_t header;
+        if (!getVarint(p, end, header)) {
+            return false;
+        }
+        EdgePolyline polyline;
+        polyline.closed = (header & 1) != 0;
+        uint32_t points = header >> 1;
+        // Every point takes at least two bytes
+        if (points > static_cast<size_t>(end - p) / 2) {
+            return false;
+        }
+        polyline.points.reserve(points);
+        cv::Point last(0, 0);
+        for (uint32_t i = 0; i < points; i++) {
+            uint32_t a, b;
+            if (!getVarint(p, end, a) || !getVarint(p, end, b)) {
+                return false;
+            }
+            last = i == 0 ? cv::Point(static_cast<int>(a), static_cast<int>(b))
+                          : cv::Point(last.x + unzigzag(a), last.y + unzigzag(b));
+            polyline.points.push_back(last);
+        }
+        polylines.push_back(std::move(polyline));
+    }
+    return p == end;
+}
+
+void ContourEncoder::encodePacked(const uint8_t* packed, int width, int height, double epsilon,
+                                  std::vector<uint8_t>& out) {
+    std::vector<EdgePolyline> polylines;
+    trace(packed, width, height, epsilon, polylines);
+    encode(polylines, width, height, out);
+}
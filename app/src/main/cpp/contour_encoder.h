@@ -0,0 +1,45 @@
+#ifndef CONTOUR_ENCODER_H
+#define CONTOUR_ENCODER_H
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One simplified edge chain
+struct EdgePolyline {
+    std::vector<cv::Point> points;
+    bool closed = false;
+};
+
+// Vector output for binary edge maps: edge chains traced from the packed bitmap,
+// simplified with cv::approxPolyDP and serialized as varints.
+//
+// Format (all integers unsigned LEB128 varints unless noted):
+//   'E' 'C' version(1 byte = 1)
+//   width, height, polyline count
+//   per polyline: (point count << 1) | closed,
+//                 first point x, y, then each following point as zigzag dx, dy
+// A vertex costs two bytes for steps under 64 pixels, so the size follows the
+// length and curvature of the edges rather than the frame area.
+class ContourEncoder {
+public:
+    static constexpr uint8_t kVersion = 1;
+
+    // Trace 8-connected edge chains of a 1 bpp bitmap (EdgeEncoder::packBits layout).
+    // A chain ends at its endpoints or at a junction, where the remaining branches
+    // become chains of their own. `epsilon` <= 0 keeps every pixel of a chain.
+    static void trace(const uint8_t* packed, int width, int height, double epsilon,
+                      std::vector<EdgePolyline>& polylines);
+
+    static void encode(const std::vector<EdgePolyline>& polylines, int width, int height,
+                       std::vector<uint8_t>& out);
+    static bool decode(const uint8_t* data, size_t size, int& width, int& height,
+                       std::vector<EdgePolyline>& polylines);
+
+    // trace + encode
+    static void encodePacked(const uint8_t* packed, int width, int height, double epsilon,
+                             std::vector<uint8_t>& out);
+};
+
+#endif // CONTOUR_ENCODER_H
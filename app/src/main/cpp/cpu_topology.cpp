@@ -0,0 +1,265 @@
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define LOG_TAG "CpuTopology"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+const char* const CpuTopology::kDefaultSysfsRoot = "/sys/devices/system/cpu";
+
+static bool readNumber(const std::string& path, int64_t& value) {
+    std::ifstream in(path);
+    return static_cast<bool>(in >> value);
+}
+
+CpuTopology CpuTopology::discover(const std::string& root) {
+    CpuTopology topology;
+    DIR* dir = opendir(root.c_str());
+    if (!dir) {
+        LOGE("Cannot read %s", root.c_str());
+        return topology;
+    }
+    while (dirent* entry = readdir(dir)) {
+        int id = 0;
+        char tail = 0;
+        if (sscanf(entry->d_name, "cpu%d%c", &id, &tail) != 1) {
+            continue;
+        }
+        std::string base = root + "/" + entry->d_name;
+        int64_t online = 1;
+        // cpu0 usually has no "online" file: it cannot be taken offline
+        if (readNumber(base + "/online", online) && online == 0) {
+            continue;
+        }
+        CpuInfo cpu;
+        cpu.id = id;
+        int64_t capacity = 0;
+        cpu.capacity = readNumber(base + "/cpu_capacity", capacity) ? static_cast<int>(capacity) : 0;
+        readNumber(base + "/cpufreq/cpuinfo_max_freq", cpu.maxFreqKhz);
+        topology.cpuList.push_back(cpu);
+    }
+    closedir(dir);
+    std::sort(topology.cpuList.begin(), topology.cpuList.end(),
+              [](const CpuInfo& a, const CpuInfo& b) { return a.id < b.id; });
+
+    // Without cpu_capacity, rank cores by maximum frequency
+    int64_t maxFreq = 0;
+    bool haveCapacity = false;
+    for (const CpuInfo& cpu : topology.cpuList) {
+        maxFreq = std::max(maxFreq, cpu.maxFreqKhz);
+        haveCapacity = haveCapacity || cpu.capacity > 0;
+    }
+    for (CpuInfo& cpu : topology.cpuList) {
+        if (!haveCapacity) {
+            cpu.capacity = maxFreq > 0 ? static_cast<int>(cpu.maxFreqKhz * 1024 / maxFreq) : 1024;
+        }
+    }
+    LOGI("Discovered %zu CPU(s)%s", topology.cpuList.size(), topology.heterogeneous() ? ", heterogeneous" : "");
+    return topology;
+}
+
+bool CpuTopology::heterogeneous() const {
+    for (const CpuInfo& cpu : cpuList) {
+        if (cpu.capacity != cpuList.front().capacity) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> CpuTopology::allCores() const {
+    std::vector<int> ids;
+    for (const CpuInfo& cpu : cpuList) {
+        ids.push_back(cpu.id);
+    }
+    return ids;
+}
+
+std::vector<int> CpuTopology::performanceCores() const {
+    if (!heterogeneous()) {
+        return allCores();
+    }
+    int lowest = cpuList.front().capacity;
+    for (const CpuInfo& cpu : cpuList) {
+        lowest = std::min(lowest, cpu.capacity);
+    }
+    std::vector<int> ids;
+    for (const CpuInfo& cpu : cpuList) {
+        if (cpu.capacity > lowest) {
+            ids.push_back(cpu.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> CpuTopology::efficiencyCores() const {
+    if (!heterogeneous()) {
+        return allCores();
+    }
+    int lowest = cpuList.front().capacity;
+    for (const CpuInfo& cpu : cpuList) {
+        lowest = std::min(lowest, cpu.capacity);
+    }
+    std::vector<int> ids;
+    for (const CpuInfo& cpu : cpuList) {
+        if (cpu.capacity == lowest) {
+            ids.push_back(cpu.id);
+        }
+    }
+    return ids;
+}
+
+static std::string idsJson(const std::vector<int>& ids) {
+    std::string json = "[";
+    for (size_t i = 0; i < ids.size(); i++) {
+        json += (i ? "," : "") + std::to_string(ids[i]);
+    }
+    return json + "]";
+}
+
+std::string CpuTopology::toJson() const {
+    std::string json = "{\"cpus\":[";
+    char buf[96];
+    for (size_t i = 0; i < cpuList.size(); i++) {
+        snprintf(buf, sizeof(buf), "%s{\"id\":%d,\"capacity\":%d,\"maxFreqKhz\":%lld}", i ? "," : "",
+                 cpuList[i].id, cpuList[i].capacity, (long long)cpuList[i].maxFreqKhz);
+        json += buf;
+    }
+    json += "],\"performance\":" + idsJson(performanceCores()) + ",\"efficiency\":" + idsJson(efficiencyCores()) + "}";
+    return json;
+}
+
+static int currentTid() {
+    return static_cast<int>(syscall(SYS_gettid));
+}
+
+ThreadPlacement& ThreadPlacement::instance() {
+    // Never destroyed: pool threads may unregister during static destruction
+    static ThreadPlacement* placement = [] {
+        const char* root = getenv("EDGE_CPU_SYSFS_ROOT");
+        return new ThreadPlacement(CpuTopology::discover(root ? root : CpuTopology::kDefaultSysfsRoot));
+    }();
+    return *placement;
+}
+
+ThreadPlacement::ThreadPlacement(CpuTopology topology, PlacementPolicy policy)
+    : topo(std::move(topology)), current(policy) {}
+
+ThreadPlacement::Scope::Scope(ThreadRole role) : tid(currentTid()) {
+    ThreadPlacement& placement = instance();
+    std::lock_guard<std::mutex> lock(placement.mutex);
+    placement.threads[tid] = role;
+    placement.pinLocked(tid, role);
+}
+
+ThreadPlacement::Scope::~Scope() {
+    ThreadPlacement& placement = instance();
+    std::lock_guard<std::mutex> lock(placement.mutex);
+    placement.threads.erase(tid);
+}
+
+void ThreadPlacement::setPolicy(PlacementPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (policy == current) {
+        return;
+    }
+    current = policy;
+    // Re-pin running threads; Off widens them back to every core
+    for (const auto& entry : threads) {
+        pinLocked(entry.first, entry.second);
+    }
+    LOGI("Thread placement policy: %s (%zu thread(s))", policyName(policy), threads.size());
+}
+
+PlacementPolicy ThreadPlacement::policy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+std::vector<int> ThreadPlacement::cpusFor(ThreadRole role) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cpusForLocked(role);
+}
+
+std::vector<int> ThreadPlacement::cpusForLocked(ThreadRole role) const {
+    switch (current) {
+        case PlacementPolicy::Split:
+            return role == ThreadRole::Latency ? topo.performanceCores() : topo.efficiencyCores();
+        case PlacementPolicy::Performance:
+            return topo.performanceCores();
+        default:
+            return topo.allCores();
+    }
+}
+
+bool ThreadPlacement::pinLocked(int tid, ThreadRole role) {
+    std::vector<int> cpus = cpusForLocked(role);
+    if (cpus.empty()) {
+        // Unknown topology: leave the thread alone
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+        // Typically a fake topology naming CPUs this machine does not have
+        if (pinFailures++ == 0) {
+            LOGE("sched_setaffinity(%d) failed: %s", tid, strerror(errno));
+        }
+        return false;
+    }
+    pinned++;
+    return true;
+}
+
+const char* ThreadPlacement::policyName(PlacementPolicy policy) {
+    switch (policy) {
+        case PlacementPolicy::Off: return "off";
+        case PlacementPolicy::Split: return "split";
+        case PlacementPolicy::Performance: return "performance";
+        default: return "unknown";
+    }
+}
+
+bool ThreadPlacement::parsePolicy(const std::string& name, PlacementPolicy& policy) {
+    for (PlacementPolicy candidate : {PlacementPolicy::Off, PlacementPolicy::Split, PlacementPolicy::Performance}) {
+        if (name == policyName(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ThreadPlacement::statsJson() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int latency = 0;
+    int background = 0;
+    for (const auto& entry : threads) {
+        (entry.second == ThreadRole::Latency ? latency : background)++;
+    }
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "{\"policy\":\"%s\",\"latencyThreads\":%d,\"backgroundThreads\":%d,\"pinned\":%llu,\"pinFailures\":%llu,"
+             "\"topology\":",
+             policyName(current), latency, background, (unsigned long long)pinned, (unsigned long long)pinFailures);
+    std::string json(buf);
+    json += topo.toJson();
+    json += ",\"latencyCpus\":" + idsJson(cpusForLocked(ThreadRole::Latency)) +
+            ",\"backgroundCpus\":" + idsJson(cpusForLocked(ThreadRole::Background)) + "}";
+    return json;
+}
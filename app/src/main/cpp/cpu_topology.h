@@ -0,0 +1,102 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct CpuInfo {
+    int id = 0;
+    // Relative compute capacity, 1024 for the fastest core (as in sysfs cpu_capacity)
+    int capacity = 1024;
+    int64_t maxFreqKhz = 0;
+};
+
+// CPU capacities read from sysfs. On big.LITTLE parts the lowest-capacity cores are
+// the efficiency cores and every faster cluster counts as performance cores.
+class CpuTopology {
+public:
+    static const char* const kDefaultSysfsRoot;
+
+    // Read <root>/cpuN/cpu_capacity and <root>/cpuN/cpufreq/cpuinfo_max_freq for online CPUs.
+    // Capacity falls back to max frequency relative to the fastest core.
+    static CpuTopology discover(const std::string& root = kDefaultSysfsRoot);
+
+    const std::vector<CpuInfo>& cpus() const { return cpuList; }
+    bool heterogeneous() const;
+    std::vector<int> allCores() const;
+    // Homogeneous systems report every core in both sets
+    std::vector<int> performanceCores() const;
+    std::vector<int> efficiencyCores() const;
+
+    std::string toJson() const;
+
+private:
+    std::vector<CpuInfo> cpuList;
+};
+
+// Kind of work a thread does, which decides where it may run
+enum class ThreadRole {
+    Latency,     // detection, blur tiles, frame completion: on the critical path of every frame
+    Background,  // JPEG encode, publishing: may trail behind
+};
+
+enum class PlacementPolicy {
+    Off,          // no affinity; the kernel scheduler decides
+    Split,        // latency threads on performance cores, background threads on efficiency cores
+    Performance,  // every processing thread on performance cores
+};
+
+// Pins processing threads to CPU sets by role with sched_setaffinity.
+//
+// Threads register for their lifetime with a Scope, so a policy change re-pins
+// threads that are already running. OpenCV's own pool threads inherit the mask of
+// the thread that first runs a parallel region, i.e. a latency thread.
+class ThreadPlacement {
+public:
+    // Register (and pin) the calling thread for its lifetime
+    class Scope {
+    public:
+        explicit Scope(ThreadRole role);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        int tid;
+    };
+
+    // Topology from EDGE_CPU_SYSFS_ROOT if set (fake sysfs trees on hosts), else /sys
+    static ThreadPlacement& instance();
+
+    explicit ThreadPlacement(CpuTopology topology, PlacementPolicy policy = PlacementPolicy::Split);
+
+    void setPolicy(PlacementPolicy policy);
+    PlacementPolicy policy() const;
+    const CpuTopology& topology() const { return topo; }
+
+    // CPUs a thread of `role` may run on under the current policy
+    std::vector<int> cpusFor(ThreadRole role) const;
+
+    static const char* policyName(PlacementPolicy policy);
+    static bool parsePolicy(const std::string& name, PlacementPolicy& policy);
+
+    std::string statsJson() const;
+
+private:
+    std::vector<int> cpusForLocked(ThreadRole role) const;
+    bool pinLocked(int tid, ThreadRole role);
+
+    const CpuTopology topo;
+    mutable std::mutex mutex;
+    PlacementPolicy current;
+    // Registered threads by kernel thread id
+    std::map<int, ThreadRole> threads;
+    uint64_t pinned = 0;
+    uint64_t pinFailures = 0;
+};
+
+#endif // CPU_TOPOLOGY_H
@@ -0,0 +1,312 @@
+#include "edge_detector.h"
+#include "simd_util.h"
+#include "stream_registry.h"
+#include "union_find_canny.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+const char* edgeDetectorName(EdgeDetectorType type) {
+    switch (type) {
+        case EdgeDetectorType::Canny: return "canny";
+        case EdgeDetectorType::Sobel: return "sobel";
+        case EdgeDetectorType::Scharr: return "scharr";
+        case EdgeDetectorType::Laplacian: return "laplacian";
+        case EdgeDetectorType::DoG: return "dog";
+        default: return "unknown";
+    }
+}
+
+bool parseEdgeDetector(const std::string& name, EdgeDetectorType& type) {
+    for (EdgeDetectorType candidate : {EdgeDetectorType::Canny, EdgeDetectorType::Sobel, EdgeDetectorType::Scharr,
+                                       EdgeDetectorType::Laplacian, EdgeDetectorType::DoG}) {
+        if (name == edgeDetectorName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+class CannyDetector : public EdgeDetector {
+public:
+    EdgeDetectorType type() const override { return EdgeDetectorType::Canny; }
+
+    void detect(const cv::Mat& src, cv::Mat& edges, const StreamParams& p) const override {
+        // Explicit gradients for union-find hysteresis or for the segment stage to reuse
+        bool gradients = p.hysteresis == HysteresisEngine::UnionFind || p.segments;
+        if (!gradients || p.cannyAperture > 5) {
+            cv::Canny(src, edges, p.lowThreshold, p.highThreshold, p.cannyAperture, p.cannyL2);
+            return;
+        }
+        // The gradients cv::Canny computes internally
+        thread_local cv::Mat dx;
+        thread_local cv::Mat dy;
+        cv::Sobel(src, dx, CV_16S, 1, 0, p.cannyAperture, 1, 0, cv::BORDER_REPLICATE);
+        cv::Sobel(src, dy, CV_16S, 0, 1, p.cannyAperture, 1, 0, cv::BORDER_REPLICATE);
+        UnionFindCanny::fromGradients(dx, dy, edges, p);
+    }
+};
+
+// 3x3 derivative kernels: [side, center, side] smoothing across the derivative direction
+struct SobelKernel {
+    static const int kSide = 1;
+    static const int kCenter = 2;
+};
+
+struct ScharrKernel {
+    static const int kSide = 3;
+    static const int kCenter = 10;
+};
+
+#if CV_SIMD
+template <int K>
+inline cv::v_int16 weigh(const cv::v_int16& v) {
+    if (K == 1) {
+        return v;
+    }
+    if (K == 2) {
+        return cv::v_add(v, v);
+    }
+    return cv::v_mul_wrap(v, cv::vx_setall_s16(static_cast<short>(K)));
+}
+
+// |dx| + |dy| from the 3x3 neighbourhood: rows a, b, c and columns 0 (x-1), 1 (x), 2 (x+1).
+// Scharr peaks at 2 * 16 * 255, well inside 16 bits.
+template <typename K>
+inline cv::v_uint16 gradientL1(const cv::v_int16& a0, const cv::v_int16& a1, const cv::v_int16& a2,
+                               const cv::v_int16& b0, const cv::v_int16& b2,
+                               const cv::v_int16& c0, const cv::v_int16& c1, const cv::v_int16& c2) {
+    cv::v_int16 dx = cv::v_add(cv::v_add(weigh<K::kSide>(cv::v_sub(a2, a0)), weigh<K::kCenter>(cv::v_sub(b2, b0))),
+                               weigh<K::kSide>(cv::v_sub(c2, c0)));
+    cv::v_int16 dy = cv::v_add(cv::v_add(weigh<K::kSide>(cv::v_sub(c0, a0)), weigh<K::kCenter>(cv::v_sub(c1, a1))),
+                               weigh<K::kSide>(cv::v_sub(c2, a2)));
+    return cv::v_add(cv::v_abs(dx), cv::v_abs(dy));
+}
+#endif
+
+// Thresholded gradient magnitude without non-maximum suppression or hysteresis
+template <typename K>
+class GradientDetector : public EdgeDetector {
+public:
+    explicit GradientDetector(EdgeDetectorType type) : kind(type) {}
+
+    EdgeDetectorType type() const override { return kind; }
+
+    void detect(const cv::Mat& src, cv::Mat& edges, const StreamParams& p) const override {
+        CV_Assert(src.type() == CV_8UC1);
+        edges.create(src.size(), CV_8UC1);
+        // Sobel weights sum to 4 per axis, the unit Canny's thresholds are given in
+        const int weight = 2 * K::kSide + K::kCenter;
+        const int threshold = std::min(65535, std::max(0, cvFloor(p.highThreshold * weight / 4)));
+        const int rows = src.rows;
+        const int cols = src.cols;
+        for (int y = 0; y < rows; y++) {
+            // Replicated border, as cv::Sobel's default
+            const uchar* a = src.ptr<uchar>(std::max(y - 1, 0));
+            const uchar* b = src.ptr<uchar>(y);
+            const uchar* c = src.ptr<uchar>(std::min(y + 1, rows - 1));
+            uchar* out = edges.ptr<uchar>(y);
+            out[0] = magnitude(a, b, c, 0, cols) > threshold ? 255 : 0;
+            int x = 1;
+#if CV_SIMD
+            const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+            const cv::v_uint16 vthreshold = cv::vx_setall_u16(static_cast<ushort>(threshold));
+            // Loads reach x + lanes, which must stay inside the row
+            for (; x + lanes < cols; x += lanes) {
+                cv::v_int16 a0[2], a1[2], a2[2], b0[2], b2[2], c0[2], c1[2], c2[2];
+                expandS16(a + x - 1, a0[0], a0[1]);
+                expandS16(a + x, a1[0], a1[1]);
+                expandS16(a + x + 1, a2[0], a2[1]);
+                expandS16(b + x - 1, b0[0], b0[1]);
+                expandS16(b + x + 1, b2[0], b2[1]);
+                expandS16(c + x - 1, c0[0], c0[1]);
+                expandS16(c + x, c1[0], c1[1]);
+                expandS16(c + x + 1, c2[0], c2[1]);
+                cv::v_uint16 lo = cv::v_gt(gradientL1<K>(a0[0], a1[0], a2[0], b0[0], b2[0], c0[0], c1[0], c2[0]),
+                                           vthreshold);
+                cv::v_uint16 hi = cv::v_gt(gradientL1<K>(a0[1], a1[1], a2[1], b0[1], b2[1], c0[1], c1[1], c2[1]),
+                                           vthreshold);
+                // Masks are 0xFFFF, which saturates to 255
+                cv::v_store(out + x, cv::v_pack(lo, hi));
+            }
+#endif
+            for (; x < cols; x++) {
+                out[x] = magnitude(a, b, c, x, cols) > threshold ? 255 : 0;
+            }
+        }
+        cv::vx_cleanup();
+    }
+
+private:
+    static int magnitude(const uchar* a, const uchar* b, const uchar* c, int x, int cols) {
+        int l = std::max(x - 1, 0);
+        int r = std::min(x + 1, cols - 1);
+        int dx = K::kSide * (a[r] - a[l]) + K::kCenter * (b[r] - b[l]) + K::kSide * (c[r] - c[l]);
+        int dy = K::kSide * (c[l] - a[l]) + K::kCenter * (c[x] - a[x]) + K::kSide * (c[r] - a[r]);
+        return std::abs(dx) + std::abs(dy);
+    }
+
+    const EdgeDetectorType kind;
+};
+
+// Second-derivative responses whose zero crossings are edges. Values fit in int16.
+struct LaplacianResponse {
+    static void prepare(const cv::Mat&, cv::Mat&, const StreamParams&) {}
+
+    // 4-neighbour Laplacian of row y with replicated borders
+    static void row(const cv::Mat& src, const cv::Mat&, int y, short* out) {
+        const int cols = src.cols;
+        const uchar* up = src.ptr<uchar>(std::max(y - 1, 0));
+        const uchar* p = src.ptr<uchar>(y);
+        const uchar* down = src.ptr<uchar>(std::min(y + 1, src.rows - 1));
+        out[0] = static_cast<short>(up[0] + down[0] + p[0] + p[std::min(1, cols - 1)] - 4 * p[0]);
+        int x = 1;
+#if CV_SIMD
+        const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+        const int half = cv::VTraits<cv::v_int16>::vlanes();
+        for (; x + lanes < cols; x += lanes) {
+            cv::v_int16 u[2], d[2], l[2], r[2], m[2];
+            expandS16(up + x, u[0], u[1]);
+            expandS16(down + x, d[0], d[1]);
+            expandS16(p + x - 1, l[0], l[1]);
+            expandS16(p + x + 1, r[0], r[1]);
+            expandS16(p + x, m[0], m[1]);
+            for (int i = 0; i < 2; i++) {
+                cv::v_int16 sum = cv::v_add(cv::v_add(u[i], d[i]), cv::v_add(l[i], r[i]));
+                cv::v_store(out + x + i * half, cv::v_sub(sum, cv::v_shl<2>(m[i])));
+            }
+        }
+#endif
+        for (; x < cols; x++) {
+            int r = std::min(x + 1, cols - 1);
+            out[x] = static_cast<short>(up[x] + down[x] + p[x - 1] + p[r] - 4 * p[x]);
+        }
+    }
+};
+
+// Difference between the input (blurred at sigma) and a copy blurred to 1.6 sigma,
+// which approximates the Laplacian of Gaussian
+struct DogResponse {
+    static constexpr double kSigmaRatio = 1.6;
+    // Brings DoG contrast to about the Laplacian's, so both share lowThreshold
+    static const int kShift = 3;
+
+    static void prepare(const cv::Mat& src, cv::Mat& wide, const StreamParams& p) {
+        double sigma = p.blurSigma > 0 ? p.blurSigma : 1.0;
+        // Blurring again by s adds in quadrature: sigma^2 + s^2 = (1.6 sigma)^2
+        cv::GaussianBlur(src, wide, cv::Size(), sigma * std::sqrt(kSigmaRatio * kSigmaRatio - 1.0));
+    }
+
+    static void row(const cv::Mat& src, const cv::Mat& wide, int y, short* out) {
+        const uchar* p = src.ptr<uchar>(y);
+        const uchar* w = wide.ptr<uchar>(y);
+        int x = 0;
+#if CV_SIMD
+        const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+        const int half = cv::VTraits<cv::v_int16>::vlanes();
+        for (; x + lanes <= src.cols; x += lanes) {
+            cv::v_int16 a[2], b[2];
+            expandS16(w + x, a[0], a[1]);
+            expandS16(p + x, b[0], b[1]);
+            cv::v_store(out + x, cv::v_shl<kShift>(cv::v_sub(a[0], b[0])));
+            cv::v_store(out + x + half, cv::v_shl<kShift>(cv::v_sub(a[1], b[1])));
+        }
+#endif
+        for (; x < src.cols; x++) {
+            out[x] = static_cast<short>((w[x] - p[x]) * (1 << kShift));
+        }
+    }
+};
+
+#if CV_SIMD
+// Sign change towards the right or lower neighbour with enough contrast across it
+inline cv::v_uint16 crossing(const cv::v_int16& v, const cv::v_int16& right, const cv::v_int16& below,
+                             const cv::v_uint16& threshold) {
+    const cv::v_int16 zero = cv::vx_setzero_s16();
+    cv::v_uint16 h = cv::v_and(cv::v_reinterpret_as_u16(cv::v_lt(cv::v_xor(v, right), zero)),
+                               cv::v_gt(cv::v_absdiff(v, right), threshold));
+    cv::v_uint16 d = cv::v_and(cv::v_reinterpret_as_u16(cv::v_lt(cv::v_xor(v, below), zero)),
+                               cv::v_gt(cv::v_absdiff(v, below), threshold));
+    return cv::v_or(h, d);
+}
+#endif
+
+template <typename R>
+class ZeroCrossingDetector : public EdgeDetector {
+public:
+    explicit ZeroCrossingDetector(EdgeDetectorType type) : kind(type) {}
+
+    EdgeDetectorType type() const override { return kind; }
+
+    void detect(const cv::Mat& src, cv::Mat& edges, const StreamParams& p) const override {
+        CV_Assert(src.type() == CV_8UC1);
+        edges.create(src.size(), CV_8UC1);
+        // Scratch per thread: detectors are shared singletons
+        thread_local cv::Mat aux;
+        R::prepare(src, aux, p);
+
+        const int rows = src.rows;
+        const int cols = src.cols;
+        const int threshold = std::min(65535, std::max(0, cvFloor(p.lowThreshold)));
+        cv::AutoBuffer<short> buffer(static_cast<size_t>(cols) * 2);
+        short* current = buffer.data();
+        short* next = current + cols;
+        R::row(src, aux, 0, current);
+        for (int y = 0; y < rows; y++) {
+            if (y + 1 < rows) {
+                R::row(src, aux, y + 1, next);
+            } else {
+                // No row below the last one: nothing can cross downwards
+                std::copy(current, current + cols, next);
+            }
+            uchar* out = edges.ptr<uchar>(y);
+            int x = 0;
+#if CV_SIMD
+            const int half = cv::VTraits<cv::v_int16>::vlanes();
+            const cv::v_uint16 vthreshold = cv::vx_setall_u16(static_cast<ushort>(threshold));
+            for (; x + 2 * half < cols; x += 2 * half) {
+                cv::v_uint16 lo = crossing(cv::vx_load(current + x), cv::vx_load(current + x + 1),
+                                           cv::vx_load(next + x), vthreshold);
+                cv::v_uint16 hi = crossing(cv::vx_load(current + x + half), cv::vx_load(current + x + half + 1),
+                                           cv::vx_load(next + x + half), vthreshold);
+                cv::v_store(out + x, cv::v_pack(lo, hi));
+            }
+#endif
+            for (; x < cols; x++) {
+                int v = current[x];
+                int right = current[std::min(x + 1, cols - 1)];
+                int below = next[x];
+                bool edge = ((v ^ right) < 0 && std::abs(v - right) > threshold) ||
+                            ((v ^ below) < 0 && std::abs(v - below) > threshold);
+                out[x] = edge ? 255 : 0;
+            }
+            std::swap(current, next);
+        }
+        cv::vx_cleanup();
+    }
+
+private:
+    const EdgeDetectorType kind;
+};
+
+}  // namespace
+
+const EdgeDetector& EdgeDetector::get(EdgeDetectorType type) {
+    static const CannyDetector canny;
+    static const GradientDetector<SobelKernel> sobel(EdgeDetectorType::Sobel);
+    static const GradientDetector<ScharrKernel> scharr(EdgeDetectorType::Scharr);
+    static const ZeroCrossingDetector<LaplacianResponse> laplacian(EdgeDetectorType::Laplacian);
+    static const ZeroCrossingDetector<DogResponse> dog(EdgeDetectorType::DoG);
+    switch (type) {
+        case EdgeDetectorType::Sobel: return sobel;
+        case EdgeDetectorType::Scharr: return scharr;
+        case EdgeDetectorType::Laplacian: return laplacian;
+        case EdgeDetectorType::DoG: return dog;
+        default: return canny;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef EDGE_DETECTOR_H
+#define EDGE_DETECTOR_H
+
+#include <opencv2/core.hpp>
+#include <string>
+
+struct StreamParams;
+
+enum class EdgeDetectorType {
+    Canny,      // gradient + non-maximum suppression + hysteresis
+    Sobel,      // thresholded 3x3 Sobel magnitude
+    Scharr,     // thresholded 3x3 Scharr magnitude
+    Laplacian,  // zero crossings of the 4-neighbour Laplacian
+    DoG,        // zero crossings of a difference of Gaussians
+};
+
+const char* edgeDetectorName(EdgeDetectorType type);
+bool parseEdgeDetector(const std::string& name, EdgeDetectorType& type);
+
+// Turns a blurred 8-bit gray frame into a binary (0/255) edge map.
+//
+// Implementations are stateless singletons shared by every stream and thread.
+// The gradient and zero-crossing operators are templates specialized per kernel,
+// with OpenCV universal intrinsics in the inner loops (NEON on devices, SSE/AVX on
+// hosts). Thresholds keep the meaning they have for Canny: the Sobel/Scharr
+// magnitude |dx| + |dy| (Scharr rescaled to Sobel units) must exceed highThreshold,
+// and a Laplacian/DoG zero crossing must have a contrast above lowThreshold.
+class EdgeDetector {
+public:
+    virtual ~EdgeDetector() = default;
+
+    virtual EdgeDetectorType type() const = 0;
+    // `edges` is allocated unless it already has the size of `blurred`, so views into
+    // caller buffers are written in place
+    virtual void detect(const cv::Mat& blurred, cv::Mat& edges, const StreamParams& params) const = 0;
+
+    static const EdgeDetector& get(EdgeDetectorType type);
+};
+
+#endif // EDGE_DETECTOR_H
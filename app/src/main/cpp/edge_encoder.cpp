@@ -0,0 +1,285 @@
+#include "edge_encoder.h"
+#include "contour_encoder.h"
+#include "edge_log.h"
+#include <zlib.h>
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+
+#define LOG_TAG "EdgeEncoder"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// Fastest deflate level: edge maps are sparse and compress well even at level 1
+std::atomic<int> EdgeEncoder::pngLevel{Z_BEST_SPEED};
+
+static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+// Patch the length of a chunk started with beginChunk() and append its CRC
+static void finishChunk(std::vector<uint8_t>& out, size_t lengthPos) {
+    size_t typeStart = lengthPos + 4;
+    uint32_t length = static_cast<uint32_t>(out.size() - typeStart - 4);
+    out[lengthPos] = static_cast<uint8_t>(length >> 24);
+    out[lengthPos + 1] = static_cast<uint8_t>(length >> 16);
+    out[lengthPos + 2] = static_cast<uint8_t>(length >> 8);
+    out[lengthPos + 3] = static_cast<uint8_t>(length);
+    uLong crc = crc32(0L, out.data() + typeStart, static_cast<uInt>(out.size() - typeStart));
+    putBE32(out, static_cast<uint32_t>(crc));
+}
+
+static size_t beginChunk(std::vector<uint8_t>& out, const char* type) {
+    size_t lengthPos = out.size();
+    putBE32(out, 0);
+    out.insert(out.end(), type, type + 4);
+    return lengthPos;
+}
+
+void EdgeEncoder::packBits(const cv::Mat& edges, std::vector<uint8_t>& packed,
+                           EdgeFrameStats* stats, const cv::Mat* dx, const cv::Mat* dy,
+                           const uint8_t* previous, TemporalFilter* filter) {
+    const int width = edges.cols;
+    const int height = edges.rows;
+    const int rowBytes = packedRowBytes(width);
+    packed.resize(static_cast<size_t>(rowBytes) * height);
+    if (filter && !filter->enabled()) {
+        filter = nullptr;
+    }
+    if (filter) {
+        filter->begin(width, height);
+    }
+    if (stats) {
+        stats->reset(width, height, stats->gridCols, stats->gridRows);
+    }
+    // Gradients only count when they cover the edge map
+    bool gradients = stats && dx && dy && dx->size() == edges.size() && dy->size() == edges.size() &&
+                     dx->type() == CV_16SC1 && dy->type() == CV_16SC1;
+
+    const int fullBytes = width / 8;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = edges.ptr<uint8_t>(y);
+        // Stabilize the row in the same pass that packs and counts it
+        if (filter) {
+            filter->filterRow(y, src);
+            src = filter->output().ptr<uint8_t>(y);
+        }
+        uint8_t* dst = packed.data() + static_cast<size_t>(y) * rowBytes;
+        // 8 pixels per output byte, branch-free so the compiler can vectorize
+        for (int i = 0; i < fullBytes; i++) {
+            const uint8_t* p = src + i * 8;
+            dst[i] = static_cast<uint8_t>(
+                ((p[0] != 0) << 7) | ((p[1] != 0) << 6) | ((p[2] != 0) << 5) | ((p[3] != 0) << 4) |
+                ((p[4] != 0) << 3) | ((p[5] != 0) << 2) | ((p[6] != 0) << 1) | (p[7] != 0));
+        }
+        if (fullBytes < rowBytes) {
+            uint8_t tail = 0;
+            for (int x = fullBytes * 8; x < width; x++) {
+                tail |= static_cast<uint8_t>((src[x] != 0) << (7 - (x & 7)));
+            }
+            dst[fullBytes] = tail;
+        }
+        // The packed row is still in L1: counting it here costs no extra pass
+        if (stats) {
+            stats->addPackedRow(y, dst, previous ? previous + static_cast<size_t>(y) * rowBytes : nullptr,
+                                gradients ? dx->ptr<short>(y) : nullptr, gradients ? dy->ptr<short>(y) : nullptr);
+        }
+    }
+    if (stats) {
+        stats->finish();
+        if (filter) {
+            stats->rawToggleCount = filter->rawToggles();
+        }
+    }
+}
+
+bool EdgeEncoder::encodePng1bpp(const uint8_t* packed, int width, int height,
+                                std::vector<uint8_t>& png, int level) {
+    if (!packed || width <= 0 || height <= 0) {
+        return false;
+    }
+    const int rowBytes = packedRowBytes(width);
+
+    // Scanlines: filter byte 0 (none) followed by the packed row.
+    // Filters don't help bilevel data; deflate handles the long runs.
+    static thread_local std::vector<uint8_t> raw;
+    raw.resize(static_cast<size_t>(rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        uint8_t* dst = raw.data() + static_cast<size_t>(y) * (rowBytes + 1);
+        dst[0] = 0;
+        memcpy(dst + 1, packed + static_cast<size_t>(y) * rowBytes, rowBytes);
+    }
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    // Z_RLE is much faster than the default strategy and near-equal on bilevel images
+    if (deflateInit2(&strm, level, Z_DEFLATED, 15, 8, Z_RLE) != Z_OK) {
+        LOGE("deflateInit2 failed");
+        return false;
+    }
+    uLong bound = deflateBound(&strm, static_cast<uLong>(raw.size()));
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.clear();
+    png.reserve(8 + 25 + 12 + bound + 12);
+    png.insert(png.end(), signature, signature + 8);
+
+    // IHDR: width, height, bit depth 1, color type 0 (grayscale), deflate, filter 0, no interlace
+    size_t ihdr = beginChunk(png, "IHDR");
+    putBE32(png, static_cast<uint32_t>(width));
+    putBE32(png, static_cast<uint32_t>(height));
+    png.push_back(1);
+    png.push_back(0);
+    png.push_back(0);
+    png.push_back(0);
+    png.push_back(0);
+    finishChunk(png, ihdr);
+
+    // IDAT: single chunk with the whole zlib stream
+    size_t idat = beginChunk(png, "IDAT");
+    size_t dataStart = png.size();
+    png.resize(dataStart + bound);
+    strm.next_in = raw.data();
+    strm.avail_in = static_cast<uInt>(raw.size());
+    strm.next_out = png.data() + dataStart;
+    strm.avail_out = static_cast<uInt>(bound);
+    int ret = deflate(&strm, Z_FINISH);
+    deflateEnd(&strm);
+    if (ret != Z_STREAM_END) {
+        LOGE("deflate failed: %d", ret);
+        return false;
+    }
+    png.resize(dataStart + strm.total_out);
+    finishChunk(png, idat);
+
+    size_t iend = beginChunk(png, "IEND");
+    finishChunk(png, iend);
+    return true;
+}
+
+uint64_t PackedFrameCache::publish(const cv::Mat& edges, const FrameMeta& meta, const cv::Mat* dx,
+                                   const cv::Mat* dy, TemporalFilter* filter) {
+    // Pack into the scratch buffers, then swap in. process(), the streaming pull thread,
+    // the frame pipeline and the legacy frame path may all publish to one stream.
+    std::lock_guard<std::mutex> publishLock(publishMutex);
+    std::vector<uint8_t> packed;
+    EdgeFrameStats frameStats;
+    const uint8_t* previous = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        packed.swap(scratch);
+        std::swap(frameStats, scratchStats);
+        frameStats.gridCols = statsGridCols;
+        frameStats.gridRows = statsGridRows;
+        // Readers only copy `bits` and publishers hold publishMutex, so it stays put
+        // while it is read for the toggle count without holding `mutex`
+        if (current.generation > 0 && current.width == edges.cols && current.height == edges.rows) {
+            previous = bits.data();
+        }
+    }
+    EdgeEncoder::packBits(edges, packed, &frameStats, dx, dy, previous, filter);
+    frameStats.frameId = meta.frameId;
+    publishLatency.recordSince(meta.originNs());
+    std::lock_guard<std::mutex> lock(mutex);
+    bits.swap(packed);
+    scratch.swap(packed);
+    std::swap(stats, frameStats);
+    std::swap(scratchStats, frameStats);
+    current.width = edges.cols;
+    current.height = edges.rows;
+    current.meta = meta;
+    return ++current.generation;
+}
+
+bool PackedFrameCache::latestPacked(std::vector<uint8_t>& out, FrameInfo& info) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current.generation == 0) {
+        return false;
+    }
+    out = bits;
+    info = current;
+    return true;
+}
+
+bool PackedFrameCache::latestStats(EdgeFrameStats& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current.generation == 0) {
+        return false;
+    }
+    out = stats;
+    return true;
+}
+
+void PackedFrameCache::setStatsGrid(int cols, int rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    statsGridCols = std::max(1, cols);
+    statsGridRows = std::max(1, rows);
+}
+
+bool PackedFrameCache::latestPng(std::vector<uint8_t>& out, FrameInfo& info) {
+    std::vector<uint8_t> packed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current.generation == 0) {
+            return false;
+        }
+        info = current;
+        if (cachedPngGeneration == current.generation) {
+            out = cachedPng;
+            return true;
+        }
+        packed = bits;
+    }
+
+    // Encode without holding the lock so publishing is never blocked by a viewer
+    std::vector<uint8_t> png;
+    if (!EdgeEncoder::encodePng1bpp(packed.data(), info.width, info.height, png, EdgeEncoder::pngCompressionLevel())) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (info.generation > cachedPngGeneration) {
+        cachedPng = png;
+        cachedPngGeneration = info.generation;
+    }
+    out.swap(png);
+    return true;
+}
+
+bool PackedFrameCache::latestContours(double epsilon, std::vector<uint8_t>& out, FrameInfo& info) {
+    std::vector<uint8_t> packed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current.generation == 0) {
+            return false;
+        }
+        info = current;
+        if (cachedContoursGeneration == current.generation && cachedContoursEpsilon == epsilon) {
+            out = cachedContours;
+            return true;
+        }
+        packed = bits;
+    }
+
+    // Trace from the packed bits without holding the lock, as for PNG
+    std::vector<uint8_t> contours;
+    ContourEncoder::encodePacked(packed.data(), info.width, info.height, epsilon, contours);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (info.generation >= cachedContoursGeneration) {
+        cachedContours = contours;
+        cachedContoursGeneration = info.generation;
+        cachedContoursEpsilon = epsilon;
+    }
+    out.swap(contours);
+    return true;
+}
+
+void EdgeEncoder::setPngCompressionLevel(int level) {
+    level = std::max(0, std::min(9, level));
+    pngLevel.store(level, std::memory_order_relaxed);
+    LOGI("PNG compression level: %d", level);
+}
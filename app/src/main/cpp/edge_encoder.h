@@ -0,0 +1,85 @@
+#ifndef EDGE_ENCODER_H
+#define EDGE_ENCODER_H
+
+#include "edge_stats.h"
+#include "frame_meta.h"
+#include "temporal_filter.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Lossless encoders for binary edge maps.
+// Edge maps are packed to 1 bit per pixel (MSB first, rows padded to a whole byte)
+// and either served raw or wrapped in a 1-bit grayscale PNG.
+class EdgeEncoder {
+public:
+    static int packedRowBytes(int width) { return (width + 7) / 8; }
+
+    // Pack a CV_8UC1 edge map (0 = background, non-zero = edge) into 1 bpp.
+    // With `stats` (its grid size preset by the caller) each row is counted right
+    // after it is packed; `dx`/`dy` are the CV_16SC1 gradients for meanGradient and
+    // `previous` the previous frame's packed bitmap for toggleCount.
+    // With an enabled `filter` each row is stabilized first and the stabilized map
+    // (filter->output()) is what gets packed and counted.
+    static void packBits(const cv::Mat& edges, std::vector<uint8_t>& packed,
+                         EdgeFrameStats* stats = nullptr, const cv::Mat* dx = nullptr, const cv::Mat* dy = nullptr,
+                         const uint8_t* previous = nullptr, TemporalFilter* filter = nullptr);
+
+    // Encode a packed bitmap as a 1-bit grayscale PNG (deflate level 0-9)
+    static bool encodePng1bpp(const uint8_t* packed, int width, int height,
+                              std::vector<uint8_t>& png, int level);
+
+    static void setPngCompressionLevel(int level);
+    static int pngCompressionLevel() { return pngLevel.load(std::memory_order_relaxed); }
+
+private:
+    // Set from the settings endpoint while viewers and encode workers read it
+    static std::atomic<int> pngLevel;
+};
+
+// Latest packed edge map of one stream, with its PNG and contour encodings cached per
+// generation.
+class PackedFrameCache {
+public:
+    // Publish the latest edge map; bumps and returns the frame generation. `dx`/`dy`
+    // are the gradients the edges were detected from, when the detector kept them.
+    // With an enabled `filter` the stabilized map (filter->output()) is published.
+    // Publishers of one cache are serialized, so any thread may publish.
+    uint64_t publish(const cv::Mat& edges, const FrameMeta& meta, const cv::Mat* dx = nullptr,
+                     const cv::Mat* dy = nullptr, TemporalFilter* filter = nullptr);
+
+    bool latestPacked(std::vector<uint8_t>& out, FrameInfo& info) const;
+    bool latestPng(std::vector<uint8_t>& out, FrameInfo& info);
+    // Edge chains simplified with `epsilon` in ContourEncoder's binary format
+    bool latestContours(double epsilon, std::vector<uint8_t>& out, FrameInfo& info);
+
+    // Statistics of the latest frame, gathered while packing it
+    bool latestStats(EdgeFrameStats& out) const;
+    // Grid of per-cell edge densities in the stats of the next frames
+    void setStatsGrid(int cols, int rows);
+
+    // Capture-to-publish latency of every published frame
+    const LatencyHistogram& latency() const { return publishLatency; }
+
+private:
+    // Held for a whole publish; `bits` only changes under both locks
+    std::mutex publishMutex;
+    mutable std::mutex mutex;
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> bits;
+    FrameInfo current;
+    EdgeFrameStats stats;
+    EdgeFrameStats scratchStats;
+    int statsGridCols = 8;
+    int statsGridRows = 8;
+    std::vector<uint8_t> cachedPng;
+    uint64_t cachedPngGeneration = 0;
+    std::vector<uint8_t> cachedContours;
+    uint64_t cachedContoursGeneration = 0;
+    double cachedContoursEpsilon = 0.0;
+    LatencyHistogram publishLatency;
+};
+
+#endif // EDGE_ENCODER_H
@@ -0,0 +1,20 @@
+#ifndef EDGE_LOG_H
+#define EDGE_LOG_H
+
+// Logging shim for sources shared between the Android library and host tools.
+// On Android this forwards to logcat; host builds print to stderr.
+#ifdef __ANDROID__
+#include <android/log.h>
+#define EDGE_LOGI(tag, ...) __android_log_print(ANDROID_LOG_INFO, tag, __VA_ARGS__)
+#define EDGE_LOGW(tag, ...) __android_log_print(ANDROID_LOG_WARN, tag, __VA_ARGS__)
+#define EDGE_LOGE(tag, ...) __android_log_print(ANDROID_LOG_ERROR, tag, __VA_ARGS__)
+#else
+#include <cstdio>
+#define EDGE_LOG_STDERR(level, tag, ...) \
+    do { fprintf(stderr, "%s/%s: ", level, tag); fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while (0)
+#define EDGE_LOGI(tag, ...) EDGE_LOG_STDERR("I", tag, __VA_ARGS__)
+#define EDGE_LOGW(tag, ...) EDGE_LOG_STDERR("W", tag, __VA_ARGS__)
+#define EDGE_LOGE(tag, ...) EDGE_LOG_STDERR("E", tag, __VA_ARGS__)
+#endif
+
+#endif // EDGE_LOG_H
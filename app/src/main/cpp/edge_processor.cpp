@@ -1,4 +1,7 @@
 #include "edge_processor.h"
+#include "buffer_pool.h"
+#include "pipeline_variants.h"
+#include "stream_registry.h"
 #include <android/bitmap.h>
 
 #define LOG_TAG "EdgeProcessor"
@@ -11,14 +14,53 @@ double EdgeProcessor::highThreshold = 80.0;  // Optimized for mobile cameras
 bool EdgeProcessor::isInitialized = false;
 
 // Static buffers for memory reuse
-static cv::Mat grayBuffer;
+static cv::Mat grayBuffer;  // RGBA paths and Y planes that cannot be read in place
 static cv::Mat edgesBuffer;
 static cv::Mat blurBuffer;
 
+// Settings of the primary stream for the bitmap and Y-plane paths: its detector and the
+// thresholds set through setCannyThresholds, with the lighter 3x3/0.8 blur
+static StreamParams directParams() {
+    StreamParams params = StreamRegistry::instance().getOrCreate(EdgeProcessor::kPrimaryStreamId)->params();
+    params.blurSize = 3;
+    params.blurSigma = 0.8;
+    return params;
+}
+
+// Canny runs as a compile-time specialized pipeline variant (bit-exact with the generic
+// calls); other detectors blur first, fused with the fixed-point engine.
+static void blurAndDetect(const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges) {
+    StreamParams params = directParams();
+    if (PipelineVariants::Variant variant = PipelineVariants::find(params, EdgeOutputFormat::Gray)) {
+        variant(gray, blur, edges, params);
+        return;
+    }
+    if (params.engine == ProcessingEngine::FixedPoint) {
+        StreamContext::detect(gray, blur, edges, params);
+        return;
+    }
+    PipelineVariants::runGeneric(gray, blur, edges, params, EdgeOutputFormat::Gray);
+}
+
+// As blurAndDetect, writing opaque gray RGBA for display; the Canny variants do so
+// without a separate cvtColor pass
+static void blurAndDetectRgba(const cv::Mat& gray, cv::Mat& rgba) {
+    StreamParams params = directParams();
+    if (PipelineVariants::Variant variant = PipelineVariants::find(params, EdgeOutputFormat::Rgba)) {
+        variant(gray, blurBuffer, rgba, params);
+        return;
+    }
+    blurAndDetect(gray, blurBuffer, edgesBuffer);
+    cv::cvtColor(edgesBuffer, rgba, cv::COLOR_GRAY2RGBA);
+}
+
 bool EdgeProcessor::initialize() {
     try {
         LOGI("Initializing EdgeProcessor...");
         
+        // Every Mat created from here on (ours and OpenCV's temporaries) is served by the pool
+        PooledMatAllocator::install();
+        
         // Test basic OpenCV functionality
         cv::Mat testMat = cv::Mat::zeros(10, 10, CV_8UC1);
         if (testMat.empty()) {
@@ -59,14 +101,8 @@ void EdgeProcessor::processFrame(void* pixels, int width, int height) {
         // Convert to grayscale
         cv::cvtColor(rgba, grayBuffer, cv::COLOR_RGBA2GRAY);
         
-        // Apply optimized Gaussian blur to reduce noise
-        cv::GaussianBlur(grayBuffer, blurBuffer, cv::Size(3, 3), 0.8);
-        
-        // Apply Canny edge detection with optimized parameters
-        cv::Canny(blurBuffer, edgesBuffer, lowThreshold, highThreshold, 3, false);
-        
-        // Convert edges back to RGBA for display
-        cv::cvtColor(edgesBuffer, rgba, cv::COLOR_GRAY2RGBA);
+        // Blur to reduce noise, detect, and write the edges back as RGBA for display
+        blurAndDetectRgba(grayBuffer, rgba);
         
     } catch (const std::exception& e) {
         LOGE("Error processing frame: %s", e.what());
@@ -80,37 +116,41 @@ void EdgeProcessor::processFrameData(uint8_t* frameData, int width, int height,
     }
     
     try {
-        // Create OpenCV Mat from Y plane data (grayscale)
-        cv::Mat yPlane(height, width, CV_8UC1, frameData, rowStride);
+        // The Y plane is read in place unless its samples are not pixel-contiguous
+        FrameView frame = FrameView::gray(frameData, width, height, rowStride, pixelStride);
+        if (!frame.valid()) {
+            LOGE("Invalid frame %dx%d, rowStride=%d, pixelStride=%d", width, height, rowStride, pixelStride);
+            return;
+        }
+        cv::Mat yPlane = frame.luma(grayBuffer);
         
         // Ensure buffers are properly sized (reuse for performance)
-        if (grayBuffer.size() != cv::Size(width, height)) {
-            grayBuffer.create(height, width, CV_8UC1);
+        if (blurBuffer.size() != cv::Size(width, height)) {
             blurBuffer.create(height, width, CV_8UC1);
             edgesBuffer.create(height, width, CV_8UC1);
             LOGI("Allocated processing buffers for %dx%d", width, height);
         }
         
-        // Copy to ensure contiguous memory if needed
-        if (rowStride != width) {
-            yPlane.copyTo(grayBuffer);
-        } else {
-            grayBuffer = yPlane.clone();  // Clone to avoid modifying original
-        }
-        
-        // Apply optimized Gaussian blur to reduce noise
-        cv::GaussianBlur(grayBuffer, blurBuffer, cv::Size(3, 3), 0.8);
-        
-        // Apply Canny edge detection with optimized parameters
-        cv::Canny(blurBuffer, edgesBuffer, lowThreshold, highThreshold, 3, false);
-        
+        FrameMeta meta;
+        meta.processStartNs = frameClockNs();
+        meta.enqueueNs = meta.processStartNs;
+
+        // Apply optimized Gaussian blur to reduce noise, then detect; the blur reads the
+        // strided plane directly, so no copy (and no per-frame clone) of the input is needed
+        blurAndDetect(yPlane, blurBuffer, edgesBuffer);
+        meta.processEndNs = frameClockNs();
+
+        // Publish on the primary stream; packing the edge map also gathers its stats,
+        // so logging needs no counting pass of its own
+        auto stream = StreamRegistry::instance().getOrCreate(kPrimaryStreamId);
+        stream->publishExternal(edgesBuffer, meta);
+
         // Log processing info (limit frequency to avoid spam)
         static int frameCount = 0;
-        if (frameCount % 60 == 0) {  // Log every 60 frames (every 2 seconds at 30fps)
-            int edgePixels = cv::countNonZero(edgesBuffer);
-            double edgeRatio = (double)edgePixels / (width * height) * 100.0;
+        EdgeFrameStats stats;
+        if (frameCount % 60 == 0 && stream->packedCache().latestStats(stats)) {  // Every 2 seconds at 30fps
             LOGI("Frame %d: %dx%d, %.1f%% edge pixels, thresholds: %.1f/%.1f", 
-                 frameCount, width, height, edgeRatio, lowThreshold, highThreshold);
+                 frameCount, width, height, stats.density() * 100.0, lowThreshold, highThreshold);
         }
         frameCount++;
         
@@ -119,9 +159,18 @@ void EdgeProcessor::processFrameData(uint8_t* frameData, int width, int height,
     }
 }
 
+void EdgeProcessor::releaseFrameData(uint8_t* data, int width, int height) {
+    BufferPool::instance().release(data, static_cast<size_t>(width) * height);
+}
+
 void EdgeProcessor::setCannyThresholds(double low, double high) {
     lowThreshold = low;
     highThreshold = high;
+    auto stream = StreamRegistry::instance().getOrCreate(kPrimaryStreamId);
+    StreamParams params = stream->params();
+    params.lowThreshold = low;
+    params.highThreshold = high;
+    stream->setParams(params);
     LOGI("Updated Canny thresholds: low=%.1f, high=%.1f", low, high);
 }
 
@@ -146,14 +195,8 @@ jobject EdgeProcessor::processFrameAndReturn(JNIEnv* env, void* pixels, int widt
         // Convert to grayscale
         cv::cvtColor(rgba, grayBuffer, cv::COLOR_RGBA2GRAY);
         
-        // Apply optimized Gaussian blur to reduce noise
-        cv::GaussianBlur(grayBuffer, blurBuffer, cv::Size(3, 3), 0.8);
-        
-        // Apply Canny edge detection with optimized parameters
-        cv::Canny(blurBuffer, edgesBuffer, lowThreshold, highThreshold, 3, false);
-        
-        // Convert edges back to RGBA for display
-        cv::cvtColor(edgesBuffer, result, cv::COLOR_GRAY2RGBA);
+        // Blur to reduce noise, detect, and convert the edges to RGBA for display
+        blurAndDetectRgba(grayBuffer, result);
         
         // Create and return new bitmap
         return createBitmapFromMat(env, result);
@@ -194,48 +237,50 @@ jobject EdgeProcessor::createBitmapFromMat(JNIEnv* env, const cv::Mat& mat) {
     return bitmap;
 }
 
-uint8_t* EdgeProcessor::processFrameDataAndReturn(uint8_t* frameData, int width, int height, int rowStride, int pixelStride) {
+FrameRing& EdgeProcessor::frameRing() {
+    // Slots are sized for the default 1280x720 preview up front; larger frames grow them once
+    static FrameRing ring(kFrameRingSlots, 1280 * 720);
+    return ring;
+}
+
+AsyncProcessor& EdgeProcessor::asyncProcessor() {
+    static AsyncProcessor processor(frameRing(), StreamRegistry::instance().getOrCreate(kPrimaryStreamId));
+    return processor;
+}
+
+uint8_t* EdgeProcessor::processFrameDataAndReturn(uint8_t* frameData, int width, int height, int rowStride, int pixelStride,
+                                                  FrameMeta* meta) {
     if (!isInitialized) {
         LOGE("EdgeProcessor not initialized");
         return nullptr;
     }
     
     try {
-        // Create OpenCV Mat from Y plane data (grayscale)
-        cv::Mat yPlane(height, width, CV_8UC1, frameData, rowStride);
-        
-        // Ensure we have proper buffer sizing
-        if (grayBuffer.rows != height || grayBuffer.cols != width) {
-            grayBuffer = cv::Mat::zeros(height, width, CV_8UC1);
-            edgesBuffer = cv::Mat::zeros(height, width, CV_8UC1);
-            blurBuffer = cv::Mat::zeros(height, width, CV_8UC1);
-        }
-        
-        // Handle rowStride differences
-        if (rowStride != width) {
-            // Copy to contiguous buffer
-            for (int i = 0; i < height; i++) {
-                memcpy(grayBuffer.ptr(i), yPlane.ptr(i), width);
+        // Blur, Canny, publishing and encode hand-off run in the primary stream's context
+        auto stream = StreamRegistry::instance().getOrCreate(kPrimaryStreamId);
+        cv::Mat edges;
+        FrameDecision decision = FrameDecision::Full;
+        FrameView frame = FrameView::gray(frameData, width, height, rowStride, pixelStride);
+        if (!stream->process(frame, meta, &edges, &decision)) {
+            // Dropped frames are expected under a tight latency budget
+            if (decision != FrameDecision::Drop) {
+                LOGE("Failed to process frame %dx%d", width, height);
             }
-        } else {
-            grayBuffer = yPlane.clone();
+            return nullptr;
         }
         
-        // Apply Gaussian blur to reduce noise
-        cv::GaussianBlur(grayBuffer, blurBuffer, cv::Size(5, 5), 1.4);
-        
-        // Apply Canny edge detection
-        cv::Canny(blurBuffer, edgesBuffer, lowThreshold, highThreshold);
-        
-        // Allocate result buffer
-        uint8_t* result = new uint8_t[width * height];
+        // Result buffer is recycled through the pool; see releaseFrameData
+        uint8_t* result = static_cast<uint8_t*>(BufferPool::instance().allocate(static_cast<size_t>(width) * height));
+        if (!result) {
+            return nullptr;
+        }
         
         // Copy processed data to result buffer
-        if (edgesBuffer.isContinuous()) {
-            memcpy(result, edgesBuffer.data, width * height);
+        if (edges.isContinuous()) {
+            memcpy(result, edges.data, width * height);
         } else {
             for (int i = 0; i < height; i++) {
-                memcpy(result + i * width, edgesBuffer.ptr(i), width);
+                memcpy(result + i * width, edges.ptr(i), width);
             }
         }
         
@@ -4,6 +4,9 @@
 #include <opencv2/opencv.hpp>
 #include <android/log.h>
 #include <jni.h>
+#include "async_processor.h"
+#include "frame_meta.h"
+#include "frame_ring.h"
 
 class EdgeProcessor {
 public:
@@ -11,9 +14,21 @@ public:
     static void processFrame(void* pixels, int width, int height);
     static jobject processFrameAndReturn(JNIEnv* env, void* pixels, int width, int height, int format);
     static void processFrameData(uint8_t* frameData, int width, int height, int rowStride, int pixelStride);
-    static uint8_t* processFrameDataAndReturn(uint8_t* frameData, int width, int height, int rowStride, int pixelStride);
+    static uint8_t* processFrameDataAndReturn(uint8_t* frameData, int width, int height, int rowStride, int pixelStride,
+                                              FrameMeta* meta = nullptr);
+    // Buffers returned by processFrameDataAndReturn come from the BufferPool
+    static void releaseFrameData(uint8_t* data, int width, int height);
     static void setCannyThresholds(double lowThreshold, double highThreshold);
     
+    // The camera preview is processed as this stream of the StreamRegistry
+    static const int kPrimaryStreamId = 0;
+    
+    // Camera frames travel from the capture callback to the processing thread through this ring
+    static const int kFrameRingSlots = 3;
+    static FrameRing& frameRing();
+    // Submit/complete front end of the primary stream, fed through frameRing()
+    static AsyncProcessor& asyncProcessor();
+    
 private:
     static double lowThreshold;
     static double highThreshold;
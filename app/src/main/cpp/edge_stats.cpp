@@ -0,0 +1,240 @@
+#include "edge_stats.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+inline int countBits(const uint8_t* p, int n) {
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        count += __builtin_popcountll(word);
+    }
+    for (; i < n; i++) {
+        count += __builtin_popcount(p[i]);
+    }
+    return count;
+}
+
+inline int countChangedBits(const uint8_t* a, const uint8_t* b, int n) {
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t wa;
+        uint64_t wb;
+        memcpy(&wa, a + i, sizeof(wa));
+        memcpy(&wb, b + i, sizeof(wb));
+        count += __builtin_popcountll(wa ^ wb);
+    }
+    for (; i < n; i++) {
+        count += __builtin_popcount(a[i] ^ b[i]);
+    }
+    return count;
+}
+
+// First / last non-zero byte of a row, or -1; edge maps are mostly empty, so eight
+// zero bytes are skipped at a time
+int firstNonZero(const uint8_t* p, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        if (word) break;
+    }
+    for (; i < n; i++) {
+        if (p[i]) return i;
+    }
+    return -1;
+}
+
+int lastNonZero(const uint8_t* p, int n) {
+    int i = n;
+    for (; i >= 8; i -= 8) {
+        uint64_t word;
+        memcpy(&word, p + i - 8, sizeof(word));
+        if (word) break;
+    }
+    while (--i >= 0) {
+        if (p[i]) return i;
+    }
+    return -1;
+}
+
+// Position of the first / last set pixel of a packed byte (MSB = leftmost pixel)
+inline int firstBit(uint8_t b) {
+    return __builtin_clz(b) - 24;
+}
+
+inline int lastBit(uint8_t b) {
+    return 7 - __builtin_ctz(b);
+}
+
+// JSON number, or null for the negative "unknown" value
+void formatOrNull(char* buf, size_t size, const char* format, double value) {
+    if (value >= 0.0) {
+        snprintf(buf, size, format, value);
+    } else {
+        snprintf(buf, size, "null");
+    }
+}
+
+}  // namespace
+
+double EdgeFrameStats::density() const {
+    uint64_t pixels = static_cast<uint64_t>(width) * height;
+    return pixels ? static_cast<double>(edgeCount) / pixels : 0.0;
+}
+
+double EdgeFrameStats::toggleRate() const {
+    uint64_t pixels = static_cast<uint64_t>(width) * height;
+    return toggleCount >= 0 && pixels ? static_cast<double>(toggleCount) / pixels : -1.0;
+}
+
+double EdgeFrameStats::rawToggleRate() const {
+    uint64_t pixels = static_cast<uint64_t>(width) * height;
+    return rawToggleCount >= 0 && pixels ? static_cast<double>(rawToggleCount) / pixels : -1.0;
+}
+
+double EdgeFrameStats::cellDensity(int col, int row) const {
+    if (col < 0 || row < 0 || col >= gridCols || row >= gridRows || cellCounts.empty()) {
+        return 0.0;
+    }
+    int64_t w = static_cast<int64_t>(col + 1) * width / gridCols - static_cast<int64_t>(col) * width / gridCols;
+    int64_t h = static_cast<int64_t>(row + 1) * height / gridRows - static_cast<int64_t>(row) * height / gridRows;
+    return w > 0 && h > 0 ? static_cast<double>(cellCounts[row * gridCols + col]) / (w * h) : 0.0;
+}
+
+void EdgeFrameStats::reset(int w, int h, int cols, int rows) {
+    cols = std::max(1, std::min(cols, std::max(w, 1)));
+    rows = std::max(1, std::min(rows, std::max(h, 1)));
+    int rowBytes = (w + 7) / 8;
+    if (w != width || cols != gridCols || static_cast<int>(cellBytes.size()) != cols) {
+        cellStart.resize(cols + 1);
+        for (int c = 0; c <= cols; c++) {
+            cellStart[c] = static_cast<int>(static_cast<int64_t>(c) * w / cols);
+        }
+        // Whole bytes of each cell; the last cell also takes the row's padded tail byte
+        cellBytes.resize(cols);
+        splitBytes.clear();
+        for (int c = 0; c < cols; c++) {
+            int begin = (cellStart[c] + 7) / 8;
+            int end = c + 1 == cols ? rowBytes : cellStart[c + 1] / 8;
+            cellBytes[c] = cv::Range(begin, std::max(begin, end));
+            if (c > 0 && cellStart[c] % 8 && (splitBytes.empty() || splitBytes.back().x != cellStart[c] / 8)) {
+                splitBytes.push_back(cv::Point(cellStart[c] / 8, c - 1));
+            }
+        }
+    }
+    width = w;
+    height = h;
+    gridCols = cols;
+    gridRows = rows;
+    cellCounts.assign(static_cast<size_t>(cols) * rows, 0);
+    edgeCount = 0;
+    boundingBox = cv::Rect();
+    meanGradient = -1.0;
+    toggleCount = -1;
+    rawToggleCount = -1;
+    gradientSum = 0;
+    gradientCount = 0;
+    minX = width;
+    maxX = -1;
+    minY = height;
+    maxY = -1;
+}
+
+void EdgeFrameStats::addPackedRow(int y, const uint8_t* row, const uint8_t* previous, const short* dx,
+                                  const short* dy) {
+    const int rowBytes = (width + 7) / 8;
+    if (previous) {
+        toggleCount = std::max<int64_t>(toggleCount, 0) + countChangedBits(row, previous, rowBytes);
+    }
+    int first = firstNonZero(row, rowBytes);
+    if (first < 0) {
+        return;
+    }
+    int last = lastNonZero(row, rowBytes);
+    // Last grid row starting at or above y, i.e. the largest r with r * height / gridRows <= y
+    int gridRow = static_cast<int>((static_cast<int64_t>(y + 1) * gridRows - 1) / height);
+    uint32_t* cells = cellCounts.data() + static_cast<size_t>(gridRow) * gridCols;
+
+    // Popcount of each cell's whole bytes, then bit by bit where a cell boundary
+    // falls inside a byte
+    for (int c = 0; c < gridCols; c++) {
+        const cv::Range& bytes = cellBytes[c];
+        int begin = std::max(bytes.start, first);
+        int end = std::min(bytes.end, last + 1);
+        if (begin < end) {
+            int count = countBits(row + begin, end - begin);
+            cells[c] += count;
+            edgeCount += count;
+        }
+    }
+    for (const cv::Point& split : splitBytes) {
+        uint8_t b = row[split.x];
+        int c = split.y;
+        for (int k = 0; b && k < 8; k++) {
+            if (b & (0x80 >> k)) {
+                int x = split.x * 8 + k;
+                while (x >= cellStart[c + 1]) c++;
+                cells[c]++;
+                edgeCount++;
+            }
+        }
+    }
+
+    if (dx) {
+        for (int i = first; i <= last; i++) {
+            uint8_t b = row[i];
+            gradientCount += __builtin_popcount(b);
+            while (b) {
+                int k = firstBit(b);
+                int x = i * 8 + k;
+                gradientSum += std::abs(dx[x]) + std::abs(dy[x]);
+                b &= static_cast<uint8_t>(~(0x80 >> k));
+            }
+        }
+    }
+
+    minX = std::min(minX, first * 8 + firstBit(row[first]));
+    maxX = std::max(maxX, last * 8 + lastBit(row[last]));
+    minY = std::min(minY, y);
+    maxY = y;
+}
+
+void EdgeFrameStats::finish() {
+    if (maxX >= minX && maxY >= minY) {
+        boundingBox = cv::Rect(minX, minY, maxX - minX + 1, maxY - minY + 1);
+    }
+    meanGradient = gradientCount ? static_cast<double>(gradientSum) / gradientCount : -1.0;
+}
+
+std::string EdgeFrameStats::toJson() const {
+    char buf[384];
+    char gradient[32];
+    char toggles[32];
+    char rawToggles[32];
+    formatOrNull(gradient, sizeof(gradient), "%.1f", meanGradient);
+    formatOrNull(toggles, sizeof(toggles), "%.5f", toggleRate());
+    formatOrNull(rawToggles, sizeof(rawToggles), "%.5f", rawToggleRate());
+    snprintf(buf, sizeof(buf),
+             "{\"frameId\":%llu,\"width\":%d,\"height\":%d,\"edgeCount\":%llu,\"density\":%.5f,"
+             "\"bbox\":[%d,%d,%d,%d],\"meanGradient\":%s,\"toggleRate\":%s,\"rawToggleRate\":%s,"
+             "\"grid\":{\"cols\":%d,\"rows\":%d,\"density\":[",
+             (unsigned long long)frameId, width, height, (unsigned long long)edgeCount, density(),
+             boundingBox.x, boundingBox.y, boundingBox.width, boundingBox.height, gradient, toggles, rawToggles,
+             gridCols, gridRows);
+    std::string json(buf);
+    for (int r = 0; r < gridRows; r++) {
+        for (int c = 0; c < gridCols; c++) {
+            snprintf(buf, sizeof(buf), "%s%.4f", r || c ? "," : "", cellDensity(c, r));
+            json += buf;
+        }
+    }
+    json += "]}}";
+    return json;
+}
@@ -0,0 +1,60 @@
+#ifndef EDGE_STATS_H
+#define EDGE_STATS_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Statistics of one edge map, accumulated by the packing kernel as it writes each
+// 1 bpp row (EdgeEncoder::packBits) rather than by a separate pass over the frame.
+struct EdgeFrameStats {
+    uint64_t frameId = 0;
+    int width = 0;
+    int height = 0;
+    uint64_t edgeCount = 0;
+    cv::Rect boundingBox;  // empty without edges
+    // Edge pixels per grid cell, row-major; cell (c, r) spans columns
+    // [c * width / gridCols, (c + 1) * width / gridCols) and likewise for rows
+    int gridCols = 0;
+    int gridRows = 0;
+    std::vector<uint32_t> cellCounts;
+    // Mean L1 gradient magnitude (|dx| + |dy|) of the edge pixels, taken from the
+    // gradients Canny started from; negative when the frame had none to reuse
+    double meanGradient = -1.0;
+    // Flicker: pixels that changed since the previous published frame, and (with the
+    // temporal filter on) since the previous raw detection; -1 when unknown
+    int64_t toggleCount = -1;
+    int64_t rawToggleCount = -1;
+
+    double density() const;
+    double toggleRate() const;
+    double rawToggleRate() const;
+    double cellDensity(int col, int row) const;
+
+    // Start a frame. Buffers are kept across frames of the same geometry.
+    void reset(int width, int height, int gridCols, int gridRows);
+    // Count one packed row (MSB first); `previous` is the same row of the previous
+    // frame and `dx`/`dy` are the row's gradients, each null when not available
+    void addPackedRow(int y, const uint8_t* row, const uint8_t* previous, const short* dx, const short* dy);
+    void finish();
+
+    // {"frameId":..,"edgeCount":..,"density":..,"bbox":[x,y,w,h],"meanGradient":..|null,
+    //  "toggleRate":..|null,"rawToggleRate":..|null,"grid":{"cols":..,"rows":..,"density":[...]}}
+    std::string toJson() const;
+
+private:
+    // Bytes of a packed row lying wholly in each grid column, and the bytes a column
+    // boundary falls inside (x = byte, y = column of its first pixel)
+    std::vector<cv::Range> cellBytes;
+    std::vector<cv::Point> splitBytes;
+    std::vector<int> cellStart;
+    uint64_t gradientSum = 0;
+    uint64_t gradientCount = 0;
+    int minX = 0;
+    int maxX = -1;
+    int minY = 0;
+    int maxY = -1;
+};
+
+#endif // EDGE_STATS_H
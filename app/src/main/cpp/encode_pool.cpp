@@ -0,0 +1,226 @@
+#include "encode_pool.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "EncodePool"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+void EncodedFrameCache::store(std::vector<uint8_t>&& data, const FrameInfo& info) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Workers may finish out of order; never replace a newer frame
+        if (info.generation <= current.generation) {
+            return;
+        }
+        bytes = std::move(data);
+        current = info;
+    }
+    encodedLatency.recordSince(info.meta.originNs());
+    cond.notify_all();
+}
+
+bool EncodedFrameCache::latest(std::vector<uint8_t>& out, FrameInfo& info) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current.generation == 0) {
+        return false;
+    }
+    out = bytes;
+    info = current;
+    return true;
+}
+
+bool EncodedFrameCache::waitNewer(uint64_t after, int timeoutMs, std::vector<uint8_t>& out, FrameInfo& info) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return current.generation > after; })) {
+        return false;
+    }
+    out = bytes;
+    info = current;
+    return true;
+}
+
+EncodePool::EncodePool(const Config& cfg) : config(cfg), jpegQuality(cfg.jpegQuality) {
+    config.workers = std::max(1, config.workers);
+    config.queueCapacity = std::max(1, config.queueCapacity);
+    // One buffer per queue slot plus one per worker: submit always finds a buffer
+    queueCapacity = config.queueCapacity;
+    freeBuffers.resize(config.queueCapacity + config.workers);
+    for (int i = 0; i < config.workers; i++) {
+        workers.emplace_back(&EncodePool::workerLoop, this);
+    }
+    LOGI("Started %d encode worker(s), queue capacity %d", config.workers, config.queueCapacity);
+}
+
+EncodePool::~EncodePool() {
+    stop();
+}
+
+EncodePool& EncodePool::instance() {
+    static EncodePool pool(Config{});
+    return pool;
+}
+
+bool EncodePool::submit(const cv::Mat& edges, uint64_t generation, const FrameMeta& meta,
+                        std::shared_ptr<EncodedFrameCache> target) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stopping || !target) {
+        return false;
+    }
+    if (!enabled.load(std::memory_order_relaxed)) {
+        counters.skipped++;
+        return false;
+    }
+
+    Job job;
+    auto pending = std::find_if(queue.begin(), queue.end(), [&](const Job& queued) { return queued.target == target; });
+    if (pending != queue.end()) {
+        // This output's previous frame has not started encoding: replace it
+        job.buffer = std::move(pending->buffer);
+        queue.erase(pending);
+        counters.dropped++;
+    } else if (!freeBuffers.empty()) {
+        job.buffer = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+    } else if (queue.empty()) {
+        // Every buffer is being filled by another submitter or encoded
+        counters.dropped++;
+        return false;
+    } else {
+        // Queue is full: recycle the oldest pending frame's buffer
+        job.buffer = std::move(queue.front().buffer);
+        queue.pop_front();
+        counters.dropped++;
+    }
+    counters.submitted++;
+    lock.unlock();
+
+    // Copy outside the lock; buffers keep their allocation across frames
+    edges.copyTo(job.buffer);
+    job.generation = generation;
+    job.meta = meta;
+    job.target = std::move(target);
+
+    lock.lock();
+    queue.push_back(std::move(job));
+    lock.unlock();
+    workAvailable.notify_one();
+    return true;
+}
+
+void EncodePool::workerLoop() {
+    ThreadPlacement::Scope placement(ThreadRole::Background);
+    std::vector<uint8_t> encoded;
+    std::vector<int> params(2);
+    params[0] = cv::IMWRITE_JPEG_QUALITY;
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping && queue.empty()) {
+                return;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+            busyWorkers++;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = false;
+        try {
+            // Single-channel JPEG: no RGBA expansion, a third of the input bytes
+            params[1] = jpegQuality.load(std::memory_order_relaxed);
+            ok = cv::imencode(".jpg", job.buffer, encoded, params);
+        } catch (const cv::Exception& e) {
+            LOGE("JPEG encode failed: %s", e.what());
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (ok) {
+            FrameInfo info;
+            info.width = job.buffer.cols;
+            info.height = job.buffer.rows;
+            info.generation = job.generation;
+            info.meta = job.meta;
+            info.meta.encodeEndNs = frameClockNs();
+            job.target->store(std::move(encoded), info);
+            encoded = std::vector<uint8_t>();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ok) {
+                counters.avgEncodeMs = counters.encoded == 0 ? ms : counters.avgEncodeMs * 0.9 + ms * 0.1;
+                counters.encoded++;
+            }
+            freeBuffers.push_back(std::move(job.buffer));
+            job.target.reset();
+            busyWorkers--;
+        }
+        idle.notify_all();
+    }
+}
+
+void EncodePool::setEnabled(bool value) {
+    bool previous = enabled.exchange(value);
+    if (previous != value) {
+        LOGI("Encoding %s", value ? "enabled" : "disabled (no viewers)");
+    }
+}
+
+void EncodePool::setStreamCount(int streams) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return;
+    }
+    int capacity = std::max(queueCapacity, streams);
+    int cores = static_cast<int>(ThreadPlacement::instance().cpusFor(ThreadRole::Background).size());
+    int wanted = std::max(static_cast<int>(workers.size()), std::min(streams, std::max(1, cores)));
+    if (capacity == queueCapacity && wanted == static_cast<int>(workers.size())) {
+        return;
+    }
+    // One more buffer per queue slot and per worker, as at construction
+    int added = capacity - queueCapacity + wanted - static_cast<int>(workers.size());
+    freeBuffers.resize(freeBuffers.size() + added);
+    queueCapacity = capacity;
+    while (static_cast<int>(workers.size()) < wanted) {
+        workers.emplace_back(&EncodePool::workerLoop, this);
+    }
+    LOGI("Encode pool sized for %d stream(s): %zu worker(s), queue capacity %d", streams, workers.size(),
+         queueCapacity);
+}
+
+void EncodePool::setJpegQuality(int quality) {
+    jpegQuality.store(std::max(1, std::min(100, quality)));
+}
+
+EncodePool::Stats EncodePool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void EncodePool::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && busyWorkers == 0; });
+}
+
+void EncodePool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    workers.clear();
+}
@@ -0,0 +1,112 @@
+#ifndef ENCODE_POOL_H
+#define ENCODE_POOL_H
+
+#include "frame_meta.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Latest encoded frame for one output, with a wait for the next generation.
+class EncodedFrameCache {
+public:
+    void store(std::vector<uint8_t>&& bytes, const FrameInfo& info);
+    bool latest(std::vector<uint8_t>& out, FrameInfo& info) const;
+    // Wait until a generation newer than `after` is available (or timeout)
+    bool waitNewer(uint64_t after, int timeoutMs, std::vector<uint8_t>& out, FrameInfo& info) const;
+
+    // Capture-to-encoded latency of every stored frame
+    const LatencyHistogram& latency() const { return encodedLatency; }
+
+private:
+    mutable std::mutex mutex;
+    mutable std::condition_variable cond;
+    std::vector<uint8_t> bytes;
+    FrameInfo current;
+    LatencyHistogram encodedLatency;
+};
+
+// JPEG encode stage running on its own worker threads.
+//
+// The detection thread hands over edge maps by copying them into a buffer taken
+// from a fixed recycled pool; workers drain a bounded queue. Latest wins per
+// output: a new frame replaces its target's queued one, so streams never evict
+// each other's frames, and only when every buffer is taken is the oldest queued
+// frame dropped. Detection never waits on encoding and memory stays at
+// `queueCapacity + workers` buffers; setStreamCount grows both with the streams.
+class EncodePool {
+public:
+    struct Config {
+        int workers = 1;
+        int queueCapacity = 2;
+        int jpegQuality = 70;
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t encoded = 0;
+        uint64_t dropped = 0;
+        uint64_t skipped = 0;
+        double avgEncodeMs = 0.0;
+    };
+
+    explicit EncodePool(const Config& config);
+    ~EncodePool();
+
+    // Process-wide pool used by the JNI layer
+    static EncodePool& instance();
+
+    // Queue an edge map for encoding into `target`. Returns false when skipped. Jobs
+    // share ownership of their target, so it outlives a stream removed meanwhile.
+    bool submit(const cv::Mat& edges, uint64_t generation, const FrameMeta& meta,
+                std::shared_ptr<EncodedFrameCache> target);
+
+    // Encoding is skipped entirely while no viewer is subscribed
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // One queue slot per stream and up to one worker per stream (at most one per core
+    // background threads may use); never shrinks
+    void setStreamCount(int streams);
+
+    void setJpegQuality(int quality);
+    Stats stats() const;
+
+    // Wait until every queued job has been encoded
+    void drain();
+    void stop();
+
+private:
+    struct Job {
+        cv::Mat buffer;
+        uint64_t generation = 0;
+        FrameMeta meta;
+        std::shared_ptr<EncodedFrameCache> target;
+    };
+
+    void workerLoop();
+
+    Config config;
+    std::atomic<bool> enabled{true};
+    std::atomic<int> jpegQuality;
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::deque<Job> queue;
+    std::vector<cv::Mat> freeBuffers;
+    // Current sizes; start at the config's and grow with setStreamCount
+    int queueCapacity = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    Stats counters;
+};
+
+#endif // ENCODE_POOL_H
@@ -0,0 +1,200 @@
+#include "fixed_point_filter.h"
+#include "simd_util.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+std::vector<uint16_t> FixedPointFilter::gaussianKernel(int ksize, double sigma) {
+    CV_Assert(ksize > 0 && (ksize & 1) == 1);
+    std::vector<double> k(ksize);
+    if (sigma <= 0 && ksize <= 7) {
+        // OpenCV's fixed tables for the default sigma of small kernels
+        static const double k3[] = {0.25, 0.5, 0.25};
+        static const double k5[] = {0.0625, 0.25, 0.375, 0.25, 0.0625};
+        static const double k7[] = {0.03125, 0.109375, 0.21875, 0.28125, 0.21875, 0.109375, 0.03125};
+        const double* table = ksize == 1 ? nullptr : ksize == 3 ? k3 : ksize == 5 ? k5 : k7;
+        for (int i = 0; i < ksize; i++) {
+            k[i] = table ? table[i] : 1.0;
+        }
+    } else {
+        // getGaussianKernelBitExact: same operation order, so the same doubles
+        double s = sigma > 0 ? sigma : ksize * 0.15 + 0.35;
+        double scale = -0.125 / (s * s);
+        int half = (ksize - 1) / 2;
+        std::vector<double> values(half);
+        double sum = 0.0;
+        for (int i = 0, x = 1 - ksize; i < half; i++, x += 2) {
+            values[i] = std::exp(static_cast<double>(x * x) * scale);
+            sum += values[i];
+        }
+        sum = sum * 2 + 1.0;
+        double norm = 1.0 / sum;
+        for (int i = 0; i < half; i++) {
+            k[i] = k[ksize - 1 - i] = values[i] * norm;
+        }
+        k[half] = norm;
+    }
+
+    // Round with error diffusion from the tails inwards; the center takes the remainder
+    // so the integer kernel sums to exactly 1.0
+    std::vector<uint16_t> q(ksize);
+    const int one = 1 << kBlurKernelBits;
+    int half = ksize / 2;
+    double err = 0.0;
+    int sum = 0;
+    for (int i = 0; i < half; i++) {
+        double adjusted = k[i] * one + err;
+        int v = cvRound(adjusted);
+        err = adjusted - v;
+        q[i] = q[ksize - 1 - i] = static_cast<uint16_t>(v);
+        sum += v;
+    }
+    q[half] = static_cast<uint16_t>(one - 2 * sum);
+    return q;
+}
+
+FixedPointFilter::FixedPointFilter(int ksize, double sigma) : kernel(gaussianKernel(ksize, sigma)) {
+    // The kernels the pipeline variants use run their unrolled passes here too
+    if ((ksize == 3 && sigma == BlurTaps<3>::kSigma) || (ksize == 5 && sigma == BlurTaps<5>::kSigma)) {
+        const uint16_t* taps = ksize == 3 ? BlurTaps<3>::kTaps : BlurTaps<5>::kTaps;
+        CV_DbgAssert(std::equal(kernel.begin(), kernel.end(), taps));
+        unrolledSize = ksize;
+    }
+}
+
+void FixedPointFilter::horizontal(const uint8_t* src, int width, uint16_t* out) const {
+    switch (unrolledSize) {
+        case 3:
+            blurRowHorizontal<3>(src, width, BlurTaps<3>::kTaps, out);
+            break;
+        case 5:
+            blurRowHorizontal<5>(src, width, BlurTaps<5>::kTaps, out);
+            break;
+        default:
+            blurRowHorizontal(src, width, kernel.data(), out, ksize());
+            break;
+    }
+}
+
+void FixedPointFilter::vertical(const uint16_t* const* rows, int width, uint8_t* out) const {
+    switch (unrolledSize) {
+        case 3:
+            blurRowVertical<3>(rows, width, BlurTaps<3>::kTaps, out);
+            break;
+        case 5:
+            blurRowVertical<5>(rows, width, BlurTaps<5>::kTaps, out);
+            break;
+        default:
+            blurRowVertical(rows, width, kernel.data(), out, ksize());
+            break;
+    }
+}
+
+// 3x3 Sobel of one row from the blurred rows above (a), at (b) and below (c),
+// replicating the first and last column
+static void sobelRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, int width, short* dx, short* dy) {
+    auto pixel = [&](int x) {
+        int l = std::max(x - 1, 0);
+        int r = std::min(x + 1, width - 1);
+        dx[x] = static_cast<short>((a[r] - a[l]) + 2 * (b[r] - b[l]) + (c[r] - c[l]));
+        dy[x] = static_cast<short>((c[l] + 2 * c[x] + c[r]) - (a[l] + 2 * a[x] + a[r]));
+    };
+    pixel(0);
+    int x = 1;
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const int half = cv::VTraits<cv::v_int16>::vlanes();
+    for (; x + lanes < width; x += lanes) {
+        cv::v_int16 a0[2], a1[2], a2[2], b0[2], b2[2], c0[2], c1[2], c2[2];
+        expandS16(a + x - 1, a0[0], a0[1]);
+        expandS16(a + x, a1[0], a1[1]);
+        expandS16(a + x + 1, a2[0], a2[1]);
+        expandS16(b + x - 1, b0[0], b0[1]);
+        expandS16(b + x + 1, b2[0], b2[1]);
+        expandS16(c + x - 1, c0[0], c0[1]);
+        expandS16(c + x, c1[0], c1[1]);
+        expandS16(c + x + 1, c2[0], c2[1]);
+        for (int i = 0; i < 2; i++) {
+            cv::v_int16 center = cv::v_sub(b2[i], b0[i]);
+            cv::v_int16 gx = cv::v_add(cv::v_add(cv::v_sub(a2[i], a0[i]), cv::v_sub(c2[i], c0[i])),
+                                       cv::v_add(center, center));
+            cv::v_int16 below = cv::v_add(cv::v_add(c0[i], c2[i]), cv::v_add(c1[i], c1[i]));
+            cv::v_int16 above = cv::v_add(cv::v_add(a0[i], a2[i]), cv::v_add(a1[i], a1[i]));
+            cv::v_store(dx + x + i * half, gx);
+            cv::v_store(dy + x + i * half, cv::v_sub(below, above));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        pixel(x);
+    }
+}
+
+void FixedPointFilter::apply(const cv::Mat& gray, cv::Mat& blur, cv::Mat* dx, cv::Mat* dy,
+                             int rowBegin, int rowEnd) const {
+    CV_Assert(gray.type() == CV_8UC1 && blur.type() == CV_8UC1 && blur.size() == gray.size());
+    const bool gradients = dx && dy;
+    if (gradients) {
+        CV_Assert(dx->type() == CV_16SC1 && dx->size() == gray.size() &&
+                  dy->type() == CV_16SC1 && dy->size() == gray.size());
+    }
+    const int rows = gray.rows;
+    const int width = gray.cols;
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, rows);
+    if (rowBegin >= rowEnd) {
+        return;
+    }
+    const int n = ksize();
+    const int r = n / 2;
+
+    // Sobel needs one blurred row of context on each side; context rows owned by a
+    // neighbouring range are recomputed here rather than read
+    const int first = gradients ? std::max(rowBegin - 1, 0) : rowBegin;
+    const int last = gradients ? std::min(rowEnd + 1, rows) : rowEnd;
+
+    // Ring of horizontally filtered rows, indexed by unreflected source row
+    cv::AutoBuffer<uint16_t> ring(static_cast<size_t>(n) * width);
+    cv::AutoBuffer<uint8_t> context(static_cast<size_t>(2) * width);
+    uint8_t* contextAbove = context.data();
+    uint8_t* contextBelow = context.data() + width;
+    auto ringRow = [&](int j) { return ring.data() + static_cast<size_t>((j - first + n) % n) * width; };
+    auto blurRow = [&](int y) -> uint8_t* {
+        if (y < rowBegin) {
+            return contextAbove;
+        }
+        return y >= rowEnd ? contextBelow : blur.ptr<uint8_t>(y);
+    };
+
+    for (int j = first - r; j < first + r; j++) {
+        horizontal(gray.ptr<uint8_t>(reflect101(j, rows)), width, ringRow(j));
+    }
+    cv::AutoBuffer<const uint16_t*> taps(n);
+    int nextGradientRow = rowBegin;
+    for (int y = first; y < last; y++) {
+        // Row y + r enters the window; row y - r - 1 just left it, so reuse its slot
+        horizontal(gray.ptr<uint8_t>(reflect101(y + r, rows)), width, ringRow(y + r));
+        for (int i = 0; i < n; i++) {
+            taps[i] = ringRow(y - r + i);
+        }
+        vertical(taps.data(), width, blurRow(y));
+
+        // Gradients of a row are ready once the blurred row below it (replicated at the
+        // bottom edge) exists
+        while (gradients && nextGradientRow < rowEnd && std::min(nextGradientRow + 1, rows - 1) <= y) {
+            int g = nextGradientRow++;
+            sobelRow(blurRow(std::max(g - 1, 0)), blurRow(g), blurRow(std::min(g + 1, rows - 1)), width,
+                     dx->ptr<short>(g), dy->ptr<short>(g));
+        }
+    }
+    cv::vx_cleanup();
+}
+
+void FixedPointFilter::apply(const cv::Mat& gray, cv::Mat& blur, cv::Mat* dx, cv::Mat* dy) const {
+    blur.create(gray.size(), CV_8UC1);
+    if (dx && dy) {
+        dx->create(gray.size(), CV_16SC1);
+        dy->create(gray.size(), CV_16SC1);
+    }
+    apply(gray, blur, dx, dy, 0, gray.rows);
+}
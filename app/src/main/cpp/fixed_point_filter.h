@@ -0,0 +1,46 @@
+#ifndef FIXED_POINT_FILTER_H
+#define FIXED_POINT_FILTER_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+// All-integer Gaussian blur and 3x3 Sobel in one pass over the frame.
+//
+// The blur uses the Q8 kernel OpenCV derives for 8-bit GaussianBlur (sampled
+// Gaussian, error-diffused to integers summing to 256; e.g. [61 134 61] for 3/0.8
+// and [28 61 78 61 28] for 5/1.4), a Q8 horizontal and a Q16 vertical pass with
+// round-half-up, and BORDER_REFLECT_101, so it is bit-exact with
+// cv::GaussianBlur. The gradients match cv::Sobel(CV_16S, BORDER_REPLICATE) on
+// the blurred frame, which is what cv::Canny computes internally, so
+// cv::Canny(dx, dy, ...) gives the same edges as cv::Canny(blur, ...). Integer
+// arithmetic makes results identical on ARM and x86.
+class FixedPointFilter {
+public:
+    // Q8 kernel of an odd-sized Gaussian as OpenCV's bit-exact path computes it
+    static std::vector<uint16_t> gaussianKernel(int ksize, double sigma);
+
+    FixedPointFilter(int ksize, double sigma);
+
+    int ksize() const { return static_cast<int>(kernel.size()); }
+    const std::vector<uint16_t>& coefficients() const { return kernel; }
+
+    // Filter rows [rowBegin, rowEnd) of `gray` (CV_8UC1). `blur` must already be
+    // gray-sized CV_8UC1 and, when given, `dx`/`dy` gray-sized CV_16SC1. Rows outside
+    // the range are read from `gray` but never written, so disjoint ranges can run
+    // concurrently on the same outputs.
+    void apply(const cv::Mat& gray, cv::Mat& blur, cv::Mat* dx, cv::Mat* dy, int rowBegin, int rowEnd) const;
+
+    // Whole frame; allocates the outputs as needed
+    void apply(const cv::Mat& gray, cv::Mat& blur, cv::Mat* dx = nullptr, cv::Mat* dy = nullptr) const;
+
+private:
+    void horizontal(const uint8_t* src, int width, uint16_t* out) const;
+    void vertical(const uint16_t* const* rows, int width, uint8_t* out) const;
+
+    std::vector<uint16_t> kernel;
+    // Kernel size of the matching BlurTaps table, 0 for the generic passes
+    int unrolledSize = 0;
+};
+
+#endif // FIXED_POINT_FILTER_H
@@ -0,0 +1,77 @@
+#include "frame_meta.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <time.h>
+
+int64_t frameClockNs() {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static double bucketUpperMs(int index) {
+    return static_cast<double>(1LL << index);
+}
+
+void LatencyHistogram::record(int64_t latencyNs) {
+    if (latencyNs < 0) {
+        latencyNs = 0;
+    }
+    int64_t ms = latencyNs / 1000000;
+    int index = 0;
+    while (index < kBuckets - 1 && ms >= (1LL << index)) {
+        index++;
+    }
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(latencyNs, std::memory_order_relaxed);
+    int64_t previous = maxNs.load(std::memory_order_relaxed);
+    while (latencyNs > previous && !maxNs.compare_exchange_weak(previous, latencyNs, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::recordSince(int64_t originNs) {
+    if (originNs != 0) {
+        record(frameClockNs() - originNs);
+    }
+}
+
+double LatencyHistogram::percentileMs(double p) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0.0;
+    }
+    double maxMs = maxNs.load(std::memory_order_relaxed) / 1e6;
+    uint64_t target = static_cast<uint64_t>(p * n);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            return i == kBuckets - 1 ? maxMs : std::min(bucketUpperMs(i), maxMs);
+        }
+    }
+    return maxMs;
+}
+
+std::string LatencyHistogram::toJson() const {
+    uint64_t n = count();
+    std::string json;
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+             "{\"count\":%llu,\"meanMs\":%.2f,\"p50Ms\":%.1f,\"p90Ms\":%.1f,\"p99Ms\":%.1f,\"maxMs\":%.2f,\"buckets\":[",
+             (unsigned long long)n, n ? sumNs.load(std::memory_order_relaxed) / 1e6 / n : 0.0,
+             percentileMs(0.5), percentileMs(0.9), percentileMs(0.99), maxNs.load(std::memory_order_relaxed) / 1e6);
+    json += buf;
+    for (int i = 0; i < kBuckets; i++) {
+        snprintf(buf, sizeof(buf), "%s%llu", i ? "," : "", (unsigned long long)buckets[i].load(std::memory_order_relaxed));
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
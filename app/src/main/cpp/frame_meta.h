@@ -0,0 +1,55 @@
+#ifndef FRAME_META_H
+#define FRAME_META_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Timing metadata carried with a frame from capture to serving.
+// All timestamps are nanoseconds on frameClockNs() (CLOCK_BOOTTIME), the same clock as
+// SystemClock.elapsedRealtimeNanos() and Camera2 timestamps with a REALTIME source.
+// Zero means "not recorded".
+struct FrameMeta {
+    uint64_t frameId = 0;
+    int64_t sensorTimestampNs = 0;
+    int64_t enqueueNs = 0;
+    int64_t processStartNs = 0;
+    int64_t processEndNs = 0;
+    int64_t encodeEndNs = 0;
+
+    // Capture time, falling back to enqueue time when the sensor clock is not comparable
+    int64_t originNs() const { return sensorTimestampNs != 0 ? sensorTimestampNs : enqueueNs; }
+};
+
+// Geometry, generation and timing of a cached output frame
+struct FrameInfo {
+    int width = 0;
+    int height = 0;
+    uint64_t generation = 0;
+    FrameMeta meta;
+};
+
+int64_t frameClockNs();
+
+// Lock-free latency histogram with power-of-two millisecond buckets.
+class LatencyHistogram {
+public:
+    static const int kBuckets = 14;  // <1, <2, <4, ... <4096 ms, overflow
+
+    void record(int64_t latencyNs);
+    // Record now - origin for a frame, ignoring frames without an origin
+    void recordSince(int64_t originNs);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    // Approximate percentile (bucket upper bound, clamped to the max seen)
+    double percentileMs(double p) const;
+    std::string toJson() const;
+
+private:
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<int64_t> sumNs{0};
+    std::atomic<int64_t> maxNs{0};
+};
+
+#endif // FRAME_META_H
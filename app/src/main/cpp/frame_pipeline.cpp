@@ -0,0 +1,330 @@
+#include "frame_pipeline.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define LOG_TAG "FramePipeline"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// Spin briefly, then yield, then sleep: queues are lock-free, so idle stages poll
+static void backoff(int& attempt) {
+    if (attempt < 64) {
+        attempt++;
+    } else if (attempt < 128) {
+        attempt++;
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+static int poolSizeFor(const FramePipeline::Config& config) {
+    // One frame per worker and per queue slot, plus the one being published and one being ingested
+    return config.detectWorkers + config.encodeWorkers + config.queueCapacity + 2;
+}
+
+FramePipeline::FramePipeline(std::shared_ptr<StreamContext> stream, const Config& cfg)
+    : context(std::move(stream)),
+      config(cfg),
+      freeFrames(static_cast<size_t>(poolSizeFor(cfg))),
+      detectQueue(static_cast<size_t>(std::max(1, cfg.queueCapacity))),
+      encodeQueue(static_cast<size_t>(std::max(1, cfg.queueCapacity))),
+      publishQueue(static_cast<size_t>(poolSizeFor(cfg))) {
+    config.detectWorkers = std::max(1, config.detectWorkers);
+    config.encodeWorkers = std::max(1, config.encodeWorkers);
+
+    int poolSize = poolSizeFor(config);
+    for (int i = 0; i < poolSize; i++) {
+        pool.emplace_back(new PipelineFrame());
+        freeFrames.tryPush(pool.back().get());
+    }
+    reorder.assign(poolSize, nullptr);
+
+    stages[kIngest].name = "ingest";
+    stages[kIngest].workers = 1;
+    stages[kDetect].name = "detect";
+    stages[kDetect].workers = config.detectWorkers;
+    stages[kEncode].name = "encode";
+    stages[kEncode].workers = config.encodeWorkers;
+    stages[kPublish].name = "publish";
+    stages[kPublish].workers = 1;
+
+    startNs = frameClockNs();
+    for (int i = 0; i < config.detectWorkers; i++) {
+        threads.emplace_back(&FramePipeline::runStage, this, kDetect, &detectQueue, &encodeQueue, &gauges[1],
+                             [this](PipelineFrame& frame) { detect(frame); });
+    }
+    for (int i = 0; i < config.encodeWorkers; i++) {
+        threads.emplace_back(&FramePipeline::runStage, this, kEncode, &encodeQueue, &publishQueue, &gauges[2],
+                             [this](PipelineFrame& frame) { encode(frame); });
+    }
+    threads.emplace_back(&FramePipeline::publishLoop, this);
+    LOGI("Stream %d pipeline: %d detect, %d encode worker(s), %d pooled frames",
+         context->id(), config.detectWorkers, config.encodeWorkers, poolSize);
+}
+
+FramePipeline::~FramePipeline() {
+    stop();
+}
+
+bool FramePipeline::pop(FrameQueue& queue, PipelineFrame*& frame, Stage& stage) {
+    int attempt = 0;
+    int64_t waitStart = 0;
+    while (!queue.tryPop(frame)) {
+        if (stopping.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (waitStart == 0) {
+            waitStart = frameClockNs();
+        }
+        backoff(attempt);
+    }
+    if (waitStart != 0) {
+        stage.starveNs.fetch_add(frameClockNs() - waitStart, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool FramePipeline::push(FrameQueue& queue, Gauge& gauge, PipelineFrame* frame, Stage& stage) {
+    int attempt = 0;
+    int64_t waitStart = 0;
+    while (!queue.tryPush(frame)) {
+        if (stopping.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (waitStart == 0) {
+            waitStart = frameClockNs();
+        }
+        backoff(attempt);
+    }
+    if (waitStart != 0) {
+        stage.stallNs.fetch_add(frameClockNs() - waitStart, std::memory_order_relaxed);
+    }
+
+    // Occupancy is sampled at every push
+    int depth = static_cast<int>(queue.sizeApprox());
+    gauge.samples.fetch_add(1, std::memory_order_relaxed);
+    gauge.total.fetch_add(depth, std::memory_order_relaxed);
+    int previous = gauge.max.load(std::memory_order_relaxed);
+    while (depth > previous && !gauge.max.compare_exchange_weak(previous, depth, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+bool FramePipeline::submit(const uint8_t* data, int width, int height, int rowStride, int pixelStride,
+                           int64_t sensorTimestampNs) {
+    if (!data || width <= 0 || height <= 0 || pixelStride <= 0 || rowStride < (width - 1) * pixelStride + 1) {
+        return false;
+    }
+    Stage& stage = stages[kIngest];
+    submitted.fetch_add(1, std::memory_order_relaxed);
+
+    PipelineFrame* frame = nullptr;
+    if (config.dropWhenFull) {
+        if (!freeFrames.tryPop(frame)) {
+            // Every pooled frame is in flight: the pipeline is saturated
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } else if (!pop(freeFrames, frame, stage)) {
+        return false;
+    }
+
+    int64_t start = frameClockNs();
+    frame->gray.create(height, width, CV_8UC1);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = data + static_cast<size_t>(y) * rowStride;
+        uint8_t* dst = frame->gray.ptr<uint8_t>(y);
+        if (pixelStride == 1) {
+            memcpy(dst, src, width);
+        } else {
+            for (int x = 0; x < width; x++) {
+                dst[x] = src[x * pixelStride];
+            }
+        }
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->detected = false;
+    frame->encoded = false;
+    frame->sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    frame->meta = FrameMeta();
+    frame->meta.frameId = frame->sequence;
+    frame->meta.sensorTimestampNs = sensorTimestampNs;
+    frame->meta.enqueueNs = start;
+    stage.busyNs.fetch_add(frameClockNs() - start, std::memory_order_relaxed);
+    stage.processed.fetch_add(1, std::memory_order_relaxed);
+
+    return push(detectQueue, gauges[0], frame, stage);
+}
+
+void FramePipeline::runStage(StageId id, FrameQueue* input, FrameQueue* output, Gauge* outputGauge,
+                             const std::function<void(PipelineFrame&)>& work) {
+    // Detection is on the frame's critical path; encoding may trail behind
+    ThreadPlacement::Scope placement(id == kDetect ? ThreadRole::Latency : ThreadRole::Background);
+    Stage& stage = stages[id];
+    PipelineFrame* frame = nullptr;
+    while (pop(*input, frame, stage)) {
+        int64_t start = frameClockNs();
+        work(*frame);
+        stage.busyNs.fetch_add(frameClockNs() - start, std::memory_order_relaxed);
+        stage.processed.fetch_add(1, std::memory_order_relaxed);
+        if (!push(*output, *outputGauge, frame, stage)) {
+            return;
+        }
+    }
+}
+
+void FramePipeline::detect(PipelineFrame& frame) {
+    StreamParams p = context->params();
+    frame.meta.processStartNs = frameClockNs();
+    try {
+        // Buffers are (re)allocated only when the resolution changes
+        StreamContext::detect(frame.gray, frame.blur, frame.edges, p);
+        frame.detected = true;
+    } catch (const cv::Exception& e) {
+        LOGE("Stream %d: detect failed: %s", context->id(), e.what());
+    }
+    frame.meta.processEndNs = frameClockNs();
+}
+
+void FramePipeline::encode(PipelineFrame& frame) {
+    // Like the inline path, encode only while someone is watching
+    if (!frame.detected || !context->wantsEncode()) {
+        return;
+    }
+    try {
+        std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, config.jpegQuality};
+        frame.encoded = cv::imencode(".jpg", frame.edges, frame.jpeg, params);
+        frame.meta.encodeEndNs = frameClockNs();
+    } catch (const cv::Exception& e) {
+        LOGE("Stream %d: JPEG encode failed: %s", context->id(), e.what());
+    }
+}
+
+void FramePipeline::publish(PipelineFrame& frame) {
+    if (!frame.detected) {
+        return;
+    }
+    uint64_t generation = context->packedCache().publish(frame.edges, frame.meta);
+    if (frame.encoded) {
+        FrameInfo info;
+        info.width = frame.width;
+        info.height = frame.height;
+        info.generation = generation;
+        info.meta = frame.meta;
+        context->jpegCache().store(std::move(frame.jpeg), info);
+        frame.jpeg = std::vector<uint8_t>();
+    }
+}
+
+void FramePipeline::publishLoop() {
+    ThreadPlacement::Scope placement(ThreadRole::Background);
+    Stage& stage = stages[kPublish];
+    const size_t window = reorder.size();
+    PipelineFrame* frame = nullptr;
+    while (pop(publishQueue, frame, stage)) {
+        // Parallel workers may finish out of order; at most `window` frames are in flight
+        reorder[frame->sequence % window] = frame;
+        while (true) {
+            PipelineFrame*& next = reorder[nextPublish % window];
+            if (!next || next->sequence != nextPublish) {
+                break;
+            }
+            int64_t start = frameClockNs();
+            publish(*next);
+            stage.busyNs.fetch_add(frameClockNs() - start, std::memory_order_relaxed);
+            stage.processed.fetch_add(1, std::memory_order_relaxed);
+
+            PipelineFrame* done = next;
+            next = nullptr;
+            nextPublish++;
+            published.fetch_add(1, std::memory_order_release);
+            freeFrames.tryPush(done);
+        }
+    }
+}
+
+void FramePipeline::drain() {
+    int attempt = 0;
+    while (!stopping.load(std::memory_order_relaxed) &&
+           published.load(std::memory_order_acquire) < nextSequence.load(std::memory_order_relaxed) - 1) {
+        backoff(attempt);
+    }
+}
+
+void FramePipeline::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    for (auto& t : threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads.clear();
+}
+
+FramePipeline::Stats FramePipeline::stats() const {
+    Stats s;
+    s.submitted = submitted.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.published = published.load(std::memory_order_relaxed);
+
+    double wallMs = std::max(1e-3, (frameClockNs() - startNs) / 1e6);
+    for (const Stage& stage : stages) {
+        StageStats st;
+        st.name = stage.name;
+        st.workers = stage.workers;
+        st.processed = stage.processed.load(std::memory_order_relaxed);
+        st.busyMs = stage.busyNs.load(std::memory_order_relaxed) / 1e6;
+        st.stallMs = stage.stallNs.load(std::memory_order_relaxed) / 1e6;
+        st.starveMs = stage.starveNs.load(std::memory_order_relaxed) / 1e6;
+        st.utilization = st.busyMs / (wallMs * stage.workers);
+        s.stages.push_back(st);
+    }
+
+    const char* queueNames[] = {"detect", "encode", "publish"};
+    const FrameQueue* queues[] = {&detectQueue, &encodeQueue, &publishQueue};
+    for (int i = 0; i < 3; i++) {
+        QueueStats q;
+        q.name = queueNames[i];
+        q.capacity = static_cast<int>(queues[i]->capacity());
+        q.maxOccupancy = gauges[i].max.load(std::memory_order_relaxed);
+        uint64_t samples = gauges[i].samples.load(std::memory_order_relaxed);
+        q.avgOccupancy = samples ? static_cast<double>(gauges[i].total.load(std::memory_order_relaxed)) / samples : 0.0;
+        s.queues.push_back(q);
+    }
+    return s;
+}
+
+std::string FramePipeline::statsJson() const {
+    Stats s = stats();
+    char buf[256];
+    snprintf(buf, sizeof(buf), "{\"stream\":%d,\"submitted\":%llu,\"dropped\":%llu,\"published\":%llu,\"stages\":[",
+             context->id(), (unsigned long long)s.submitted, (unsigned long long)s.dropped,
+             (unsigned long long)s.published);
+    std::string json(buf);
+    for (size_t i = 0; i < s.stages.size(); i++) {
+        const StageStats& st = s.stages[i];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"%s\",\"workers\":%d,\"processed\":%llu,\"busyMs\":%.1f,\"stallMs\":%.1f,"
+                 "\"starveMs\":%.1f,\"utilization\":%.2f}",
+                 i ? "," : "", st.name.c_str(), st.workers, (unsigned long long)st.processed,
+                 st.busyMs, st.stallMs, st.starveMs, st.utilization);
+        json += buf;
+    }
+    json += "],\"queues\":[";
+    for (size_t i = 0; i < s.queues.size(); i++) {
+        const QueueStats& q = s.queues[i];
+        snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"capacity\":%d,\"avgOccupancy\":%.2f,\"maxOccupancy\":%d}",
+                 i ? "," : "", q.name.c_str(), q.capacity, q.avgOccupancy, q.maxOccupancy);
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,145 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include "bounded_queue.h"
+#include "stream_registry.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A frame travelling through the pipeline. Frames come from a fixed pool and keep
+// their buffers across uses, so steady-state processing does not allocate.
+struct PipelineFrame {
+    uint64_t sequence = 0;
+    int width = 0;
+    int height = 0;
+    FrameMeta meta;
+    cv::Mat gray;
+    cv::Mat blur;
+    cv::Mat edges;
+    std::vector<uint8_t> jpeg;
+    bool detected = false;
+    bool encoded = false;
+};
+
+// Multi-stage processing pipeline for one stream: ingest -> detect -> encode -> publish.
+//
+// Ingest runs on the submitting thread and copies the plane into a pooled frame.
+// Detect and encode run on their own worker threads; publish runs on one thread
+// and restores submission order before writing to the stream's frame caches.
+// Stages are connected by bounded lock-free queues, so stages overlap across
+// cores and throughput is bounded by the slowest stage rather than their sum.
+class FramePipeline {
+public:
+    struct Config {
+        int detectWorkers = 1;
+        int encodeWorkers = 1;
+        int queueCapacity = 4;
+        int jpegQuality = 70;
+        // Drop a frame when every pooled frame is in flight (camera) or wait for one (batch)
+        bool dropWhenFull = true;
+    };
+
+    struct StageStats {
+        std::string name;
+        int workers = 0;
+        uint64_t processed = 0;
+        double busyMs = 0.0;
+        // Waiting for a slot in the next queue (downstream is the bottleneck)
+        double stallMs = 0.0;
+        // Waiting for input (upstream is the bottleneck)
+        double starveMs = 0.0;
+        double utilization = 0.0;
+    };
+
+    struct QueueStats {
+        std::string name;
+        int capacity = 0;
+        int maxOccupancy = 0;
+        double avgOccupancy = 0.0;
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t dropped = 0;
+        uint64_t published = 0;
+        std::vector<StageStats> stages;
+        std::vector<QueueStats> queues;
+    };
+
+    FramePipeline(std::shared_ptr<StreamContext> stream, const Config& config);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // Ingest stage: copy a plane (honoring row and pixel stride) into a pooled frame
+    bool submit(const uint8_t* data, int width, int height, int rowStride, int pixelStride = 1,
+                int64_t sensorTimestampNs = 0);
+
+    // Wait until every submitted frame has been published
+    void drain();
+    void stop();
+
+    StreamContext& stream() { return *context; }
+    Stats stats() const;
+    std::string statsJson() const;
+
+private:
+    enum StageId { kIngest = 0, kDetect, kEncode, kPublish, kStageCount };
+
+    struct Stage {
+        const char* name = "";
+        int workers = 0;
+        std::atomic<uint64_t> processed{0};
+        std::atomic<int64_t> busyNs{0};
+        std::atomic<int64_t> stallNs{0};
+        std::atomic<int64_t> starveNs{0};
+    };
+
+    struct Gauge {
+        std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> total{0};
+        std::atomic<int> max{0};
+    };
+
+    using FrameQueue = BoundedQueue<PipelineFrame*>;
+
+    void runStage(StageId id, FrameQueue* input, FrameQueue* output, Gauge* outputGauge,
+                  const std::function<void(PipelineFrame&)>& work);
+    void publishLoop();
+    bool pop(FrameQueue& queue, PipelineFrame*& frame, Stage& stage);
+    bool push(FrameQueue& queue, Gauge& gauge, PipelineFrame* frame, Stage& stage);
+    void detect(PipelineFrame& frame);
+    void encode(PipelineFrame& frame);
+    void publish(PipelineFrame& frame);
+
+    std::shared_ptr<StreamContext> context;
+    Config config;
+    int64_t startNs = 0;
+
+    std::vector<std::unique_ptr<PipelineFrame>> pool;
+    FrameQueue freeFrames;
+    FrameQueue detectQueue;
+    FrameQueue encodeQueue;
+    FrameQueue publishQueue;
+    Gauge gauges[3];
+
+    // Publish-side reorder window, indexed by sequence modulo the pool size
+    std::vector<PipelineFrame*> reorder;
+    uint64_t nextPublish = 1;
+
+    Stage stages[kStageCount];
+    std::atomic<uint64_t> nextSequence{1};
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> published{0};
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> threads;
+};
+
+#endif // FRAME_PIPELINE_H
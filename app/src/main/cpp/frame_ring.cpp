@@ -0,0 +1,229 @@
+#include "frame_ring.h"
+#include "buffer_pool.h"
+#include "edge_log.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define LOG_TAG "FrameRing"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+static bool isOlder(const FrameRing::Slot& slot, const FrameRing::Slot* than) {
+    return !than || slot.sequence.load(std::memory_order_relaxed) < than->sequence.load(std::memory_order_relaxed);
+}
+
+FrameRing::FrameRing(int count, size_t slotCapacity) : slotCount(count < 3 ? 3 : count) {
+    // At least three slots: one being read, one being written, one ready
+    slots = new Slot[slotCount];
+    for (int i = 0; i < slotCount; i++) {
+        ensureCapacity(slots[i], slotCapacity);
+    }
+    LOGI("Allocated %d ring slots of %zu bytes", slotCount, slotCapacity);
+}
+
+FrameRing::~FrameRing() {
+    for (int i = 0; i < slotCount; i++) {
+        BufferPool::instance().release(slots[i].data, slots[i].capacity);
+    }
+    delete[] slots;
+}
+
+bool FrameRing::ensureCapacity(Slot& slot, size_t bytes) {
+    if (slot.capacity >= bytes) {
+        return true;
+    }
+    // Only on the first frame or a resolution change
+    uint8_t* data = static_cast<uint8_t*>(BufferPool::instance().allocate(bytes));
+    if (!data) {
+        LOGE("Failed to allocate %zu byte slot", bytes);
+        return false;
+    }
+    BufferPool::instance().release(slot.data, slot.capacity);
+    slot.data = data;
+    slot.capacity = bytes;
+    return true;
+}
+
+// Copy a plane honoring row and pixel stride; returns the end of the contiguous copy
+static uint8_t* copyPlane(const uint8_t* data, int width, int height, int rowStride, int pixelStride, uint8_t* dst) {
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = data + static_cast<size_t>(y) * rowStride;
+        if (pixelStride == 1) {
+            memcpy(dst, src, width);
+        } else {
+            for (int x = 0; x < width; x++) {
+                dst[x] = src[x * pixelStride];
+            }
+        }
+        dst += width;
+    }
+    return dst;
+}
+
+uint64_t FrameRing::push(const FrameView& frame, const FrameMeta& meta) {
+    if (!frame.valid()) {
+        return 0;
+    }
+    const int width = frame.width;
+    const int height = frame.height;
+    ChromaPlanes chroma = frame.chroma();
+    bool withChroma = chroma.valid();
+
+    // Prefer a free slot; otherwise overwrite the oldest ready one
+    Slot* target = nullptr;
+    while (!target) {
+        Slot* oldest = nullptr;
+        for (int i = 0; i < slotCount; i++) {
+            uint32_t state = slots[i].state.load(std::memory_order_acquire);
+            if (state == kFree) {
+                uint32_t expected = kFree;
+                if (slots[i].state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+                    target = &slots[i];
+                    break;
+                }
+            } else if (state == kReady && isOlder(slots[i], oldest)) {
+                oldest = &slots[i];
+            }
+        }
+        if (!target && oldest) {
+            uint32_t expected = kReady;
+            // Fails only if the consumer grabbed it first; rescan in that case
+            if (oldest->state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+                target = oldest;
+                overwritten.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t bytes = static_cast<size_t>(width) * height;
+    if (withChroma) {
+        bytes += static_cast<size_t>(2) * chroma.width * chroma.height;
+    }
+    if (!ensureCapacity(*target, bytes)) {
+        target->state.store(kFree, std::memory_order_release);
+        return 0;
+    }
+
+    uint8_t* dst = target->data;
+    if (frame.layout == PixelLayout::Rgba || frame.layout == PixelLayout::Bgr) {
+        // Converted straight into the slot; luma() only reallocates a mismatched buffer
+        cv::Mat gray(height, width, CV_8UC1, dst);
+        frame.luma(gray);
+        dst += static_cast<size_t>(width) * height;
+    } else {
+        dst = copyPlane(frame.planes[0].data, width, height, frame.planes[0].rowStride, frame.planes[0].pixelStride,
+                        dst);
+    }
+    if (withChroma) {
+        dst = copyPlane(chroma.u, chroma.width, chroma.height, chroma.rowStride, chroma.pixelStride, dst);
+        copyPlane(chroma.v, chroma.width, chroma.height, chroma.rowStride, chroma.pixelStride, dst);
+    }
+    target->width = width;
+    target->height = height;
+    target->hasChroma = withChroma;
+    target->meta = meta;
+    uint64_t sequence = head.fetch_add(1, std::memory_order_relaxed) + 1;
+    target->sequence.store(sequence, std::memory_order_relaxed);
+    target->state.store(kReady, std::memory_order_seq_cst);
+
+    // Wake the consumer only if it is (about to be) sleeping
+    if (waiters.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        readyCond.notify_one();
+    }
+    return sequence;
+}
+
+FrameView FrameRing::viewOf(const Slot& slot) {
+    if (!slot.hasChroma) {
+        return FrameView::gray(slot.data, slot.width, slot.height, slot.width);
+    }
+    const int chromaWidth = (slot.width + 1) / 2;
+    const uint8_t* u = slot.data + static_cast<size_t>(slot.width) * slot.height;
+    const uint8_t* v = u + static_cast<size_t>(chromaWidth) * ((slot.height + 1) / 2);
+    return FrameView::i420(slot.data, u, v, slot.width, slot.height, slot.width, chromaWidth);
+}
+
+FrameRing::Slot* FrameRing::tryAcquire() {
+    while (true) {
+        Slot* oldest = nullptr;
+        for (int i = 0; i < slotCount; i++) {
+            if (slots[i].state.load(std::memory_order_acquire) == kReady &&
+                isOlder(slots[i], oldest)) {
+                oldest = &slots[i];
+            }
+        }
+        if (!oldest) {
+            return nullptr;
+        }
+        uint32_t expected = kReady;
+        if (oldest->state.compare_exchange_strong(expected, kReading, std::memory_order_acquire)) {
+            return oldest;
+        }
+        // The producer started overwriting it; look again
+    }
+}
+
+const FrameRing::Slot* FrameRing::acquire(int timeoutMs) {
+    Slot* slot = tryAcquire();
+    if (!slot && timeoutMs > 0) {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(waitMutex);
+        readyCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] {
+            slot = tryAcquire();
+            return slot != nullptr;
+        });
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (!slot) {
+        return nullptr;
+    }
+
+    int64_t ageNs = frameClockNs() - slot->meta.enqueueNs;
+    if (slot->meta.enqueueNs == 0 || ageNs < 0) {
+        ageNs = 0;
+    }
+    lastAgeNs.store(ageNs, std::memory_order_relaxed);
+    totalAgeNs.fetch_add(ageNs, std::memory_order_relaxed);
+    if (ageNs > maxAgeNs.load(std::memory_order_relaxed)) {
+        maxAgeNs.store(ageNs, std::memory_order_relaxed);
+    }
+    tail.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+void FrameRing::release(const Slot* slot) {
+    if (slot) {
+        const_cast<Slot*>(slot)->state.store(kFree, std::memory_order_release);
+    }
+}
+
+void FrameRing::reset() {
+    for (int i = 0; i < slotCount; i++) {
+        uint32_t expected = kReady;
+        slots[i].state.compare_exchange_strong(expected, kFree, std::memory_order_acq_rel);
+    }
+}
+
+FrameRing::Stats FrameRing::stats() const {
+    Stats s;
+    s.published = head.load(std::memory_order_relaxed);
+    s.consumed = tail.load(std::memory_order_relaxed);
+    s.overwritten = overwritten.load(std::memory_order_relaxed);
+    s.lastAgeMs = lastAgeNs.load(std::memory_order_relaxed) / 1e6;
+    s.maxAgeMs = maxAgeNs.load(std::memory_order_relaxed) / 1e6;
+    s.avgAgeMs = s.consumed ? totalAgeNs.load(std::memory_order_relaxed) / 1e6 / s.consumed : 0.0;
+    return s;
+}
+
+std::string FrameRing::statsJson() const {
+    Stats s = stats();
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"slots\":%d,\"published\":%llu,\"consumed\":%llu,\"overwritten\":%llu,"
+             "\"lastAgeMs\":%.2f,\"avgAgeMs\":%.2f,\"maxAgeMs\":%.2f}",
+             slotCount, (unsigned long long)s.published, (unsigned long long)s.consumed,
+             (unsigned long long)s.overwritten, s.lastAgeMs, s.avgAgeMs, s.maxAgeMs);
+    return buf;
+}
@@ -0,0 +1,92 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "frame_meta.h"
+#include "frame_view.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Single-producer/single-consumer ring of preallocated frame slots.
+//
+// The producer (camera callback) copies a frame into a free slot, or overwrites
+// the oldest unread frame when every slot is full. The consumer borrows the oldest
+// ready slot, processes it in place and releases it. Slot ownership moves through
+// an atomic state per slot, so neither side takes a lock or allocates on the fast
+// path; the consumer only sleeps on a condition variable when the ring is empty.
+class FrameRing {
+public:
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> state{0};
+        std::atomic<uint64_t> sequence{0};
+        int width = 0;
+        int height = 0;
+        FrameMeta meta;
+        // Y plane, followed by the planar U and V planes when hasChroma
+        uint8_t* data = nullptr;
+        bool hasChroma = false;
+        size_t capacity = 0;
+    };
+
+    struct Stats {
+        uint64_t published = 0;
+        uint64_t consumed = 0;
+        uint64_t overwritten = 0;
+        double lastAgeMs = 0.0;
+        double avgAgeMs = 0.0;
+        double maxAgeMs = 0.0;
+    };
+
+    FrameRing(int slotCount, size_t slotCapacity);
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Producer: copy a frame's luma, honoring row and pixel stride, into a contiguous
+    // slot, followed by its U/V planes as planar I420 for the YUV layouts. Returns the
+    // frame's sequence number (its Slot::sequence), or 0 on failure.
+    uint64_t push(const FrameView& frame, const FrameMeta& meta);
+
+    // The slot's frame in place: I420 when pushed with chroma, its Y plane otherwise
+    static FrameView viewOf(const Slot& slot);
+
+    // Consumer: borrow the oldest ready slot, waiting up to timeoutMs; nullptr on timeout
+    const Slot* acquire(int timeoutMs);
+    void release(const Slot* slot);
+
+    // Drop every unread frame (consumer side, e.g. when processing stops)
+    void reset();
+
+    Stats stats() const;
+    std::string statsJson() const;
+
+private:
+    enum : uint32_t { kFree = 0, kWriting = 1, kReady = 2, kReading = 3 };
+
+    Slot* tryAcquire();
+    bool ensureCapacity(Slot& slot, size_t bytes);
+
+    const int slotCount;
+    Slot* slots;
+
+    // Head: frames published by the producer; tail: frames consumed
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> overwritten{0};
+
+    // Slot age at consumption, written only by the consumer
+    std::atomic<int64_t> lastAgeNs{0};
+    std::atomic<int64_t> maxAgeNs{0};
+    std::atomic<int64_t> totalAgeNs{0};
+
+    // Slow path for an empty ring
+    std::atomic<int> waiters{0};
+    std::mutex waitMutex;
+    std::condition_variable readyCond;
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,205 @@
+#include "frame_scheduler.h"
+#include "edge_log.h"
+#include "frame_meta.h"
+#include <algorithm>
+#include <cstdio>
+
+#define LOG_TAG "FrameScheduler"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// Thumbnail scale used for change analysis
+static const int kThumbScale = 8;
+// Mean absolute thumbnail difference (0-255) above which a band counts as changed
+static const double kBandChangeThreshold = 3.0;
+// Partial processing only pays off while few bands changed
+static const int kMaxPartialBands = FrameScheduler::kBands / 2;
+// Refresh with a full frame at least this often so partial seams do not accumulate
+static const int kRefreshInterval = 30;
+// After this many drops in a row, process the cheapest way even if late
+static const int kMaxConsecutiveDrops = 3;
+static const double kCostSmoothing = 0.2;
+
+const char* frameDecisionName(FrameDecision decision) {
+    switch (decision) {
+        case FrameDecision::Full: return "full";
+        case FrameDecision::Pyramid: return "pyramid";
+        case FrameDecision::Partial: return "partial";
+        case FrameDecision::Reuse: return "reuse";
+        case FrameDecision::Drop: return "drop";
+        default: return "unknown";
+    }
+}
+
+cv::Range FrameScheduler::bandRows(int index, int rows) {
+    return cv::Range(rows * index / kBands, rows * (index + 1) / kBands);
+}
+
+FrameScheduler::Plan FrameScheduler::plan(const cv::Mat& gray, double ageMs, double budgetMs) {
+    Plan result;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (counters.budgetMs != budgetMs) {
+            LOGI("Frame budget %.1f ms", budgetMs);
+            counters.budgetMs = budgetMs;
+        }
+    }
+    // Params changed: neither the edge map nor its reference may be built on
+    bool stale = invalidated.exchange(false, std::memory_order_acq_rel);
+    if (stale) {
+        haveReference = false;
+    }
+    if (budgetMs <= 0.0) {
+        thumb.release();
+        haveReference = false;
+        recordDecision(FrameDecision::Full);
+        return result;
+    }
+
+    // Change analysis on a thumbnail against the input behind the current edge map
+    int64_t analysisStart = frameClockNs();
+    if (gray.size() != frameSize) {
+        frameSize = gray.size();
+        haveReference = false;
+    }
+    cv::resize(gray, thumb, cv::Size(std::max(1, gray.cols / kThumbScale), std::max(1, gray.rows / kThumbScale)),
+               0, 0, cv::INTER_AREA);
+    if (haveReference) {
+        cv::absdiff(thumb, reference, diff);
+        for (int b = 0; b < kBands; b++) {
+            cv::Range rows = bandRows(b, diff.rows);
+            if (rows.size() > 0 && cv::mean(diff.rowRange(rows))[0] > kBandChangeThreshold) {
+                result.changedBands |= 1u << b;
+                result.changedCount++;
+            }
+        }
+    }
+    double analysisMs = (frameClockNs() - analysisStart) / 1e6;
+
+    Stats s = stats();
+    double remaining = budgetMs - ageMs - analysisMs;
+    auto estimate = [&](FrameDecision d) {
+        return costKnown[static_cast<int>(d)] ? s.costMs[static_cast<int>(d)] : 0.0;
+    };
+    // Half resolution is roughly a quarter of the work until measured
+    double pyramidMs = costKnown[static_cast<int>(FrameDecision::Pyramid)]
+                           ? s.costMs[static_cast<int>(FrameDecision::Pyramid)]
+                           : estimate(FrameDecision::Full) / 4;
+    bool refreshDue = framesSinceFull >= kRefreshInterval;
+
+    if (stale) {
+        result.decision = FrameDecision::Full;
+    } else if (haveReference && result.changedCount == 0 && !refreshDue) {
+        result.decision = FrameDecision::Reuse;
+    } else if (estimate(FrameDecision::Full) <= remaining) {
+        result.decision = FrameDecision::Full;
+    } else if (haveReference && !refreshDue && result.changedCount <= kMaxPartialBands &&
+               bandCostMs * result.changedCount <= remaining) {
+        result.decision = FrameDecision::Partial;
+    } else if (pyramidMs <= remaining) {
+        result.decision = FrameDecision::Pyramid;
+    } else if (consecutiveDrops >= kMaxConsecutiveDrops) {
+        // Never starve the output: late is better than nothing at all
+        result.decision = haveReference && result.changedCount == 0 ? FrameDecision::Reuse : FrameDecision::Pyramid;
+    } else {
+        result.decision = FrameDecision::Drop;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        counters.analysisMs = counters.analysisMs == 0.0
+                                  ? analysisMs
+                                  : counters.analysisMs * (1 - kCostSmoothing) + analysisMs * kCostSmoothing;
+    }
+    recordDecision(result.decision);
+    consecutiveDrops = result.decision == FrameDecision::Drop ? consecutiveDrops + 1 : 0;
+    return result;
+}
+
+void FrameScheduler::recordDecision(FrameDecision decision) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    counters.decisions[static_cast<int>(decision)]++;
+}
+
+void FrameScheduler::complete(const Plan& plan, double costMs, double latencyMs) {
+    if (plan.decision == FrameDecision::Drop) {
+        return;
+    }
+
+    // The edge map now reflects the planned thumbnail (entirely, or in the recomputed bands)
+    if (!thumb.empty()) {
+        if (plan.decision == FrameDecision::Full || plan.decision == FrameDecision::Pyramid) {
+            thumb.copyTo(reference);
+            haveReference = true;
+            framesSinceFull = 0;
+        } else if (plan.decision == FrameDecision::Partial) {
+            for (int b = 0; b < kBands; b++) {
+                if (plan.changedBands & (1u << b)) {
+                    cv::Range rows = bandRows(b, thumb.rows);
+                    thumb.rowRange(rows).copyTo(reference.rowRange(rows));
+                }
+            }
+        }
+    }
+    if (plan.decision != FrameDecision::Full) {
+        framesSinceFull++;
+    }
+
+    int64_t now = frameClockNs();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    int index = static_cast<int>(plan.decision);
+    double& cost = counters.costMs[index];
+    cost = costKnown[index] ? cost * (1 - kCostSmoothing) + costMs * kCostSmoothing : costMs;
+    costKnown[index] = true;
+    if (plan.decision == FrameDecision::Partial && plan.changedCount > 0) {
+        double perBand = costMs / plan.changedCount;
+        bandCostMs = bandCostMs == 0.0 ? perBand : bandCostMs * (1 - kCostSmoothing) + perBand * kCostSmoothing;
+    } else if (plan.decision == FrameDecision::Full && bandCostMs == 0.0) {
+        bandCostMs = costMs / kBands;
+    }
+
+    if (counters.budgetMs <= 0.0 || latencyMs <= counters.budgetMs) {
+        counters.hits++;
+    }
+    if (lastDeliveryNs != 0) {
+        double fps = 1e9 / std::max<int64_t>(1, now - lastDeliveryNs);
+        counters.deliveredFps = counters.deliveredFps == 0.0 ? fps : counters.deliveredFps * 0.9 + fps * 0.1;
+    }
+    lastDeliveryNs = now;
+}
+
+FrameScheduler::Stats FrameScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    Stats s = counters;
+    uint64_t offered = 0;
+    for (uint64_t count : s.decisions) {
+        offered += count;
+    }
+    // Dropped frames count as misses
+    s.hitRate = offered ? static_cast<double>(s.hits) / offered : 0.0;
+    return s;
+}
+
+std::string FrameScheduler::statsJson() const {
+    Stats s = stats();
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"budgetMs\":%.1f,\"hitRate\":%.3f,\"deliveredFps\":%.1f,\"analysisMs\":%.2f",
+             s.budgetMs, s.hitRate, s.deliveredFps, s.analysisMs);
+    std::string json(buf);
+    json += ",\"decisions\":{";
+    for (int i = 0; i < static_cast<int>(FrameDecision::Count); i++) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":%llu", i ? "," : "", frameDecisionName(static_cast<FrameDecision>(i)),
+                 (unsigned long long)s.decisions[i]);
+        json += buf;
+    }
+    json += "},\"costMs\":{";
+    bool first = true;
+    for (int i = 0; i < static_cast<int>(FrameDecision::Drop); i++) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":%.2f", first ? "" : ",", frameDecisionName(static_cast<FrameDecision>(i)),
+                 s.costMs[i]);
+        json += buf;
+        first = false;
+    }
+    json += "}}";
+    return json;
+}
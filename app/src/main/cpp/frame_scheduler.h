@@ -0,0 +1,85 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// How a frame is processed under a latency budget, from most to least expensive
+enum class FrameDecision {
+    Full = 0,     // blur + Canny at full resolution
+    Pyramid,      // detect at half resolution and upscale the edge map
+    Partial,      // recompute only row bands that changed since the current edge map
+    Reuse,        // nothing changed: republish the current edge map
+    Drop,         // cannot finish in time: skip so the next frame starts sooner
+    Count
+};
+
+const char* frameDecisionName(FrameDecision decision);
+
+// Per-stream deadline-aware scheduler.
+//
+// Tracks what each processing mode recently cost and how much of the frame
+// changed, then picks per frame the best mode that still fits in the budget
+// (measured from capture). With no budget every frame is processed in full.
+// Not thread-safe for planning: call plan()/complete() from the stream's
+// processing thread; stats() may be called from anywhere.
+class FrameScheduler {
+public:
+    static const int kBands = 16;
+
+    struct Plan {
+        FrameDecision decision = FrameDecision::Full;
+        // Bit i set: band i changed (Partial only)
+        uint32_t changedBands = 0;
+        int changedCount = 0;
+    };
+
+    struct Stats {
+        double budgetMs = 0.0;
+        uint64_t decisions[static_cast<int>(FrameDecision::Count)] = {};
+        uint64_t hits = 0;
+        double hitRate = 0.0;
+        double deliveredFps = 0.0;
+        double costMs[static_cast<int>(FrameDecision::Count)] = {};
+        double analysisMs = 0.0;
+    };
+
+    // Choose how to process `gray`, captured `ageMs` ago, within `budgetMs` (<= 0: no deadline)
+    Plan plan(const cv::Mat& gray, double ageMs, double budgetMs);
+    // Report the cost of the chosen mode and the capture-to-output latency of the frame
+    void complete(const Plan& plan, double costMs, double latencyMs);
+
+    // Row range of band `index` for a frame `rows` tall
+    static cv::Range bandRows(int index, int rows);
+
+    // The current edge map no longer matches the detection settings: the next plan()
+    // is Full and drops the reference. Safe to call from any thread.
+    void invalidate() { invalidated.store(true, std::memory_order_release); }
+
+    Stats stats() const;
+    std::string statsJson() const;
+
+private:
+    void recordDecision(FrameDecision decision);
+
+    // 1/8-scale thumbnails: the frame being planned and the input behind the current edge map
+    cv::Mat thumb;
+    cv::Mat reference;
+    cv::Mat diff;
+    cv::Size frameSize;
+    bool haveReference = false;
+    int framesSinceFull = 0;
+    int consecutiveDrops = 0;
+    std::atomic<bool> invalidated{false};
+
+    mutable std::mutex statsMutex;
+    Stats counters;
+    bool costKnown[static_cast<int>(FrameDecision::Count)] = {};
+    double bandCostMs = 0.0;
+    int64_t lastDeliveryNs = 0;
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,133 @@
+#include "frame_view.h"
+#include <opencv2/imgproc.hpp>
+
+static bool isYuv(PixelLayout layout) {
+    return layout != PixelLayout::Gray && layout != PixelLayout::Rgba && layout != PixelLayout::Bgr;
+}
+
+static bool planeValid(const PlaneView& plane, int width, int height) {
+    return plane.data && plane.pixelStride > 0 && width > 0 && height > 0 &&
+           plane.rowStride >= (width - 1) * plane.pixelStride + 1;
+}
+
+FrameView FrameView::gray(const uint8_t* y, int width, int height, int rowStride, int pixelStride) {
+    FrameView frame;
+    frame.layout = PixelLayout::Gray;
+    frame.width = width;
+    frame.height = height;
+    frame.planes[0] = {y, rowStride, pixelStride};
+    return frame;
+}
+
+FrameView FrameView::yuv420(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height,
+                            int yRowStride, int yPixelStride, int uvRowStride, int uvPixelStride) {
+    FrameView frame = gray(y, width, height, yRowStride, yPixelStride);
+    frame.layout = PixelLayout::Yuv420;
+    frame.planes[1] = {u, uvRowStride, uvPixelStride};
+    frame.planes[2] = {v, uvRowStride, uvPixelStride};
+    return frame;
+}
+
+FrameView FrameView::nv12(const uint8_t* y, const uint8_t* uv, int width, int height, int yRowStride,
+                          int uvRowStride) {
+    FrameView frame = yuv420(y, uv, uv ? uv + 1 : nullptr, width, height, yRowStride, 1, uvRowStride, 2);
+    frame.layout = PixelLayout::Nv12;
+    return frame;
+}
+
+FrameView FrameView::nv21(const uint8_t* y, const uint8_t* vu, int width, int height, int yRowStride,
+                          int uvRowStride) {
+    FrameView frame = yuv420(y, vu ? vu + 1 : nullptr, vu, width, height, yRowStride, 1, uvRowStride, 2);
+    frame.layout = PixelLayout::Nv21;
+    return frame;
+}
+
+FrameView FrameView::i420(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height,
+                          int yRowStride, int uvRowStride) {
+    FrameView frame = yuv420(y, u, v, width, height, yRowStride, 1, uvRowStride, 1);
+    frame.layout = PixelLayout::I420;
+    return frame;
+}
+
+FrameView FrameView::rgba(const uint8_t* data, int width, int height, int rowStride) {
+    FrameView frame = gray(data, width, height, rowStride, 4);
+    frame.layout = PixelLayout::Rgba;
+    return frame;
+}
+
+FrameView FrameView::bgr(const uint8_t* data, int width, int height, int rowStride) {
+    FrameView frame = gray(data, width, height, rowStride, 3);
+    frame.layout = PixelLayout::Bgr;
+    return frame;
+}
+
+size_t FrameView::planeSpan(int width, int height, int rowStride, int pixelStride) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    return static_cast<size_t>(height - 1) * rowStride + static_cast<size_t>(width - 1) * pixelStride + 1;
+}
+
+bool FrameView::valid() const {
+    // Packed pixels must span the whole last pixel, not just its first byte
+    int packedWidth = layout == PixelLayout::Rgba ? 4 * width : (layout == PixelLayout::Bgr ? 3 * width : width);
+    int packedStride = layout == PixelLayout::Rgba || layout == PixelLayout::Bgr ? 1 : planes[0].pixelStride;
+    PlaneView first = {planes[0].data, planes[0].rowStride, packedStride};
+    if (!planeValid(first, packedWidth, height)) {
+        return false;
+    }
+    return !isYuv(layout) || chroma().valid();
+}
+
+bool FrameView::directLuma() const {
+    return (layout == PixelLayout::Gray || isYuv(layout)) && planes[0].pixelStride == 1;
+}
+
+cv::Mat FrameView::luma(cv::Mat& scratch) const {
+    uint8_t* data = const_cast<uint8_t*>(planes[0].data);
+    switch (layout) {
+        case PixelLayout::Rgba:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC4, data, planes[0].rowStride), scratch, cv::COLOR_RGBA2GRAY);
+            return scratch;
+        case PixelLayout::Bgr:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC3, data, planes[0].rowStride), scratch, cv::COLOR_BGR2GRAY);
+            return scratch;
+        default:
+            break;
+    }
+    if (directLuma()) {
+        // Filters take any row stride, so the plane is read where it lies
+        return cv::Mat(height, width, CV_8UC1, data, planes[0].rowStride);
+    }
+    // Samples with gaps between them (e.g. a Y plane inside packed YUYV) are gathered once
+    scratch.create(height, width, CV_8UC1);
+    const int stride = planes[0].pixelStride;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = planes[0].data + static_cast<size_t>(y) * planes[0].rowStride;
+        uint8_t* dst = scratch.ptr<uint8_t>(y);
+        for (int x = 0; x < width; x++) {
+            dst[x] = src[x * stride];
+        }
+    }
+    return scratch;
+}
+
+ChromaPlanes FrameView::chroma() const {
+    ChromaPlanes c;
+    if (isYuv(layout)) {
+        c.u = planes[1].data;
+        c.v = planes[2].data;
+        c.width = (width + 1) / 2;
+        c.height = (height + 1) / 2;
+        c.rowStride = planes[1].rowStride;
+        c.pixelStride = planes[1].pixelStride;
+    }
+    return c;
+}
+
+FrameView FrameView::withoutChroma() const {
+    if (!isYuv(layout)) {
+        return *this;
+    }
+    return gray(planes[0].data, width, height, planes[0].rowStride, planes[0].pixelStride);
+}
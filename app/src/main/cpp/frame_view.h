@@ -0,0 +1,66 @@
+#ifndef FRAME_VIEW_H
+#define FRAME_VIEW_H
+
+#include "chroma_gradient.h"
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Layouts a frame can arrive in
+enum class PixelLayout {
+    Gray,    // a luma plane alone
+    Yuv420,  // Android YUV_420_888: three planes, any row / pixel stride
+    Nv12,    // Y plane + interleaved U/V plane
+    Nv21,    // Y plane + interleaved V/U plane
+    I420,    // three planar Y, U, V planes
+    Rgba,
+    Bgr,
+};
+
+// One plane of a caller-owned frame, `pixelStride` bytes between samples
+struct PlaneView {
+    const uint8_t* data = nullptr;
+    int rowStride = 0;
+    int pixelStride = 1;
+};
+
+// Zero-copy description of a caller-owned frame. The semi-planar and planar YUV
+// layouts all reduce to three strided planes, so NV12 / NV21 / I420 are just
+// YUV_420_888 with fixed strides. Nothing is copied until a stage needs a layout
+// it cannot read in place.
+struct FrameView {
+    PixelLayout layout = PixelLayout::Gray;
+    int width = 0;
+    int height = 0;
+    // Y, U, V for the YUV layouts; the packed pixels in planes[0] for RGBA / BGR
+    PlaneView planes[3];
+
+    static FrameView gray(const uint8_t* y, int width, int height, int rowStride, int pixelStride = 1);
+    // U and V share their strides, as YUV_420_888 guarantees
+    static FrameView yuv420(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height,
+                            int yRowStride, int yPixelStride, int uvRowStride, int uvPixelStride);
+    static FrameView nv12(const uint8_t* y, const uint8_t* uv, int width, int height, int yRowStride,
+                          int uvRowStride);
+    static FrameView nv21(const uint8_t* y, const uint8_t* vu, int width, int height, int yRowStride,
+                          int uvRowStride);
+    static FrameView i420(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height,
+                          int yRowStride, int uvRowStride);
+    static FrameView rgba(const uint8_t* data, int width, int height, int rowStride);
+    static FrameView bgr(const uint8_t* data, int width, int height, int rowStride);
+
+    // Bytes a strided plane spans; its last row is usually not padded to rowStride
+    static size_t planeSpan(int width, int height, int rowStride, int pixelStride);
+
+    bool valid() const;
+    // Whether luma() is a view of the frame, i.e. the blur reads it without a staging copy
+    bool directLuma() const;
+    // Luma as CV_8UC1: a strided view when directLuma(), otherwise gathered or
+    // converted into `scratch` (reallocated only when the resolution changes)
+    cv::Mat luma(cv::Mat& scratch) const;
+    // U/V planes of the YUV layouts, read in place; invalid for the others
+    ChromaPlanes chroma() const;
+    // The same frame without its U/V planes (the Y plane alone for the YUV layouts)
+    FrameView withoutChroma() const;
+};
+
+#endif // FRAME_VIEW_H
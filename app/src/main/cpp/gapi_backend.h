@@ -0,0 +1,50 @@
+#ifndef GAPI_BACKEND_H
+#define GAPI_BACKEND_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <memory>
+
+struct StreamParams;
+
+// Blur -> Canny (with optional downscale) expressed as a G-API graph.
+//
+// The graph is compiled once per input resolution and parameter set with the
+// Fluid kernel packages, so blur and resize run line-by-line in small cached
+// buffers instead of full-frame intermediates; Canny has no Fluid kernel and
+// runs on the OpenCV backend. G-API types stay out of this header.
+class GapiEdgeGraph {
+public:
+    struct Config {
+        // Detect at 1/downscale resolution (1: full resolution)
+        int downscale = 1;
+    };
+
+    // False when the linked OpenCV was built without G-API
+    static bool available();
+
+    GapiEdgeGraph();
+    explicit GapiEdgeGraph(const Config& config);
+    ~GapiEdgeGraph();
+
+    GapiEdgeGraph(const GapiEdgeGraph&) = delete;
+    GapiEdgeGraph& operator=(const GapiEdgeGraph&) = delete;
+
+    // Run the graph on `gray`, recompiling only when its size or `params` changed.
+    // `edges` receives the edge map at the (possibly downscaled) graph resolution.
+    void apply(const cv::Mat& gray, cv::Mat& edges, const StreamParams& params);
+
+    const Config& config() const { return cfg; }
+    uint64_t compilations() const { return compileCount; }
+    double lastCompileMs() const { return compileMs; }
+
+private:
+    struct Impl;
+
+    const Config cfg;
+    std::unique_ptr<Impl> impl;
+    uint64_t compileCount = 0;
+    double compileMs = 0.0;
+};
+
+#endif // GAPI_BACKEND_H
@@ -0,0 +1,240 @@
+#include "gapi_streaming.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef HAVE_OPENCV_GAPI
+#include <opencv2/gapi.hpp>
+#include <opencv2/gapi/core.hpp>
+#include <opencv2/gapi/fluid/core.hpp>
+#include <opencv2/gapi/fluid/imgproc.hpp>
+#include <opencv2/gapi/gstreaming.hpp>
+#include <opencv2/gapi/imgproc.hpp>
+#include <opencv2/gapi/streaming/desync.hpp>
+#include <opencv2/gapi/streaming/format.hpp>
+#include <opencv2/gapi/streaming/queue_source.hpp>
+#endif
+
+#define LOG_TAG "GapiStreaming"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+#ifdef HAVE_OPENCV_GAPI
+
+struct GapiStreamingPipeline::Impl {
+    cv::GStreamingCompiled compiled;
+    std::shared_ptr<cv::gapi::wip::QueueSource<cv::Mat>> source;
+    cv::Size size;
+    StreamParams params;
+    bool valid = false;
+
+    bool matches(const cv::Size& s, const StreamParams& p) const {
+        return valid && s == size && p.blurSize == params.blurSize && p.blurSigma == params.blurSigma &&
+               p.lowThreshold == params.lowThreshold && p.highThreshold == params.highThreshold &&
+               p.cannyAperture == params.cannyAperture && p.cannyL2 == params.cannyL2;
+    }
+};
+
+bool GapiStreamingPipeline::available() {
+    return true;
+}
+
+bool GapiStreamingPipeline::push(const cv::Mat& gray, uint64_t tag, const FrameMeta& meta,
+                                 const StreamParams& p) {
+    CV_Assert(gray.type() == CV_8UC1);
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    try {
+        if (!impl->matches(gray.size(), p) || !running()) {
+            stopLocked();
+            int64_t start = frameClockNs();
+            cv::GMat in;
+            cv::GMat blurred = cv::gapi::gaussianBlur(in, cv::Size(p.blurSize, p.blurSize), p.blurSigma);
+            cv::GMat edges = cv::gapi::Canny(blurred, p.lowThreshold, p.highThreshold, p.cannyAperture, p.cannyL2);
+            // Encode branch: takes the newest edge map whenever the previous one was pulled
+            cv::GMat encode = cv::gapi::copy(cv::gapi::streaming::desync(edges));
+            cv::GComputation graph(cv::GIn(in), cv::GOut(edges, encode));
+
+            auto kernels = cv::gapi::combine(cv::gapi::imgproc::fluid::kernels(), cv::gapi::core::fluid::kernels(),
+                                             cv::gapi::streaming::kernels());
+            impl->compiled = graph.compileStreaming(
+                cv::GMetaArgs{cv::GMetaArg(cv::descr_of(gray))},
+                cv::compile_args(kernels, cv::gapi::streaming::queue_capacity(cfg.queueCapacity)));
+            impl->source = std::make_shared<cv::gapi::wip::QueueSource<cv::Mat>>(cv::descr_of(gray));
+            impl->compiled.setSource(impl->source);
+            impl->size = gray.size();
+            impl->params = p;
+            impl->valid = true;
+            impl->compiled.start();
+            lastCompileNs.store(frameClockNs() - start, std::memory_order_relaxed);
+            compilations.fetch_add(1, std::memory_order_relaxed);
+
+            isRunning.store(true, std::memory_order_release);
+            pullThread = std::thread(&GapiStreamingPipeline::pullLoop, this);
+            LOGI("Started %dx%d streaming graph in %.1f ms", gray.cols, gray.rows,
+                 lastCompileNs.load(std::memory_order_relaxed) / 1e6);
+        }
+
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            if (static_cast<int>(pending.size()) >= cfg.maxInFlight) {
+                rejected.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            pending.push_back(Pending{tag, meta, frameClockNs()});
+        }
+        // The source keeps a reference, so the caller's buffer must not be wrapped
+        impl->source->push(gray.clone());
+        pushed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    } catch (const cv::Exception& e) {
+        LOGE("Streaming push failed: %s", e.what());
+        impl->valid = false;
+        return false;
+    }
+}
+
+void GapiStreamingPipeline::stopLocked() {
+    // The pull thread may already have ended on its own (see pullLoop); it is joined either way
+    bool wasRunning = isRunning.exchange(false, std::memory_order_acq_rel);
+    if (!wasRunning && !pullThread.joinable()) {
+        return;
+    }
+    try {
+        // Ends the stream: the pull thread's pull() returns false
+        impl->compiled.stop();
+    } catch (const cv::Exception& e) {
+        LOGE("Streaming stop failed: %s", e.what());
+    }
+    if (pullThread.joinable()) {
+        pullThread.join();
+    }
+    std::lock_guard<std::mutex> pendingLock(pendingMutex);
+    discarded.fetch_add(pending.size(), std::memory_order_relaxed);
+    pending.clear();
+}
+
+void GapiStreamingPipeline::pullLoop() {
+    ThreadPlacement::Scope placement(ThreadRole::Latency);
+    if (threadStart) {
+        threadStart();
+    }
+    cv::optional<cv::Mat> edges;
+    cv::optional<cv::Mat> encode;
+    FrameMeta newest;
+    bool haveNewest = false;
+    try {
+        while (impl->compiled.pull(cv::gout(edges, encode))) {
+            Pending frame;
+            bool matched = false;
+            if (edges.has_value()) {
+                std::lock_guard<std::mutex> pendingLock(pendingMutex);
+                if (!pending.empty()) {
+                    frame = pending.front();
+                    pending.pop_front();
+                    matched = true;
+                }
+            }
+            if (matched) {
+                int64_t now = frameClockNs();
+                frame.meta.processStartNs = frame.pushNs;
+                frame.meta.processEndNs = now;
+                totalLatencyNs.fetch_add(now - frame.pushNs, std::memory_order_relaxed);
+                completed.fetch_add(1, std::memory_order_relaxed);
+                if (frameCallback) {
+                    frameCallback(frame.tag, edges.value(), frame.meta);
+                }
+                newest = frame.meta;
+                haveNewest = true;
+            }
+            if (encode.has_value() && haveNewest) {
+                encodeFrames.fetch_add(1, std::memory_order_relaxed);
+                if (encodeCallback) {
+                    encodeCallback(encode.value(), newest);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        LOGE("Streaming pull failed: %s", e.what());
+    }
+    // Not stopped by stopLocked: the graph failed or ended by itself. Marking it stopped
+    // makes the next push() recompile and restart it instead of queueing into a dead graph.
+    if (isRunning.exchange(false, std::memory_order_acq_rel)) {
+        LOGE("Streaming graph ended unexpectedly; restarting on the next frame");
+    }
+    if (threadExit) {
+        threadExit();
+    }
+}
+
+#else
+
+struct GapiStreamingPipeline::Impl {};
+
+bool GapiStreamingPipeline::available() {
+    return false;
+}
+
+bool GapiStreamingPipeline::push(const cv::Mat&, uint64_t, const FrameMeta&, const StreamParams&) {
+    CV_Error(cv::Error::StsNotImplemented, "OpenCV was built without G-API");
+}
+
+void GapiStreamingPipeline::stopLocked() {}
+
+void GapiStreamingPipeline::pullLoop() {}
+
+#endif
+
+GapiStreamingPipeline::GapiStreamingPipeline() : GapiStreamingPipeline(Config()) {}
+
+GapiStreamingPipeline::GapiStreamingPipeline(const Config& config) : cfg(config), impl(new Impl()) {}
+
+GapiStreamingPipeline::~GapiStreamingPipeline() {
+    stop();
+}
+
+void GapiStreamingPipeline::setCallbacks(FrameCallback onFrame, EncodeCallback onEncode,
+                                         ThreadHook onThreadStart, ThreadHook onThreadExit) {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    // The pull thread reads these without locking
+    stopLocked();
+    frameCallback = std::move(onFrame);
+    encodeCallback = std::move(onEncode);
+    threadStart = std::move(onThreadStart);
+    threadExit = std::move(onThreadExit);
+}
+
+void GapiStreamingPipeline::stop() {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    stopLocked();
+}
+
+GapiStreamingPipeline::Stats GapiStreamingPipeline::stats() const {
+    Stats s;
+    s.pushed = pushed.load(std::memory_order_relaxed);
+    s.completed = completed.load(std::memory_order_relaxed);
+    s.rejected = rejected.load(std::memory_order_relaxed);
+    s.discarded = discarded.load(std::memory_order_relaxed);
+    s.encodeFrames = encodeFrames.load(std::memory_order_relaxed);
+    s.compilations = compilations.load(std::memory_order_relaxed);
+    s.lastCompileMs = lastCompileNs.load(std::memory_order_relaxed) / 1e6;
+    if (s.completed) {
+        s.avgLatencyMs = totalLatencyNs.load(std::memory_order_relaxed) / 1e6 / s.completed;
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    s.inFlight = static_cast<int>(pending.size());
+    return s;
+}
+
+std::string GapiStreamingPipeline::statsJson() const {
+    Stats s = stats();
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "{\"running\":%s,\"pushed\":%llu,\"completed\":%llu,\"rejected\":%llu,\"discarded\":%llu,"
+             "\"encodeFrames\":%llu,\"inFlight\":%d,\"compilations\":%llu,\"lastCompileMs\":%.1f,"
+             "\"avgLatencyMs\":%.2f}",
+             running() ? "true" : "false", (unsigned long long)s.pushed, (unsigned long long)s.completed,
+             (unsigned long long)s.rejected, (unsigned long long)s.discarded, (unsigned long long)s.encodeFrames,
+             s.inFlight, (unsigned long long)s.compilations, s.lastCompileMs, s.avgLatencyMs);
+    return buf;
+}
@@ -0,0 +1,120 @@
+#ifndef GAPI_STREAMING_H
+#define GAPI_STREAMING_H
+
+#include "frame_meta.h"
+#include "stream_registry.h"
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Blur -> Canny as a pipelined G-API streaming graph (GStreamingCompiled).
+//
+// Frames are pushed into a queue source and the graph's islands run on G-API's
+// own threads, so blur of frame N+1 overlaps Canny of frame N. A pull thread
+// delivers results in push order. The edge map also feeds a desynchronized
+// branch for encoding: it only yields the newest frame whenever it is free, so
+// a slow encode consumer never holds back detection. G-API types stay out of
+// this header.
+class GapiStreamingPipeline {
+public:
+    struct Config {
+        // Capacity of the queues between islands
+        int queueCapacity = 2;
+        // Frames pushed but not yet pulled; push() rejects beyond this
+        int maxInFlight = 3;
+    };
+
+    // Called on the pull thread for every finished frame, in push order.
+    // `edges` is valid for the duration of the call.
+    using FrameCallback = std::function<void(uint64_t tag, const cv::Mat& edges, FrameMeta& meta)>;
+    // Called on the pull thread when the desynchronized encode branch yields a frame;
+    // `meta` belongs to the newest finished frame
+    using EncodeCallback = std::function<void(const cv::Mat& edges, const FrameMeta& meta)>;
+    using ThreadHook = std::function<void()>;
+
+    struct Stats {
+        uint64_t pushed = 0;
+        uint64_t completed = 0;
+        // Rejected because maxInFlight frames were queued
+        uint64_t rejected = 0;
+        // In flight when the pipeline was stopped or restarted
+        uint64_t discarded = 0;
+        uint64_t encodeFrames = 0;
+        uint64_t compilations = 0;
+        double lastCompileMs = 0.0;
+        // Push to pull
+        double avgLatencyMs = 0.0;
+        int inFlight = 0;
+    };
+
+    // False when the linked OpenCV was built without G-API
+    static bool available();
+
+    GapiStreamingPipeline();
+    explicit GapiStreamingPipeline(const Config& config);
+    ~GapiStreamingPipeline();
+
+    GapiStreamingPipeline(const GapiStreamingPipeline&) = delete;
+    GapiStreamingPipeline& operator=(const GapiStreamingPipeline&) = delete;
+
+    // Callbacks and pull thread hooks; stops a running graph, the next push restarts it
+    void setCallbacks(FrameCallback onFrame, EncodeCallback onEncode,
+                      ThreadHook onThreadStart = nullptr, ThreadHook onThreadExit = nullptr);
+
+    // Copy `gray` into the pipeline. The graph is compiled and started on first use and
+    // restarted when the size or `params` change (frames in flight are discarded).
+    // Returns false if the frame was rejected.
+    bool push(const cv::Mat& gray, uint64_t tag, const FrameMeta& meta, const StreamParams& params);
+
+    // Stop the graph and join the pull thread; frames in flight are discarded.
+    // A graph that fails or ends on its own is marked stopped and restarts on the next push.
+    void stop();
+    bool running() const { return isRunning.load(std::memory_order_acquire); }
+
+    Stats stats() const;
+    std::string statsJson() const;
+
+private:
+    struct Impl;
+    struct Pending {
+        uint64_t tag = 0;
+        FrameMeta meta;
+        int64_t pushNs = 0;
+    };
+
+    void stopLocked();
+    void pullLoop();
+
+    const Config cfg;
+    std::unique_ptr<Impl> impl;
+
+    // Serializes push/stop against each other
+    std::mutex lifecycleMutex;
+    std::thread pullThread;
+    std::atomic<bool> isRunning{false};
+    FrameCallback frameCallback;
+    EncodeCallback encodeCallback;
+    ThreadHook threadStart;
+    ThreadHook threadExit;
+
+    // Frames pushed and not yet pulled, oldest first
+    mutable std::mutex pendingMutex;
+    std::deque<Pending> pending;
+
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> discarded{0};
+    std::atomic<uint64_t> encodeFrames{0};
+    std::atomic<uint64_t> compilations{0};
+    std::atomic<int64_t> lastCompileNs{0};
+    std::atomic<int64_t> totalLatencyNs{0};
+};
+
+#endif // GAPI_STREAMING_H
@@ -1,8 +1,15 @@
 #include <jni.h>
+#include <algorithm>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <android/log.h>
 #include <android/bitmap.h>
 #include "edge_processor.h"
+#include "buffer_pool.h"
+#include "cpu_topology.h"
+#include "gapi_backend.h"
+#include "stream_registry.h"
 
 #define LOG_TAG "EdgeDetection"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -67,7 +74,9 @@ Java_com_edgedetection_MainActivity_00024Companion_processFrameAndReturn(
         jint width,
         jint height,
         jint rowStride,
-        jint pixelStride) {
+        jint pixelStride,
+        jlong sensorTimestampNs,
+        jlong enqueueTimeNs) {
     
     // Get the frame data from Java byte array
     jbyte* frameBytes = env->GetByteArrayElements(frameData, nullptr);
@@ -76,13 +85,19 @@ Java_com_edgedetection_MainActivity_00024Companion_processFrameAndReturn(
         return nullptr;
     }
     
+    // Capture and enqueue times travel with the frame through processing and encoding
+    FrameMeta meta;
+    meta.sensorTimestampNs = sensorTimestampNs;
+    meta.enqueueNs = enqueueTimeNs;
+    
     // Process the frame data with EdgeProcessor and get result
     uint8_t* processedData = EdgeProcessor::processFrameDataAndReturn(
         reinterpret_cast<uint8_t*>(frameBytes),
         width,
         height,
         rowStride,
-        pixelStride
+        pixelStride,
+        &meta
     );
     
     // Release the input frame data
@@ -98,18 +113,264 @@ Java_com_edgedetection_MainActivity_00024Companion_processFrameAndReturn(
     jbyteArray result = env->NewByteArray(resultSize);
     if (!result) {
         LOGE("Failed to create result byte array");
-        delete[] processedData;
+        EdgeProcessor::releaseFrameData(processedData, width, height);
         return nullptr;
     }
     
     env->SetByteArrayRegion(result, 0, resultSize, reinterpret_cast<jbyte*>(processedData));
     
-    // Free native processed buffer to avoid memory leak
-    delete[] processedData;
+    // Return the native processed buffer to the pool
+    EdgeProcessor::releaseFrameData(processedData, width, height);
     
     return result;
 }
 
+// Camera callback: copy the Y plane straight from the image's direct buffer into the frame ring
+// and return its ticket (0 if rejected). Never waits for processing; the ring overwrites the
+// oldest unprocessed frame when the completion thread falls behind.
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_submitFrame(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject yBuffer,
+        jint width,
+        jint height,
+        jint rowStride,
+        jint pixelStride,
+        jlong sensorTimestampNs,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint uvRowStride,
+        jint uvPixelStride) {
+    auto* data = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    jlong capacity = env->GetDirectBufferCapacity(yBuffer);
+    if (!data || width <= 0 || height <= 0 || pixelStride <= 0) {
+        LOGE("submitFrame: buffer is not direct or frame is empty");
+        return 0;
+    }
+    // The last row of a plane is usually not padded to rowStride
+    jlong needed = static_cast<jlong>(FrameView::planeSpan(width, height, rowStride, pixelStride));
+    if (capacity < needed) {
+        LOGE("submitFrame: buffer too small (%lld < %lld)", (long long)capacity, (long long)needed);
+        return 0;
+    }
+    // The caller passes U/V only while colorEdges is on; they are used when direct and large enough
+    FrameView frame = FrameView::gray(data, width, height, rowStride, pixelStride);
+    const uint8_t* u = uBuffer ? static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer)) : nullptr;
+    const uint8_t* v = vBuffer ? static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer)) : nullptr;
+    if (u && v) {
+        FrameView yuv = FrameView::yuv420(data, u, v, width, height, rowStride, pixelStride, uvRowStride,
+                                          uvPixelStride);
+        jlong uvNeeded = static_cast<jlong>(
+                FrameView::planeSpan((width + 1) / 2, (height + 1) / 2, uvRowStride, uvPixelStride));
+        if (yuv.valid() && env->GetDirectBufferCapacity(uBuffer) >= uvNeeded &&
+            env->GetDirectBufferCapacity(vBuffer) >= uvNeeded) {
+            frame = yuv;
+        } else {
+            LOGE("submitFrame: unusable U/V planes, submitting luma only");
+        }
+    }
+    return static_cast<jlong>(EdgeProcessor::asyncProcessor().submit(frame, sensorTimestampNs));
+}
+
+// Completion listener state; the completion thread attaches to the VM once for its lifetime
+static JavaVM* javaVm = nullptr;
+static jobject completionListener = nullptr;
+static jmethodID onFrameProcessedMethod = nullptr;
+static thread_local JNIEnv* completionEnv = nullptr;
+
+// Edge arrays Java has handed back (releaseProcessedFrame), as global refs. A delivered
+// array belongs to Java until it is returned, so a renderer holding one frame keeps
+// the steady state at zero allocations.
+static const size_t kMaxFreeEdgeArrays = 4;
+static std::mutex edgeArraysMutex;
+static std::vector<jbyteArray> freeEdgeArrays;
+
+// A returned array of `size` bytes (a global ref, `pooled` set) or a new local one;
+// returned arrays of another size are dropped
+static jbyteArray acquireEdgeArray(JNIEnv* env, jsize size, bool& pooled) {
+    std::vector<jbyteArray> stale;
+    jbyteArray array = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(edgeArraysMutex);
+        while (!freeEdgeArrays.empty() && !array) {
+            jbyteArray candidate = freeEdgeArrays.back();
+            freeEdgeArrays.pop_back();
+            if (env->GetArrayLength(candidate) == size) {
+                array = candidate;
+            } else {
+                stale.push_back(candidate);
+            }
+        }
+    }
+    for (jbyteArray candidate : stale) {
+        env->DeleteGlobalRef(candidate);
+    }
+    pooled = array != nullptr;
+    return pooled ? array : env->NewByteArray(size);
+}
+
+static void clearEdgeArrays(JNIEnv* env) {
+    std::lock_guard<std::mutex> lock(edgeArraysMutex);
+    for (jbyteArray array : freeEdgeArrays) {
+        env->DeleteGlobalRef(array);
+    }
+    freeEdgeArrays.clear();
+}
+
+static void deliverCompletion(const FrameCompletion& completion) {
+    JNIEnv* env = completionEnv;
+    if (!env || !completionListener) {
+        return;
+    }
+    jsize size = completion.width * completion.height;
+    bool pooled = false;
+    jbyteArray edges = acquireEdgeArray(env, size, pooled);
+    if (!edges) {
+        LOGE("Failed to create result byte array");
+        env->ExceptionClear();
+        return;
+    }
+    for (int y = 0; y < completion.height; y++) {
+        env->SetByteArrayRegion(edges, y * completion.width, completion.width,
+                                reinterpret_cast<const jbyte*>(completion.edges + static_cast<size_t>(y) * completion.rowStride));
+    }
+    env->CallVoidMethod(completionListener, onFrameProcessedMethod, static_cast<jlong>(completion.ticket), edges,
+                        completion.width, completion.height);
+    if (env->ExceptionCheck()) {
+        LOGE("onFrameProcessed threw");
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    // Java owns the array now and hands it back through releaseProcessedFrame
+    if (pooled) {
+        env->DeleteGlobalRef(edges);
+    } else {
+        env->DeleteLocalRef(edges);
+    }
+}
+
+// Start the native completion thread; listener.onFrameProcessed(ticket, edges, width, height)
+// is called on it for every processed frame, with `edges` reused once handed back through
+// releaseProcessedFrame
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_startAsyncProcessing(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject listener) {
+    AsyncProcessor& processor = EdgeProcessor::asyncProcessor();
+    if (processor.running()) {
+        return JNI_FALSE;
+    }
+    jclass listenerClass = env->GetObjectClass(listener);
+    jmethodID method = env->GetMethodID(listenerClass, "onFrameProcessed", "(J[BII)V");
+    env->DeleteLocalRef(listenerClass);
+    if (!method || env->GetJavaVM(&javaVm) != JNI_OK) {
+        LOGE("startAsyncProcessing: listener has no onFrameProcessed(long, byte[], int, int)");
+        env->ExceptionClear();
+        return JNI_FALSE;
+    }
+    if (completionListener) {
+        env->DeleteGlobalRef(completionListener);
+    }
+    completionListener = env->NewGlobalRef(listener);
+    onFrameProcessedMethod = method;
+
+    bool started = processor.start(
+        deliverCompletion,
+        [] {
+            JavaVMAttachArgs args = {JNI_VERSION_1_6, "EdgeCompletion", nullptr};
+            if (javaVm->AttachCurrentThread(&completionEnv, &args) != JNI_OK) {
+                LOGE("Failed to attach completion thread");
+                completionEnv = nullptr;
+            }
+        },
+        [] {
+            if (completionEnv) {
+                javaVm->DetachCurrentThread();
+                completionEnv = nullptr;
+            }
+        });
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+// Stop the completion thread (no callbacks after this returns) and drop queued frames
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_stopAsyncProcessing(
+        JNIEnv* env,
+        jobject /* this */) {
+    EdgeProcessor::asyncProcessor().stop();
+    if (completionListener) {
+        env->DeleteGlobalRef(completionListener);
+        completionListener = nullptr;
+    }
+    clearEdgeArrays(env);
+}
+
+// Hand an edge array from onFrameProcessed back once Java no longer reads it; the next
+// completion of the same size is written into it instead of a new array
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_releaseProcessedFrame(
+        JNIEnv* env,
+        jobject /* this */,
+        jbyteArray edges) {
+    if (!edges) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(edgeArraysMutex);
+    if (freeEdgeArrays.size() < kMaxFreeEdgeArrays) {
+        freeEdgeArrays.push_back(static_cast<jbyteArray>(env->NewGlobalRef(edges)));
+    }
+}
+
+// Ring counters and slot age as JSON
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getFrameRingStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    std::string json = EdgeProcessor::frameRing().statsJson();
+    json.pop_back();
+    json += ",\"async\":" + EdgeProcessor::asyncProcessor().statsJson() + "}";
+    return env->NewStringUTF(json.c_str());
+}
+
+// Native buffer pool usage as JSON
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getMemoryStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    return env->NewStringUTF(BufferPool::instance().statsJson().c_str());
+}
+
+// Thread placement policy for the native workers: "off", "split" or "performance"
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setThreadPlacement(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring policy) {
+    const char* name = env->GetStringUTFChars(policy, nullptr);
+    if (!name) {
+        return JNI_FALSE;
+    }
+    PlacementPolicy parsed;
+    bool ok = ThreadPlacement::parsePolicy(name, parsed);
+    if (ok) {
+        ThreadPlacement::instance().setPolicy(parsed);
+    } else {
+        LOGE("Unknown thread placement policy: %s", name);
+    }
+    env->ReleaseStringUTFChars(policy, name);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+// CPU topology, policy and registered threads as JSON
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getThreadPlacementStats(
+        JNIEnv* env,
+        jobject /* this */) {
+    return env->NewStringUTF(ThreadPlacement::instance().statsJson().c_str());
+}
+
 // JNI export to set Canny thresholds from Kotlin UI
 extern "C" JNIEXPORT void JNICALL
 Java_com_edgedetection_MainActivity_00024Companion_setCannyThresholds(
@@ -118,4 +379,404 @@ Java_com_edgedetection_MainActivity_00024Companion_setCannyThresholds(
         jdouble low,
         jdouble high) {
     EdgeProcessor::setCannyThresholds(static_cast<double>(low), static_cast<double>(high));
-}
\ No newline at end of file
+}
+
+// Fill info with [width, height, generation, frameId, sensorNs, enqueueNs, processStartNs,
+// processEndNs, encodeEndNs] (as many as fit) and return the encoded bytes
+static jbyteArray toJavaFrame(JNIEnv* env, const std::vector<uint8_t>& bytes,
+                              const FrameInfo& frame, jlongArray info) {
+    if (info) {
+        const jlong values[9] = {
+            frame.width, frame.height, static_cast<jlong>(frame.generation),
+            static_cast<jlong>(frame.meta.frameId), frame.meta.sensorTimestampNs, frame.meta.enqueueNs,
+            frame.meta.processStartNs, frame.meta.processEndNs, frame.meta.encodeEndNs
+        };
+        jsize count = std::min<jsize>(env->GetArrayLength(info), 9);
+        env->SetLongArrayRegion(info, 0, count, values);
+    }
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(bytes.size()));
+    if (!result) {
+        LOGE("Failed to create result byte array");
+        return nullptr;
+    }
+    env->SetByteArrayRegion(result, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<const jbyte*>(bytes.data()));
+    return result;
+}
+
+// Latest edge map of a stream as a 1-bit grayscale PNG (cached per generation)
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamPng(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jlongArray info) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    std::vector<uint8_t> png;
+    FrameInfo frame;
+    if (!stream || !stream->packedCache().latestPng(png, frame)) {
+        return nullptr;
+    }
+    return toJavaFrame(env, png, frame, info);
+}
+
+// Latest edge map of a stream as a raw 1 bpp bitmap, MSB first, rows padded to whole bytes
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamPacked(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jlongArray info) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    std::vector<uint8_t> packed;
+    FrameInfo frame;
+    if (!stream || !stream->packedCache().latestPacked(packed, frame)) {
+        return nullptr;
+    }
+    return toJavaFrame(env, packed, frame, info);
+}
+
+// Latest edge map of a stream as simplified polylines (ContourEncoder format, cached
+// per generation), traced with the stream's contour epsilon
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamContours(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jlongArray info) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    std::vector<uint8_t> contours;
+    FrameInfo frame;
+    if (!stream || !stream->packedCache().latestContours(stream->params().contourEpsilon, contours, frame)) {
+        return nullptr;
+    }
+    return toJavaFrame(env, contours, frame, info);
+}
+
+// Latest JPEG of a stream; polling keeps the stream's encoder running for a few seconds
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamJpeg(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jlongArray info) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    if (!stream) {
+        return nullptr;
+    }
+    stream->touchViewer();
+    std::vector<uint8_t> jpeg;
+    FrameInfo frame;
+    if (!stream->jpegCache().latest(jpeg, frame)) {
+        return nullptr;
+    }
+    return toJavaFrame(env, jpeg, frame, info);
+}
+
+// Encoding is skipped while no viewer is subscribed to the stream
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setStreamSubscribed(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jboolean subscribed) {
+    StreamRegistry::instance().getOrCreate(streamId)->setSubscribed(subscribed == JNI_TRUE);
+}
+
+// Block until the encode workers produce a JPEG newer than lastGeneration (or timeout)
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_awaitEncodedJpeg(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jlong lastGeneration,
+        jint timeoutMs,
+        jlongArray info) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    std::vector<uint8_t> jpeg;
+    FrameInfo frame;
+    if (!stream->jpegCache().waitNewer(static_cast<uint64_t>(lastGeneration), timeoutMs, jpeg, frame)) {
+        return nullptr;
+    }
+    return toJavaFrame(env, jpeg, frame, info);
+}
+
+// Feed a Y plane into a stream; processed asynchronously on the shared workers
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_submitStreamFrame(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jbyteArray frameData,
+        jint width,
+        jint height,
+        jint rowStride,
+        jlong sensorTimestampNs) {
+    jsize frameSize = env->GetArrayLength(frameData);
+    if (rowStride < width || frameSize < rowStride * (height - 1) + width) {
+        LOGE("submitStreamFrame: buffer too small for %dx%d stride %d", width, height, rowStride);
+        return JNI_FALSE;
+    }
+    jbyte* frameBytes = env->GetByteArrayElements(frameData, nullptr);
+    if (!frameBytes) {
+        LOGE("Failed to get frame data");
+        return JNI_FALSE;
+    }
+    bool ok = StreamRegistry::instance().submit(streamId, reinterpret_cast<uint8_t*>(frameBytes),
+                                                width, height, rowStride, sensorTimestampNs);
+    env->ReleaseByteArrayElements(frameData, frameBytes, JNI_ABORT);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+// Canny thresholds of a stream; a negative value keeps that threshold as it is
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setStreamThresholds(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jdouble low,
+        jdouble high) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    if (low >= 0) {
+        params.lowThreshold = low;
+    }
+    if (high >= 0) {
+        params.highThreshold = high;
+    }
+    if (streamId == EdgeProcessor::kPrimaryStreamId) {
+        EdgeProcessor::setCannyThresholds(params.lowThreshold, params.highThreshold);
+        return;
+    }
+    stream->setParams(params);
+}
+
+// Capture-to-output latency budget for a stream's frame scheduler (<= 0 disables it)
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setFrameBudget(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jint budgetMs) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.budgetMs = budgetMs;
+    stream->setParams(params);
+}
+
+// Select a stream's detection engine: "imperative", "gapi", "streaming" or "fixed".
+// "streaming" pipelines frames through submitFrame/startAsyncProcessing.
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setProcessingEngine(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jstring engine) {
+    const char* name = env->GetStringUTFChars(engine, nullptr);
+    if (!name) {
+        return JNI_FALSE;
+    }
+    ProcessingEngine parsed;
+    bool ok = parseProcessingEngine(name, parsed);
+    bool gapi = parsed == ProcessingEngine::Gapi || parsed == ProcessingEngine::GapiStreaming;
+    if (ok && gapi && !GapiEdgeGraph::available()) {
+        LOGE("G-API engine requested but OpenCV was built without G-API");
+        ok = false;
+    } else if (!ok) {
+        LOGE("Unknown processing engine: %s", name);
+    }
+    env->ReleaseStringUTFChars(engine, name);
+    if (!ok) {
+        return JNI_FALSE;
+    }
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.engine = parsed;
+    stream->setParams(params);
+    return JNI_TRUE;
+}
+
+// Select a stream's edge detector: "canny", "sobel", "scharr", "laplacian" or "dog"
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setEdgeDetector(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jstring detector) {
+    const char* name = env->GetStringUTFChars(detector, nullptr);
+    if (!name) {
+        return JNI_FALSE;
+    }
+    EdgeDetectorType parsed;
+    bool ok = parseEdgeDetector(name, parsed);
+    if (!ok) {
+        LOGE("Unknown edge detector: %s", name);
+    }
+    env->ReleaseStringUTFChars(detector, name);
+    if (!ok) {
+        return JNI_FALSE;
+    }
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.detector = parsed;
+    stream->setParams(params);
+    return JNI_TRUE;
+}
+
+// Select how a stream's Canny links weak edges: "opencv" or "unionfind" (same output)
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setHysteresisEngine(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jstring engine) {
+    const char* name = env->GetStringUTFChars(engine, nullptr);
+    if (!name) {
+        return JNI_FALSE;
+    }
+    HysteresisEngine parsed;
+    bool ok = parseHysteresisEngine(name, parsed);
+    if (!ok) {
+        LOGE("Unknown hysteresis engine: %s", name);
+    }
+    env->ReleaseStringUTFChars(engine, name);
+    if (!ok) {
+        return JNI_FALSE;
+    }
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.hysteresis = parsed;
+    stream->setParams(params);
+    return JNI_TRUE;
+}
+
+// approxPolyDP tolerance in pixels for a stream's contour output (<= 0 keeps every pixel)
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setContourEpsilon(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jdouble epsilon) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.contourEpsilon = epsilon;
+    stream->setParams(params);
+}
+
+// Line segment detection and tracking on a stream's full frames
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setSegmentsEnabled(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jboolean enabled) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.segments = enabled == JNI_TRUE;
+    stream->setParams(params);
+}
+
+// Tracked line segments of a stream as JSON, or null for an unknown stream
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamSegments(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    if (!stream) {
+        return nullptr;
+    }
+    return env->NewStringUTF(stream->segmentsJson().c_str());
+}
+
+// Temporal stabilization of a stream's edge output: frames an edge must persist for
+// before it is output (0 turns it off)
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setEdgeStabilization(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jint frames) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.stabilizeFrames = std::max(0, std::min(static_cast<int>(frames), TemporalFilter::kMaxFrames));
+    stream->setParams(params);
+}
+
+// Colour-aware Canny on a stream: frames submitted with their U/V planes also get
+// the edges between regions of equal brightness
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setColorEdges(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jboolean enabled) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.colorEdges = enabled == JNI_TRUE;
+    stream->setParams(params);
+}
+
+// Grid size of the per-cell edge densities in a stream's edge stats
+extern "C" JNIEXPORT void JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_setStatsGrid(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId,
+        jint cols,
+        jint rows) {
+    auto stream = StreamRegistry::instance().getOrCreate(streamId);
+    StreamParams params = stream->params();
+    params.statsGridCols = std::max(1, static_cast<int>(cols));
+    params.statsGridRows = std::max(1, static_cast<int>(rows));
+    stream->setParams(params);
+}
+
+// Statistics of a stream's latest edge map as JSON, or null before its first frame
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamEdgeStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    if (!stream) {
+        return nullptr;
+    }
+    std::string json = stream->edgeStatsJson();
+    if (json.empty()) {
+        return nullptr;
+    }
+    return env->NewStringUTF(json.c_str());
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_removeStream(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId) {
+    return StreamRegistry::instance().remove(streamId) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_listStreams(
+        JNIEnv* env,
+        jobject /* this */) {
+    std::vector<int> ids = StreamRegistry::instance().ids();
+    jintArray result = env->NewIntArray(static_cast<jsize>(ids.size()));
+    if (result && !ids.empty()) {
+        env->SetIntArrayRegion(result, 0, static_cast<jsize>(ids.size()), reinterpret_cast<const jint*>(ids.data()));
+    }
+    return result;
+}
+
+// Per-stream parameters and stats as JSON, or null for an unknown stream
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_edgedetection_MainActivity_00024Companion_getStreamStatus(
+        JNIEnv* env,
+        jobject /* this */,
+        jint streamId) {
+    auto stream = StreamRegistry::instance().find(streamId);
+    if (!stream) {
+        return nullptr;
+    }
+    return env->NewStringUTF(stream->statsJson().c_str());
+}
@@ -0,0 +1,270 @@
+#include "pipeline_variants.h"
+#include "simd_util.h"
+#include "stream_registry.h"
+#include "task_scheduler.h"
+#include "union_find_canny.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Rows per tile; a tile recomputes the blurred rows its gradients need from its neighbours
+const int kTileRows = 96;
+
+// Separable first-derivative Sobel: smoothing across the axis, derivative along it
+template <int A>
+struct SobelTaps;
+
+template <>
+struct SobelTaps<3> {
+    static constexpr int kSmooth[3] = {1, 2, 1};
+    static constexpr int kDeriv[3] = {-1, 0, 1};
+};
+
+template <>
+struct SobelTaps<5> {
+    static constexpr int kSmooth[5] = {1, 4, 6, 4, 1};
+    static constexpr int kDeriv[5] = {-1, -2, 0, 2, 1};
+};
+
+#if CV_SIMD
+template <int C>
+inline cv::v_int16 weigh(const cv::v_int16& v) {
+    if constexpr (C == 1) {
+        return v;
+    } else if constexpr (C == -1) {
+        return cv::v_sub(cv::vx_setzero_s16(), v);
+    } else if constexpr (C == 2) {
+        return cv::v_add(v, v);
+    } else {
+        return cv::v_mul_wrap(v, cv::vx_setall_s16(static_cast<short>(C)));
+    }
+}
+#endif
+
+// dx/dy of one row from the A blurred rows around it, replicating the first and last
+// column like cv::Sobel(BORDER_REPLICATE). Aperture 5 peaks at 6 * 16 * 255, inside 16 bits.
+template <int A>
+void sobelRow(const uchar* const* rows, int width, short* dx, short* dy) {
+    using S = SobelTaps<A>;
+    constexpr int r = A / 2;
+    auto pixel = [&](int x) {
+        int gx = 0;
+        int gy = 0;
+        unroll<A>([&](auto i) {
+            constexpr int row = decltype(i)::value;
+            int smooth = 0;
+            int deriv = 0;
+            unroll<A>([&](auto j) {
+                constexpr int col = decltype(j)::value;
+                int v = rows[row][std::min(std::max(x + col - r, 0), width - 1)];
+                smooth += S::kSmooth[col] * v;
+                deriv += S::kDeriv[col] * v;
+            });
+            gx += S::kSmooth[row] * deriv;
+            gy += S::kDeriv[row] * smooth;
+        });
+        dx[x] = static_cast<short>(gx);
+        dy[x] = static_cast<short>(gy);
+    };
+    int x = 0;
+    for (; x < std::min(r, width); x++) {
+        pixel(x);
+    }
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_int16>::vlanes();
+    for (; x + lanes + r <= width; x += lanes) {
+        cv::v_int16 gx = cv::vx_setzero_s16();
+        cv::v_int16 gy = cv::vx_setzero_s16();
+        unroll<A>([&](auto i) {
+            constexpr int row = decltype(i)::value;
+            cv::v_int16 smooth = cv::vx_setzero_s16();
+            cv::v_int16 deriv = cv::vx_setzero_s16();
+            unroll<A>([&](auto j) {
+                constexpr int col = decltype(j)::value;
+                cv::v_int16 v = cv::v_reinterpret_as_s16(cv::vx_load_expand(rows[row] + x + col - r));
+                smooth = cv::v_add(smooth, weigh<S::kSmooth[col]>(v));
+                if constexpr (S::kDeriv[col] != 0) {
+                    deriv = cv::v_add(deriv, weigh<S::kDeriv[col]>(v));
+                }
+            });
+            gx = cv::v_add(gx, weigh<S::kSmooth[row]>(deriv));
+            if constexpr (S::kDeriv[row] != 0) {
+                gy = cv::v_add(gy, weigh<S::kDeriv[row]>(smooth));
+            }
+        });
+        cv::v_store(dx + x, gx);
+        cv::v_store(dy + x, gy);
+    }
+#endif
+    for (; x < width; x++) {
+        pixel(x);
+    }
+}
+
+// Blur and gradients of rows [rowBegin, rowEnd). The blurred rows the gradients need
+// from outside the range are recomputed into a local buffer, never written, so
+// disjoint ranges run concurrently.
+template <int K, int A>
+void filterRows(const cv::Mat& gray, cv::Mat& blur, cv::Mat& dx, cv::Mat& dy, int rowBegin, int rowEnd) {
+    constexpr int rb = K / 2;
+    constexpr int rs = A / 2;
+    const int rows = gray.rows;
+    const int width = gray.cols;
+    const int first = std::max(rowBegin - rs, 0);
+    const int last = std::min(rowEnd + rs, rows);
+
+    // Ring of horizontally filtered rows, indexed by unreflected source row
+    cv::AutoBuffer<ushort> ring(static_cast<size_t>(K) * width);
+    cv::AutoBuffer<uchar> context(static_cast<size_t>(2 * rs) * width);
+    auto ringRow = [&](int j) { return ring.data() + static_cast<size_t>((j - first + K) % K) * width; };
+    auto blurRow = [&](int y) -> uchar* {
+        if (y < rowBegin) {
+            return context.data() + static_cast<size_t>(rowBegin - 1 - y) * width;
+        }
+        if (y >= rowEnd) {
+            return context.data() + static_cast<size_t>(rs + y - rowEnd) * width;
+        }
+        return blur.ptr<uchar>(y);
+    };
+
+    for (int j = first - rb; j < first + rb; j++) {
+        blurRowHorizontal<K>(gray.ptr<uchar>(reflect101(j, rows)), width, BlurTaps<K>::kTaps, ringRow(j));
+    }
+    const ushort* taps[K];
+    const uchar* window[A];
+    int nextGradientRow = rowBegin;
+    for (int y = first; y < last; y++) {
+        // Row y + rb enters the window into the slot row y - rb - 1 just left
+        blurRowHorizontal<K>(gray.ptr<uchar>(reflect101(y + rb, rows)), width, BlurTaps<K>::kTaps,
+                             ringRow(y + rb));
+        for (int i = 0; i < K; i++) {
+            taps[i] = ringRow(y - rb + i);
+        }
+        blurRowVertical<K>(taps, width, BlurTaps<K>::kTaps, blurRow(y));
+
+        // Gradients of a row are ready once the blurred rows below it (replicated at
+        // the bottom edge) exist
+        while (nextGradientRow < rowEnd && std::min(nextGradientRow + rs, rows - 1) <= y) {
+            int g = nextGradientRow++;
+            for (int i = 0; i < A; i++) {
+                window[i] = blurRow(std::min(std::max(g - rs + i, 0), rows - 1));
+            }
+            sobelRow<A>(window, width, dx.ptr<short>(g), dy.ptr<short>(g));
+        }
+    }
+    cv::vx_cleanup();
+}
+
+// 0/255 edges to opaque gray RGBA, as cvtColor(COLOR_GRAY2RGBA)
+void expandRgba(const cv::Mat& edges, cv::Mat& rgba, int rowBegin, int rowEnd) {
+    const int width = edges.cols;
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const uchar* src = edges.ptr<uchar>(y);
+        uchar* dst = rgba.ptr<uchar>(y);
+        int x = 0;
+#if CV_SIMD
+        const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+        const cv::v_uint8 alpha = cv::vx_setall_u8(255);
+        for (; x + lanes <= width; x += lanes) {
+            cv::v_uint8 v = cv::vx_load(src + x);
+            cv::v_store_interleave(dst + 4 * x, v, v, v, alpha);
+        }
+#endif
+        for (; x < width; x++) {
+            dst[4 * x] = dst[4 * x + 1] = dst[4 * x + 2] = src[x];
+            dst[4 * x + 3] = 255;
+        }
+    }
+    cv::vx_cleanup();
+}
+
+template <int BlurK, int Aperture, bool L2, EdgeOutputFormat OutFmt>
+struct Pipeline {
+    static void run(const cv::Mat& gray, cv::Mat& blur, cv::Mat& out, const StreamParams& params) {
+        CV_Assert(gray.type() == CV_8UC1);
+        blur.create(gray.size(), CV_8UC1);
+        thread_local cv::Mat dx;
+        thread_local cv::Mat dy;
+        thread_local cv::Mat edges;
+        dx.create(gray.size(), CV_16SC1);
+        dy.create(gray.size(), CV_16SC1);
+        // Tiles run on other threads, which must see this thread's buffers
+        cv::Mat* gx = &dx;
+        cv::Mat* gy = &dy;
+        TaskScheduler& scheduler = TaskScheduler::instance();
+        scheduler.parallelFor(0, gray.rows, kTileRows, [&](int begin, int end) {
+            filterRows<BlurK, Aperture>(gray, blur, *gx, *gy, begin, end);
+        });
+        if constexpr (OutFmt == EdgeOutputFormat::Gray) {
+            canny(dx, dy, out, params);
+        } else {
+            canny(dx, dy, edges, params);
+            out.create(gray.size(), CV_8UC4);
+            const cv::Mat* map = &edges;
+            scheduler.parallelFor(0, gray.rows, kTileRows, [&](int begin, int end) {
+                expandRgba(*map, out, begin, end);
+            });
+        }
+    }
+
+private:
+    static void canny(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, const StreamParams& p) {
+        UnionFindCanny::rememberGradients(dx, dy);
+        if (p.hysteresis == HysteresisEngine::UnionFind) {
+            UnionFindCanny::run(dx, dy, edges, p.lowThreshold, p.highThreshold, L2);
+        } else {
+            cv::Canny(dx, dy, edges, p.lowThreshold, p.highThreshold, L2);
+        }
+    }
+};
+
+using Variant = PipelineVariants::Variant;
+constexpr EdgeOutputFormat kGray = EdgeOutputFormat::Gray;
+constexpr EdgeOutputFormat kRgba = EdgeOutputFormat::Rgba;
+
+// Indexed by [blur 3x3/0.8, 5x5/1.4][aperture 3, 5][L1, L2][Gray, Rgba]
+const Variant kVariants[2][2][2][2] = {
+    {{{Pipeline<3, 3, false, kGray>::run, Pipeline<3, 3, false, kRgba>::run},
+      {Pipeline<3, 3, true, kGray>::run, Pipeline<3, 3, true, kRgba>::run}},
+     {{Pipeline<3, 5, false, kGray>::run, Pipeline<3, 5, false, kRgba>::run},
+      {Pipeline<3, 5, true, kGray>::run, Pipeline<3, 5, true, kRgba>::run}}},
+    {{{Pipeline<5, 3, false, kGray>::run, Pipeline<5, 3, false, kRgba>::run},
+      {Pipeline<5, 3, true, kGray>::run, Pipeline<5, 3, true, kRgba>::run}},
+     {{Pipeline<5, 5, false, kGray>::run, Pipeline<5, 5, false, kRgba>::run},
+      {Pipeline<5, 5, true, kGray>::run, Pipeline<5, 5, true, kRgba>::run}}},
+};
+
+}  // namespace
+
+PipelineVariants::Variant PipelineVariants::find(const StreamParams& p, EdgeOutputFormat format) {
+    if (p.detector != EdgeDetectorType::Canny) {
+        return nullptr;
+    }
+    int blur;
+    if (p.blurSize == 3 && p.blurSigma == BlurTaps<3>::kSigma) {
+        blur = 0;
+    } else if (p.blurSize == 5 && p.blurSigma == BlurTaps<5>::kSigma) {
+        blur = 1;
+    } else {
+        return nullptr;
+    }
+    if (p.cannyAperture != 3 && p.cannyAperture != 5) {
+        return nullptr;
+    }
+    return kVariants[blur][p.cannyAperture == 5][p.cannyL2][format == EdgeOutputFormat::Rgba];
+}
+
+void PipelineVariants::runGeneric(const cv::Mat& gray, cv::Mat& blur, cv::Mat& out, const StreamParams& p,
+                                  EdgeOutputFormat format) {
+    cv::GaussianBlur(gray, blur, cv::Size(p.blurSize, p.blurSize), p.blurSigma);
+    if (format == EdgeOutputFormat::Gray) {
+        EdgeDetector::get(p.detector).detect(blur, out, p);
+        return;
+    }
+    thread_local cv::Mat edges;
+    EdgeDetector::get(p.detector).detect(blur, edges, p);
+    cv::cvtColor(edges, out, cv::COLOR_GRAY2RGBA);
+}
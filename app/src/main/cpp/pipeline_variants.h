@@ -0,0 +1,40 @@
+#ifndef PIPELINE_VARIANTS_H
+#define PIPELINE_VARIANTS_H
+
+#include <opencv2/core.hpp>
+
+struct StreamParams;
+
+// Layout of a pipeline's edge output
+enum class EdgeOutputFormat {
+    Gray,  // CV_8UC1, 0/255
+    Rgba,  // CV_8UC4 gray-on-opaque, what the bitmap paths display
+};
+
+// Blur -> Canny as compile-time specialized variants, Pipeline<BlurK, Aperture, L2, OutFmt>.
+//
+// Each variant has its Q8 blur kernel and Sobel aperture as constants, so the
+// per-tap loops are fully unrolled with no runtime kernel lookups. The blur and
+// the gradients are fused per row tile on the TaskScheduler, and Canny starts from
+// those gradients. The RGBA variants write the display format directly instead of
+// a separate cvtColor pass. Output is bit-exact with GaussianBlur + Canny (+
+// cvtColor), which is what runGeneric does for every other parameter combination.
+//
+// Instantiated variants: blur 3x3/0.8 and 5x5/1.4, aperture 3 and 5, L1 and L2
+// magnitude, Gray and Rgba output.
+class PipelineVariants {
+public:
+    // `blur` and `out` are (re)allocated unless they already have the right size and type.
+    // Thresholds and the hysteresis engine come from `params`.
+    using Variant = void (*)(const cv::Mat& gray, cv::Mat& blur, cv::Mat& out, const StreamParams& params);
+
+    // Variant for the stream's blur and Canny settings, or nullptr when none is
+    // instantiated (or the detector is not Canny). A constant-time table lookup.
+    static Variant find(const StreamParams& params, EdgeOutputFormat format);
+
+    // Runtime-parameterized OpenCV calls for any settings
+    static void runGeneric(const cv::Mat& gray, cv::Mat& blur, cv::Mat& out, const StreamParams& params,
+                           EdgeOutputFormat format);
+};
+
+#endif // PIPELINE_VARIANTS_H
@@ -0,0 +1,258 @@
+#include "segment_tracker.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// HoughLinesP: 1 px / 1 degree accumulator, votes and gap in pixels
+const double kHoughRho = 1.0;
+const double kHoughTheta = CV_PI / 180.0;
+const int kHoughVotes = 40;
+const int kMaxLineGap = 4;
+// Shortest segment, as a fraction of the smaller frame side (and at least kMinLength)
+const int kMinLengthDivisor = 24;
+const int kMinLength = 16;
+
+// A pixel's gradient is aligned when it is within 22.5 degrees of the segment normal,
+// and a segment is kept when this share of its pixels is aligned
+const float kAlignCos = 0.9238795f;
+const float kMinAligned = 0.6f;
+
+// Track matching: direction, distance of the detection's midpoint from the track's
+// line, and the largest gap between the two along the line
+const float kMatchCos = 0.9945219f;  // 6 degrees
+const float kMatchDistance = 5.f;
+const float kMatchGap = 8.f;
+// Share of the way a matched track moves towards its detection; stable tracks move less
+const float kNewTrackGain = 0.6f;
+const float kStableTrackGain = 0.3f;
+// Frames a track survives without a match
+const int kMaxMisses = 5;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Gradient at (x, y): Canny's own when given, else 3x3 Sobel with replicated borders
+// (what Canny computes for aperture 3)
+cv::Point2f gradientAt(const cv::Mat& dx, const cv::Mat& dy, const cv::Mat& image, int x, int y) {
+    if (!dx.empty()) {
+        return cv::Point2f(dx.at<short>(y, x), dy.at<short>(y, x));
+    }
+    int x0 = std::max(x - 1, 0);
+    int x2 = std::min(x + 1, image.cols - 1);
+    const uint8_t* up = image.ptr<uint8_t>(std::max(y - 1, 0));
+    const uint8_t* mid = image.ptr<uint8_t>(y);
+    const uint8_t* down = image.ptr<uint8_t>(std::min(y + 1, image.rows - 1));
+    int gx = (up[x2] - up[x0]) + 2 * (mid[x2] - mid[x0]) + (down[x2] - down[x0]);
+    int gy = (down[x0] - up[x0]) + 2 * (down[x] - up[x]) + (down[x2] - up[x2]);
+    return cv::Point2f(static_cast<float>(gx), static_cast<float>(gy));
+}
+
+// Hough's rasterized line can run a pixel beside the edge it voted for; take the
+// nearest edge pixel in the 3x3 neighbourhood
+bool nearestEdge(const cv::Mat& edges, cv::Point p, cv::Point& found) {
+    if (edges.at<uint8_t>(p)) {
+        found = p;
+        return true;
+    }
+    for (int oy = -1; oy <= 1; oy++) {
+        for (int ox = -1; ox <= 1; ox++) {
+            cv::Point q(p.x + ox, p.y + oy);
+            if (q.x >= 0 && q.y >= 0 && q.x < edges.cols && q.y < edges.rows && edges.at<uint8_t>(q)) {
+                found = q;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline float length(const cv::Point2f& v) {
+    return std::sqrt(v.x * v.x + v.y * v.y);
+}
+
+// Matching cost of a detection against a track, or a negative value when they are
+// not the same line
+float matchCost(const LineSegment& track, const LineSegment& detection) {
+    cv::Point2f dir = track.b - track.a;
+    float len = length(dir);
+    cv::Point2f other = detection.b - detection.a;
+    float otherLen = length(other);
+    if (len < 1.f || otherLen < 1.f) {
+        return -1.f;
+    }
+    dir *= 1.f / len;
+    float cosAngle = dir.dot(other) / otherLen;
+    if (cosAngle < kMatchCos) {
+        return -1.f;
+    }
+    cv::Point2f mid = (detection.a + detection.b) * 0.5f - track.a;
+    float distance = std::abs(mid.x * dir.y - mid.y * dir.x);
+    if (distance > kMatchDistance) {
+        return -1.f;
+    }
+    // Positions of the detection's endpoints along the track
+    float s0 = (detection.a - track.a).dot(dir);
+    float s1 = (detection.b - track.a).dot(dir);
+    float gap = std::max(std::min(s0, s1) - len, -std::max(s0, s1));
+    if (gap > kMatchGap) {
+        return -1.f;
+    }
+    return distance + (1.f - cosAngle) * 100.f;
+}
+
+}  // namespace
+
+void SegmentDetector::detect(const cv::Mat& edges, const cv::Mat& dx, const cv::Mat& dy, const cv::Mat& image,
+                             std::vector<LineSegment>& segments, SegmentTiming* timing) {
+    segments.clear();
+    if (edges.empty()) {
+        return;
+    }
+    auto start = Clock::now();
+    std::vector<cv::Vec4i> lines;
+    int minLength = std::max(kMinLength, std::min(edges.cols, edges.rows) / kMinLengthDivisor);
+    cv::HoughLinesP(edges, lines, kHoughRho, kHoughTheta, kHoughVotes, minLength, kMaxLineGap);
+    if (timing) {
+        timing->houghMs = elapsedMs(start);
+    }
+
+    start = Clock::now();
+    for (const cv::Vec4i& line : lines) {
+        cv::Point2f a(static_cast<float>(line[0]), static_cast<float>(line[1]));
+        cv::Point2f b(static_cast<float>(line[2]), static_cast<float>(line[3]));
+        cv::Point2f dir = b - a;
+        float len = length(dir);
+        if (len < 1.f) {
+            continue;
+        }
+        cv::Point2f normal(-dir.y / len, dir.x / len);
+
+        int total = 0;
+        int aligned = 0;
+        float side = 0.f;
+        float magnitude = 0.f;
+        cv::LineIterator it(edges, cv::Point(line[0], line[1]), cv::Point(line[2], line[3]), 8);
+        for (int i = 0; i < it.count; i++, ++it) {
+            total++;
+            cv::Point p;
+            if (!nearestEdge(edges, it.pos(), p)) {
+                continue;
+            }
+            cv::Point2f g = gradientAt(dx, dy, image, p.x, p.y);
+            float norm = length(g);
+            float along = g.dot(normal);
+            if (norm > 0.f && std::abs(along) >= kAlignCos * norm) {
+                aligned++;
+                side += along;
+                magnitude += norm;
+            }
+        }
+        if (total == 0 || aligned < kMinAligned * total) {
+            continue;
+        }
+        LineSegment segment;
+        // Orient by polarity so tracking tells apart the two sides of a thin bar
+        segment.a = side >= 0.f ? a : b;
+        segment.b = side >= 0.f ? b : a;
+        segment.strength = magnitude / aligned;
+        segment.aligned = static_cast<float>(aligned) / total;
+        segments.push_back(segment);
+    }
+    if (timing) {
+        timing->validateMs = elapsedMs(start);
+    }
+}
+
+void SegmentTracker::update(const std::vector<LineSegment>& detections, uint64_t id) {
+    frameId = id;
+    // Greedy one-to-one matching, cheapest pairs first
+    struct Candidate {
+        float cost;
+        int track;
+        int detection;
+    };
+    std::vector<Candidate> candidates;
+    for (int t = 0; t < static_cast<int>(active.size()); t++) {
+        for (int d = 0; d < static_cast<int>(detections.size()); d++) {
+            float cost = matchCost(active[t].segment, detections[d]);
+            if (cost >= 0.f) {
+                candidates.push_back({cost, t, d});
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& l, const Candidate& r) { return l.cost < r.cost; });
+
+    std::vector<bool> trackMatched(active.size(), false);
+    std::vector<bool> detectionMatched(detections.size(), false);
+    for (const Candidate& c : candidates) {
+        if (trackMatched[c.track] || detectionMatched[c.detection]) {
+            continue;
+        }
+        trackMatched[c.track] = true;
+        detectionMatched[c.detection] = true;
+        TrackedSegment& track = active[c.track];
+        const LineSegment& seen = detections[c.detection];
+        float gain = track.hits >= kStableHits ? kStableTrackGain : kNewTrackGain;
+        track.segment.a += (seen.a - track.segment.a) * gain;
+        track.segment.b += (seen.b - track.segment.b) * gain;
+        track.segment.strength += (seen.strength - track.segment.strength) * gain;
+        track.segment.aligned = seen.aligned;
+        track.hits++;
+        track.misses = 0;
+        track.lastFrameId = id;
+    }
+
+    for (size_t t = 0; t < active.size(); t++) {
+        if (!trackMatched[t]) {
+            active[t].misses++;
+        }
+    }
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [](const TrackedSegment& track) { return track.misses > kMaxMisses; }),
+                 active.end());
+
+    for (size_t d = 0; d < detections.size(); d++) {
+        if (detectionMatched[d]) {
+            continue;
+        }
+        TrackedSegment track;
+        track.id = nextId++;
+        track.segment = detections[d];
+        track.hits = 1;
+        track.lastFrameId = id;
+        active.push_back(track);
+    }
+}
+
+void SegmentTracker::reset() {
+    active.clear();
+    frameId = 0;
+}
+
+std::string SegmentTracker::toJson(int width, int height, const SegmentTiming& timing) const {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"frameId\":%llu,\"width\":%d,\"height\":%d,\"houghMs\":%.2f,\"validateMs\":%.2f,\"trackMs\":%.2f,"
+             "\"segments\":[",
+             (unsigned long long)frameId, width, height, timing.houghMs, timing.validateMs, timing.trackMs);
+    std::string json(buf);
+    for (size_t i = 0; i < active.size(); i++) {
+        const TrackedSegment& t = active[i];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"id\":%d,\"x1\":%.1f,\"y1\":%.1f,\"x2\":%.1f,\"y2\":%.1f,\"strength\":%.1f,"
+                 "\"hits\":%d,\"misses\":%d,\"stable\":%s}",
+                 i ? "," : "", t.id, t.segment.a.x, t.segment.a.y, t.segment.b.x, t.segment.b.y,
+                 t.segment.strength, t.hits, t.misses, t.hits >= kStableHits ? "true" : "false");
+        json += buf;
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,68 @@
+#ifndef SEGMENT_TRACKER_H
+#define SEGMENT_TRACKER_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A straight edge segment, oriented so the gradient (towards the brighter side)
+// points to the left of a -> b
+struct LineSegment {
+    cv::Point2f a;
+    cv::Point2f b;
+    float strength = 0.f;  // mean gradient magnitude of the aligned support pixels
+    float aligned = 0.f;   // share of the segment's pixels whose gradient is normal to it
+};
+
+// Time spent in each stage of the last detect/update, in milliseconds
+struct SegmentTiming {
+    double houghMs = 0.0;
+    double validateMs = 0.0;
+    double trackMs = 0.0;
+};
+
+// Probabilistic Hough on an edge map, validated LSD-style: a segment is kept only
+// when most of its pixels have a gradient normal to it, which rejects the chords
+// Hough finds across curves and textured areas.
+class SegmentDetector {
+public:
+    // `dx`/`dy` are the CV_16SC1 gradients Canny started from. When they are empty,
+    // 3x3 Sobel is evaluated on `image` at the segments' pixels only.
+    static void detect(const cv::Mat& edges, const cv::Mat& dx, const cv::Mat& dy, const cv::Mat& image,
+                       std::vector<LineSegment>& segments, SegmentTiming* timing = nullptr);
+};
+
+struct TrackedSegment {
+    int id = 0;
+    LineSegment segment;
+    int hits = 0;    // frames the segment was matched in
+    int misses = 0;  // consecutive frames without a match
+    uint64_t lastFrameId = 0;
+};
+
+// Keeps segments alive across frames. Detections are matched to tracks by direction,
+// distance from the track's line and overlap; a matched track moves part of the
+// way towards the detection, so stable lines stay put while Hough endpoints jitter.
+class SegmentTracker {
+public:
+    // Matched this many times, a track counts as stable
+    static const int kStableHits = 3;
+
+    void update(const std::vector<LineSegment>& detections, uint64_t frameId);
+    void reset();
+
+    const std::vector<TrackedSegment>& tracks() const { return active; }
+
+    // {"frameId":..,"width":..,"height":..,"houghMs":..,"validateMs":..,"trackMs":..,
+    //  "segments":[{"id":..,"x1":..,"y1":..,"x2":..,"y2":..,"strength":..,"hits":..,
+    //  "misses":..,"stable":..},...]}
+    std::string toJson(int width, int height, const SegmentTiming& timing) const;
+
+private:
+    std::vector<TrackedSegment> active;
+    uint64_t frameId = 0;
+    int nextId = 1;
+};
+
+#endif // SEGMENT_TRACKER_H
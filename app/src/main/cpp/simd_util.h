@@ -0,0 +1,139 @@
+#ifndef SIMD_UTIL_H
+#define SIMD_UTIL_H
+
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Row helpers shared by FixedPointFilter, the pipeline variants and the gradient
+// detectors. Internal to the native library; everything here is inline.
+
+// Blur coefficients carry 8 fractional bits, the vertical accumulator 16
+constexpr int kBlurKernelBits = 8;
+
+// Q8 blur kernels, as FixedPointFilter::gaussianKernel derives them for OpenCV's
+// bit-exact GaussianBlur
+template <int K>
+struct BlurTaps;
+
+template <>
+struct BlurTaps<3> {
+    static constexpr double kSigma = 0.8;
+    static constexpr uint16_t kTaps[3] = {61, 134, 61};
+};
+
+template <>
+struct BlurTaps<5> {
+    static constexpr double kSigma = 1.4;
+    static constexpr uint16_t kTaps[5] = {28, 61, 78, 61, 28};
+};
+
+// f(std::integral_constant<int, I>()) for I in [0, N), expanded at compile time
+template <typename F, int... I>
+inline void unrollImpl(F& f, std::integer_sequence<int, I...>) {
+    (f(std::integral_constant<int, I>()), ...);
+}
+
+template <int N, typename F>
+inline void unroll(F&& f) {
+    unrollImpl(f, std::make_integer_sequence<int, N>());
+}
+
+// f(t) for t in [0, n): unrolled when N > 0 (then n == N), a plain loop otherwise
+template <int N, typename F>
+inline void forEachTap(int n, F&& f) {
+    if constexpr (N > 0) {
+        unroll<N>(f);
+    } else {
+        for (int t = 0; t < n; t++) {
+            f(t);
+        }
+    }
+}
+
+// BORDER_REFLECT_101 index into [0, n)
+inline int reflect101(int i, int n) {
+    if (n == 1) {
+        return 0;
+    }
+    while (i < 0 || i >= n) {
+        i = i < 0 ? -i : 2 * n - 2 - i;
+    }
+    return i;
+}
+
+#if CV_SIMD
+// One register of u8 samples as two registers of s16
+inline void expandS16(const uint8_t* p, cv::v_int16& lo, cv::v_int16& hi) {
+    cv::v_uint16 a, b;
+    cv::v_expand(cv::vx_load(p), a, b);
+    lo = cv::v_reinterpret_as_s16(a);
+    hi = cv::v_reinterpret_as_s16(b);
+}
+#endif
+
+// Q8 horizontal blur pass with BORDER_REFLECT_101. The taps are symmetric, so each
+// mirrored pair is summed and weighted once. K > 0 fixes the kernel size at compile
+// time and unrolls the taps; K == 0 takes it from `size`.
+template <int K = 0>
+inline void blurRowHorizontal(const uint8_t* src, int width, const uint16_t* taps, uint16_t* out, int size = K) {
+    const int n = K > 0 ? K : size;
+    const int r = n / 2;
+    // A u8 sample times a Q8 kernel summing to 256 stays below 65536
+    auto pixel = [&](int x) {
+        unsigned acc = 0;
+        forEachTap<K>(n, [&](int t) { acc += taps[t] * src[reflect101(x + t - r, width)]; });
+        return static_cast<uint16_t>(acc);
+    };
+    int x = 0;
+    for (; x < std::min(r, width); x++) {
+        out[x] = pixel(x);
+    }
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint16>::vlanes();
+    for (; x + lanes + r <= width; x += lanes) {
+        cv::v_uint16 acc = cv::v_mul_wrap(cv::vx_load_expand(src + x), cv::vx_setall_u16(taps[r]));
+        forEachTap<K / 2>(r, [&](int t) {
+            cv::v_uint16 pair = cv::v_add(cv::vx_load_expand(src + x + t - r), cv::vx_load_expand(src + x + r - t));
+            acc = cv::v_add_wrap(acc, cv::v_mul_wrap(pair, cv::vx_setall_u16(taps[t])));
+        });
+        cv::v_store(out + x, acc);
+    }
+#endif
+    for (; x < width; x++) {
+        out[x] = pixel(x);
+    }
+}
+
+// Q16 vertical blur pass over the horizontally filtered rows, rounded half up to 8 bits
+template <int K = 0>
+inline void blurRowVertical(const uint16_t* const* rows, int width, const uint16_t* taps, uint8_t* out,
+                            int size = K) {
+    const int n = K > 0 ? K : size;
+    const uint32_t round = 1u << (2 * kBlurKernelBits - 1);
+    int x = 0;
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_uint16>::vlanes();
+    const cv::v_uint32 vround = cv::vx_setall_u32(round);
+    for (; x + lanes <= width; x += lanes) {
+        cv::v_uint32 lo = vround;
+        cv::v_uint32 hi = vround;
+        forEachTap<K>(n, [&](int t) {
+            cv::v_uint32 a, b;
+            cv::v_mul_expand(cv::vx_load(rows[t] + x), cv::vx_setall_u16(taps[t]), a, b);
+            lo = cv::v_add(lo, a);
+            hi = cv::v_add(hi, b);
+        });
+        cv::v_pack_store(out + x, cv::v_pack(cv::v_shr<2 * kBlurKernelBits>(lo), cv::v_shr<2 * kBlurKernelBits>(hi)));
+    }
+#endif
+    for (; x < width; x++) {
+        uint32_t acc = round;
+        forEachTap<K>(n, [&](int t) { acc += static_cast<uint32_t>(taps[t]) * rows[t][x]; });
+        out[x] = static_cast<uint8_t>(acc >> (2 * kBlurKernelBits));
+    }
+}
+
+#endif // SIMD_UTIL_H
@@ -0,0 +1,628 @@
+#include "stream_registry.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include "fixed_point_filter.h"
+#include "gapi_backend.h"
+#include "pipeline_variants.h"
+#include "task_scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#define LOG_TAG "StreamRegistry"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// A polling viewer keeps encoding enabled for this long after its last request
+static const int64_t kViewerTimeoutMs = 3000;
+
+// Rows per blur tile: 8 tiles at 720p, enough to balance across cores and streams
+static const int kBlurTileRows = 96;
+
+// Extra rows detected around a changed band so blur and gradients see real neighbours
+static const int kPartialMarginRows = 8;
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* processingEngineName(ProcessingEngine engine) {
+    switch (engine) {
+        case ProcessingEngine::Imperative: return "imperative";
+        case ProcessingEngine::Gapi: return "gapi";
+        case ProcessingEngine::GapiStreaming: return "streaming";
+        case ProcessingEngine::FixedPoint: return "fixed";
+        default: return "unknown";
+    }
+}
+
+bool parseProcessingEngine(const std::string& name, ProcessingEngine& engine) {
+    for (ProcessingEngine candidate :
+         {ProcessingEngine::Imperative, ProcessingEngine::Gapi, ProcessingEngine::GapiStreaming,
+          ProcessingEngine::FixedPoint}) {
+        if (name == processingEngineName(candidate)) {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+StreamContext::StreamContext(int id) : streamId(id) {}
+
+StreamContext::~StreamContext() = default;
+
+// Integer blur + Sobel in one pass per tile. Canny then starts from the gradients
+// instead of recomputing them; other detectors take the blurred frame. Settings with
+// a compile-time specialized variant run that instead.
+static void detectFixedPoint(const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges, const StreamParams& p) {
+    if (PipelineVariants::Variant variant = PipelineVariants::find(p, EdgeOutputFormat::Gray)) {
+        variant(gray, blur, edges, p);
+        return;
+    }
+    FixedPointFilter filter(p.blurSize, p.blurSigma);
+    thread_local cv::Mat dx;
+    thread_local cv::Mat dy;
+    // Tiles run on other threads, which must see this thread's buffers
+    cv::Mat* gx = nullptr;
+    cv::Mat* gy = nullptr;
+    // The filter's gradients are Canny's only for the 3x3 aperture
+    if (p.detector == EdgeDetectorType::Canny && p.cannyAperture == 3) {
+        dx.create(gray.rows, gray.cols, CV_16SC1);
+        dy.create(gray.rows, gray.cols, CV_16SC1);
+        gx = &dx;
+        gy = &dy;
+    }
+    TaskScheduler::instance().parallelFor(0, gray.rows, kBlurTileRows, [&](int begin, int end) {
+        filter.apply(gray, blur, gx, gy, begin, end);
+    });
+    if (gx) {
+        UnionFindCanny::fromGradients(*gx, *gy, edges, p);
+    } else {
+        EdgeDetector::get(p.detector).detect(blur, edges, p);
+    }
+}
+
+// Colour-aware Canny: 3x3 luma gradients (fused with the blur on the fixed engine),
+// merged with the chroma planes' gradients in one half-resolution pass
+static void detectColor(const cv::Mat& gray, const ChromaPlanes& chroma, cv::Mat& blur, cv::Mat& edges,
+                        const StreamParams& p) {
+    thread_local cv::Mat dx;
+    thread_local cv::Mat dy;
+    dx.create(gray.rows, gray.cols, CV_16SC1);
+    dy.create(gray.rows, gray.cols, CV_16SC1);
+    // Tiles run on other threads, which must see this thread's buffers
+    cv::Mat* gx = &dx;
+    cv::Mat* gy = &dy;
+    if (p.engine == ProcessingEngine::FixedPoint) {
+        FixedPointFilter filter(p.blurSize, p.blurSigma);
+        TaskScheduler::instance().parallelFor(0, gray.rows, kBlurTileRows, [&](int begin, int end) {
+            filter.apply(gray, blur, gx, gy, begin, end);
+        });
+    } else {
+        TaskScheduler::instance().parallelFor(0, gray.rows, kBlurTileRows, [&](int begin, int end) {
+            cv::Mat band = blur.rowRange(begin, end);
+            cv::GaussianBlur(gray.rowRange(begin, end), band, cv::Size(p.blurSize, p.blurSize), p.blurSigma);
+        });
+        // Bands read the blurred rows around them, as Canny's own Sobel would
+        TaskScheduler::instance().parallelFor(0, gray.rows, kBlurTileRows, [&](int begin, int end) {
+            cv::Mat bandX = gx->rowRange(begin, end);
+            cv::Mat bandY = gy->rowRange(begin, end);
+            cv::Sobel(blur.rowRange(begin, end), bandX, CV_16S, 1, 0, 3, 1, 0, cv::BORDER_REPLICATE);
+            cv::Sobel(blur.rowRange(begin, end), bandY, CV_16S, 0, 1, 3, 1, 0, cv::BORDER_REPLICATE);
+        });
+    }
+    ChromaGradient::combine(chroma, dx, dy);
+    UnionFindCanny::fromGradients(dx, dy, edges, p);
+}
+
+void StreamContext::detect(const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges, const StreamParams& p,
+                           const ChromaPlanes* chroma) {
+    blur.create(gray.rows, gray.cols, CV_8UC1);
+    if (chroma && p.colorEdges && p.detector == EdgeDetectorType::Canny && chroma->valid()) {
+        detectColor(gray, *chroma, blur, edges, p);
+        return;
+    }
+    if (p.engine == ProcessingEngine::FixedPoint) {
+        detectFixedPoint(gray, blur, edges, p);
+        return;
+    }
+    // A band of a larger Mat reads its neighbours' rows at the band border, so tiled
+    // output is identical to blurring the whole frame at once
+    TaskScheduler::instance().parallelFor(0, gray.rows, kBlurTileRows, [&](int begin, int end) {
+        cv::Mat band = blur.rowRange(begin, end);
+        cv::GaussianBlur(gray.rowRange(begin, end), band, cv::Size(p.blurSize, p.blurSize), p.blurSigma);
+    });
+    EdgeDetector::get(p.detector).detect(blur, edges, p);
+}
+
+bool StreamContext::process(const uint8_t* data, int width, int height, int rowStride,
+                            FrameMeta* meta, cv::Mat* edgesOut, FrameDecision* decision) {
+    return process(FrameView::gray(data, width, height, rowStride), meta, edgesOut, decision);
+}
+
+bool StreamContext::process(const FrameView& frame, FrameMeta* meta, cv::Mat* edgesOut, FrameDecision* decision) {
+    if (!frame.valid()) {
+        return false;
+    }
+    const int width = frame.width;
+    const int height = frame.height;
+    std::lock_guard<std::mutex> lock(processMutex);
+    // Read under processMutex, so a frame never runs on params setParams has replaced
+    StreamParams p = params();
+    auto start = std::chrono::steady_clock::now();
+
+    FrameMeta frameMeta = meta ? *meta : FrameMeta();
+    frameMeta.frameId = nextFrameId++;
+    frameMeta.processStartNs = frameClockNs();
+    if (frameMeta.enqueueNs == 0) {
+        frameMeta.enqueueNs = frameMeta.processStartNs;
+    }
+
+    FrameScheduler::Plan plan;
+    cv::Mat output;
+    try {
+        // The Y plane is wrapped without copying when GaussianBlur can read it in place
+        cv::Mat yPlane = frame.luma(ingestBuffer);
+        ChromaPlanes chromaPlanes = frame.chroma();
+        const ChromaPlanes* chroma = chromaPlanes.valid() ? &chromaPlanes : nullptr;
+
+        double ageMs = (frameMeta.processStartNs - frameMeta.originNs()) / 1e6;
+        plan = scheduler.plan(yPlane, ageMs, p.budgetMs);
+        if (decision) {
+            *decision = plan.decision;
+        }
+        if (plan.decision == FrameDecision::Drop) {
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            counters.dropped++;
+            return false;
+        }
+
+        int64_t workStart = frameClockNs();
+        bool fullFrame = false;
+        // Buffers are (re)allocated only when the resolution changes
+        edgesBuffer.create(height, width, CV_8UC1);
+        switch (plan.decision) {
+            case FrameDecision::Pyramid:
+                cv::pyrDown(yPlane, halfGray);
+                detect(halfGray, halfBlur, halfEdges, p);
+                cv::resize(halfEdges, edgesBuffer, edgesBuffer.size(), 0, 0, cv::INTER_NEAREST);
+                break;
+            case FrameDecision::Partial:
+                for (int b = 0; b < FrameScheduler::kBands; b++) {
+                    if (!(plan.changedBands & (1u << b))) {
+                        continue;
+                    }
+                    cv::Range rows = FrameScheduler::bandRows(b, height);
+                    int top = std::max(0, rows.start - kPartialMarginRows);
+                    int bottom = std::min(height, rows.end + kPartialMarginRows);
+                    detect(yPlane.rowRange(top, bottom), bandBlur, bandEdges, p);
+                    bandEdges.rowRange(rows.start - top, rows.end - top).copyTo(edgesBuffer.rowRange(rows));
+                }
+                break;
+            case FrameDecision::Reuse:
+                // Scene unchanged: the previous edge map is still current
+                break;
+            default:
+                fullFrame = true;
+                // Gradients left by the previous frame must not reach the segment stage
+                UnionFindCanny::clearLastGradients();
+                // Colour edges need the chroma planes, which the G-API graph does not take
+                if ((p.engine == ProcessingEngine::Gapi || p.engine == ProcessingEngine::GapiStreaming) &&
+                    p.detector == EdgeDetectorType::Canny && GapiEdgeGraph::available() &&
+                    !(p.colorEdges && chroma)) {
+                    if (!gapiGraph) {
+                        gapiGraph.reset(new GapiEdgeGraph());
+                    }
+                    gapiGraph->apply(yPlane, edgesBuffer, p);
+                    if (p.segments) {
+                        trackSegments(yPlane, frameMeta.frameId);
+                    }
+                } else {
+                    detect(yPlane, blurBuffer, edgesBuffer, p, chroma);
+                    if (p.segments) {
+                        trackSegments(blurBuffer, frameMeta.frameId);
+                    }
+                }
+                break;
+        }
+        frameMeta.processEndNs = frameClockNs();
+        scheduler.complete(plan, (frameMeta.processEndNs - workStart) / 1e6,
+                           (frameMeta.processEndNs - frameMeta.originNs()) / 1e6);
+
+        // Publish packed edge map for the lossless endpoints; the edge stats take their
+        // mean gradient from Canny's gradients when this frame's detector kept them
+        cv::Mat dx;
+        cv::Mat dy;
+        bool gradients = fullFrame && UnionFindCanny::lastGradients(dx, dy);
+        temporal.setFrames(p.stabilizeFrames);
+        uint64_t generation = packed.publish(edgesBuffer, frameMeta, gradients ? &dx : nullptr,
+                                             gradients ? &dy : nullptr, &temporal);
+        output = temporal.enabled() ? temporal.output() : edgesBuffer;
+
+        // Hand off to the shared encode workers when someone is watching
+        if (wantsEncode()) {
+            EncodePool::instance().submit(output, generation, frameMeta, jpeg);
+        }
+    } catch (const cv::Exception& e) {
+        LOGE("Stream %d: OpenCV exception: %s", streamId, e.what());
+        return false;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        counters.avgProcessMs = counters.processed == 0 ? ms : counters.avgProcessMs * 0.9 + ms * 0.1;
+        counters.lastProcessMs = ms;
+        counters.processed++;
+        counters.width = width;
+        counters.height = height;
+    }
+
+    if (meta) {
+        *meta = frameMeta;
+    }
+    if (edgesOut) {
+        *edgesOut = output;
+    }
+    return true;
+}
+
+// Segments are detected on full frames only; degraded frames leave the tracks as they are
+void StreamContext::trackSegments(const cv::Mat& image, uint64_t frameId) {
+    cv::Mat dx;
+    cv::Mat dy;
+    if (!UnionFindCanny::lastGradients(dx, dy) || dx.size() != edgesBuffer.size()) {
+        dx.release();
+        dy.release();
+    }
+    SegmentTiming timing;
+    SegmentDetector::detect(edgesBuffer, dx, dy, image, detectedSegments, &timing);
+
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    if (segmentsSize != edgesBuffer.size()) {
+        segmentTracker.reset();
+        segmentsSize = edgesBuffer.size();
+    }
+    segmentTracker.update(detectedSegments, frameId);
+    timing.trackMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    segmentTiming = timing;
+}
+
+std::string StreamContext::segmentsJson() const {
+    if (!params().segments) {
+        return std::string();
+    }
+    std::lock_guard<std::mutex> lock(segmentsMutex);
+    return segmentTracker.toJson(segmentsSize.width, segmentsSize.height, segmentTiming);
+}
+
+std::string StreamContext::edgeStatsJson() const {
+    EdgeFrameStats stats;
+    if (!packed.latestStats(stats)) {
+        return std::string();
+    }
+    return stats.toJson();
+}
+
+uint64_t StreamContext::publishExternal(const cv::Mat& edges, FrameMeta& meta, cv::Mat* stabilizedOut) {
+    uint64_t generation;
+    {
+        // Serialized with process(): both feed the same temporal filter
+        std::lock_guard<std::mutex> lock(processMutex);
+        meta.frameId = nextFrameId++;
+        temporal.setFrames(params().stabilizeFrames);
+        generation = packed.publish(edges, meta, nullptr, nullptr, &temporal);
+        if (stabilizedOut) {
+            // The filter output is overwritten by the next frame, so the caller gets a copy
+            if (temporal.enabled()) {
+                temporal.output().copyTo(*stabilizedOut);
+            } else {
+                stabilizedOut->release();
+            }
+        }
+    }
+    double ms = (meta.processEndNs - meta.processStartNs) / 1e6;
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    externalGeneration = generation;
+    counters.avgProcessMs = counters.processed == 0 ? ms : counters.avgProcessMs * 0.9 + ms * 0.1;
+    counters.lastProcessMs = ms;
+    counters.processed++;
+    counters.width = edges.cols;
+    counters.height = edges.rows;
+    return generation;
+}
+
+void StreamContext::encodeExternal(const cv::Mat& edges, const FrameMeta& meta) {
+    if (!wantsEncode()) {
+        return;
+    }
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        generation = externalGeneration;
+    }
+    // With stabilization on, viewers get the last published (stabilized) map instead
+    std::lock_guard<std::mutex> lock(processMutex);
+    bool stabilized = temporal.enabled() && temporal.output().size() == edges.size();
+    EncodePool::instance().submit(stabilized ? temporal.output() : edges, generation, meta, jpeg);
+}
+
+// Whether an edge map detected with `a` may be reused or patched under `b`
+static bool sameDetection(const StreamParams& a, const StreamParams& b) {
+    return a.lowThreshold == b.lowThreshold && a.highThreshold == b.highThreshold && a.blurSize == b.blurSize &&
+           a.blurSigma == b.blurSigma && a.cannyAperture == b.cannyAperture && a.cannyL2 == b.cannyL2 &&
+           a.hysteresis == b.hysteresis && a.colorEdges == b.colorEdges && a.engine == b.engine &&
+           a.detector == b.detector;
+}
+
+void StreamContext::setParams(const StreamParams& params) {
+    packed.setStatsGrid(params.statsGridCols, params.statsGridRows);
+    StreamParams previous;
+    {
+        std::lock_guard<std::mutex> lock(paramsMutex);
+        previous = currentParams;
+        currentParams = params;
+    }
+    if (!sameDetection(previous, params)) {
+        scheduler.invalidate();
+    }
+    if (previous.segments && !params.segments) {
+        // Drop the segment state once the running frame is done; turning the stage
+        // back on starts from fresh tracks
+        std::lock_guard<std::mutex> lock(processMutex);
+        std::vector<LineSegment>().swap(detectedSegments);
+        std::lock_guard<std::mutex> segmentsLock(segmentsMutex);
+        segmentTracker.reset();
+        segmentTiming = SegmentTiming();
+        segmentsSize = cv::Size();
+    }
+}
+
+StreamParams StreamContext::params() const {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    return currentParams;
+}
+
+StreamStats StreamContext::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
+
+std::string StreamContext::statsJson() const {
+    StreamStats s = stats();
+    StreamParams p = params();
+    char buf[640];
+    snprintf(buf, sizeof(buf),
+             "{\"id\":%d,\"width\":%d,\"height\":%d,\"submitted\":%llu,\"processed\":%llu,"
+             "\"dropped\":%llu,\"lastProcessMs\":%.2f,\"avgProcessMs\":%.2f,"
+             "\"lowThreshold\":%.1f,\"highThreshold\":%.1f,\"engine\":\"%s\",\"detector\":\"%s\",\"hysteresis\":\"%s\","
+             "\"contourEpsilon\":%.2f,\"segments\":%s,\"stabilize\":%d,\"colorEdges\":%s,\"encoding\":%s}",
+             streamId, s.width, s.height,
+             (unsigned long long)s.submitted, (unsigned long long)s.processed, (unsigned long long)s.dropped,
+             s.lastProcessMs, s.avgProcessMs, p.lowThreshold, p.highThreshold, processingEngineName(p.engine),
+             edgeDetectorName(p.detector), hysteresisEngineName(p.hysteresis), p.contourEpsilon,
+             p.segments ? "true" : "false", p.stabilizeFrames, p.colorEdges ? "true" : "false",
+             wantsEncode() ? "true" : "false");
+    // Capture-to-server latency histograms
+    std::string json(buf);
+    json.pop_back();
+    json += ",\"latency\":{\"published\":" + packed.latency().toJson() +
+            ",\"encoded\":" + jpeg->latency().toJson() + "}";
+    json += ",\"scheduler\":" + scheduler.statsJson();
+    std::string edges = edgeStatsJson();
+    if (!edges.empty()) {
+        json += ",\"edges\":" + edges;
+    }
+    json += "}";
+    return json;
+}
+
+void StreamContext::setSubscribed(bool value) {
+    subscribed.store(value, std::memory_order_relaxed);
+}
+
+void StreamContext::touchViewer() {
+    lastViewerPollMs.store(nowMs(), std::memory_order_relaxed);
+}
+
+bool StreamContext::wantsEncode() const {
+    return subscribed.load(std::memory_order_relaxed) ||
+           nowMs() - lastViewerPollMs.load(std::memory_order_relaxed) < kViewerTimeoutMs;
+}
+
+StreamRegistry& StreamRegistry::instance() {
+    static StreamRegistry registry;
+    return registry;
+}
+
+StreamRegistry::StreamRegistry(int workerCount) : requestedWorkers(workerCount) {}
+
+StreamRegistry::~StreamRegistry() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+std::shared_ptr<StreamContext> StreamRegistry::getOrCreate(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = streams.find(id);
+    if (it != streams.end()) {
+        return it->second;
+    }
+    auto context = std::make_shared<StreamContext>(id);
+    streams[id] = context;
+    LOGI("Created stream %d", id);
+    EncodePool::instance().setStreamCount(static_cast<int>(streams.size()));
+    return context;
+}
+
+std::shared_ptr<StreamContext> StreamRegistry::find(int id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = streams.find(id);
+    return it != streams.end() ? it->second : nullptr;
+}
+
+bool StreamRegistry::remove(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Workers hold their own reference, so an in-flight frame finishes safely
+    bool removed = streams.erase(id) > 0;
+    if (removed) {
+        LOGI("Removed stream %d", id);
+    }
+    return removed;
+}
+
+std::vector<int> StreamRegistry::ids() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<int> result;
+    for (const auto& entry : streams) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+void StreamRegistry::startWorkers() {
+    // Called with the mutex held
+    int count = requestedWorkers;
+    if (count <= 0) {
+        count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back(&StreamRegistry::workerLoop, this);
+    }
+    LOGI("Started %d shared stream worker(s)", count);
+}
+
+bool StreamRegistry::submit(int id, const uint8_t* data, int width, int height, int rowStride,
+                            int64_t sensorTimestampNs) {
+    if (!data || width <= 0 || height <= 0 || rowStride < width) {
+        return false;
+    }
+    std::shared_ptr<StreamContext> context = getOrCreate(id);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return false;
+        }
+        if (workers.empty()) {
+            startWorkers();
+        }
+        submitting++;
+    }
+
+    // Copy rows into the input slot under the stream's own lock, dropping any frame that
+    // has not started processing; other streams submit and dequeue meanwhile
+    {
+        std::lock_guard<std::mutex> slotLock(context->slotMutex);
+        std::vector<uint8_t>& slot = context->pendingFrame;
+        slot.resize(static_cast<size_t>(width) * height);
+        if (rowStride == width) {
+            memcpy(slot.data(), data, slot.size());
+        } else {
+            for (int y = 0; y < height; y++) {
+                memcpy(slot.data() + static_cast<size_t>(y) * width, data + static_cast<size_t>(y) * rowStride,
+                       width);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> statsLock(context->statsMutex);
+            context->counters.submitted++;
+            if (context->hasPending) {
+                context->counters.dropped++;
+            }
+        }
+        context->pendingWidth = width;
+        context->pendingHeight = height;
+        context->pendingMeta = FrameMeta();
+        context->pendingMeta.sensorTimestampNs = sensorTimestampNs;
+        context->pendingMeta.enqueueNs = frameClockNs();
+        context->hasPending = true;
+    }
+
+    // A stream is queued at most once so its frames are processed in order by one worker
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitting--;
+        if (!context->scheduled && !stopping) {
+            context->scheduled = true;
+            ready.push_back(context);
+            queued = true;
+        }
+    }
+    if (queued) {
+        workAvailable.notify_one();
+    } else {
+        idle.notify_all();
+    }
+    return true;
+}
+
+void StreamRegistry::workerLoop() {
+    ThreadPlacement::Scope placement(ThreadRole::Latency);
+    while (true) {
+        std::shared_ptr<StreamContext> context;
+        int width = 0;
+        int height = 0;
+        FrameMeta meta;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (stopping) {
+                return;
+            }
+            context = ready.front();
+            ready.pop_front();
+            busyWorkers++;
+        }
+
+        bool taken = false;
+        {
+            std::lock_guard<std::mutex> slotLock(context->slotMutex);
+            if (context->hasPending) {
+                context->workingFrame.swap(context->pendingFrame);
+                width = context->pendingWidth;
+                height = context->pendingHeight;
+                meta = context->pendingMeta;
+                context->hasPending = false;
+                taken = true;
+            }
+        }
+        if (taken) {
+            context->process(context->workingFrame.data(), width, height, width, &meta);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+            bool pending;
+            {
+                std::lock_guard<std::mutex> slotLock(context->slotMutex);
+                pending = context->hasPending;
+            }
+            if (pending) {
+                // A newer frame arrived while processing; requeue behind other streams
+                ready.push_back(context);
+            } else {
+                context->scheduled = false;
+            }
+        }
+        workAvailable.notify_one();
+        idle.notify_all();
+    }
+}
+
+void StreamRegistry::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return ready.empty() && busyWorkers == 0 && submitting == 0; });
+}
@@ -0,0 +1,236 @@
+#ifndef STREAM_REGISTRY_H
+#define STREAM_REGISTRY_H
+
+#include "edge_detector.h"
+#include "edge_encoder.h"
+#include "encode_pool.h"
+#include "frame_scheduler.h"
+#include "frame_view.h"
+#include "segment_tracker.h"
+#include "union_find_canny.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GapiEdgeGraph;
+
+// How a stream runs blur + edge detection on full frames
+enum class ProcessingEngine {
+    Imperative,  // one OpenCV call per stage, blur tiled on the task scheduler
+    Gapi,        // G-API graph compiled per resolution on the Fluid backend
+    // G-API streaming graph, pipelined across frames behind the async submit API;
+    // synchronous callers run it as Gapi. Streamed frames skip process(): with a
+    // latency budget, segments or colorEdges set, frames run through process() as
+    // Gapi instead, and streamed frames carry no meanGradient in their edge stats.
+    GapiStreaming,
+    // Fused integer blur + Sobel (bit-exact with the imperative path); Canny starts
+    // from its gradients
+    FixedPoint,
+};
+
+const char* processingEngineName(ProcessingEngine engine);
+bool parseProcessingEngine(const std::string& name, ProcessingEngine& engine);
+
+struct StreamParams {
+    double lowThreshold = 30.0;
+    double highThreshold = 80.0;
+    int blurSize = 5;
+    double blurSigma = 1.4;
+    // Canny's Sobel aperture (3, 5 or 7) and L2 instead of L1 gradient magnitude
+    int cannyAperture = 3;
+    bool cannyL2 = false;
+    // Canny's weak-edge linking; identical output either way
+    HysteresisEngine hysteresis = HysteresisEngine::OpenCV;
+    // approxPolyDP tolerance in pixels for the contour output; <= 0 keeps every pixel
+    double contourEpsilon = 1.0;
+    // Line segment detection and tracking after full-frame detection
+    bool segments = false;
+    // Colour-aware Canny: chroma gradients join luma's wherever frames come with their
+    // U/V planes (full-resolution frames of the camera's async path)
+    bool colorEdges = false;
+    // Temporal stabilization: frames an edge must persist for before it is output;
+    // 0 outputs every frame's edges as detected
+    int stabilizeFrames = 0;
+    // Grid of per-cell edge densities in the per-frame edge stats
+    int statsGridCols = 8;
+    int statsGridRows = 8;
+    // Capture-to-output latency budget; <= 0 processes every frame in full
+    double budgetMs = 0.0;
+    ProcessingEngine engine = ProcessingEngine::Imperative;
+    // The G-API engines only implement Canny; other detectors run imperatively
+    EdgeDetectorType detector = EdgeDetectorType::Canny;
+};
+
+struct StreamStats {
+    uint64_t submitted = 0;
+    uint64_t processed = 0;
+    uint64_t dropped = 0;
+    double lastProcessMs = 0.0;
+    double avgProcessMs = 0.0;
+    int width = 0;
+    int height = 0;
+};
+
+// Processing context of one source: its own parameters, buffers, stats and frame caches.
+// A context processes one frame at a time; different contexts run concurrently.
+class StreamContext {
+public:
+    explicit StreamContext(int id);
+    ~StreamContext();
+
+    int id() const { return streamId; }
+
+    // Blur + edge detector shared by every processing path. The blur runs as row-band
+    // tiles on the shared TaskScheduler; `blur` and `edges` are reused across calls.
+    // With `chroma` (the frame's U/V planes) and colorEdges on, Canny also sees colour edges.
+    static void detect(const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges, const StreamParams& params,
+                       const ChromaPlanes* chroma = nullptr);
+
+    // Detect edges in a frame of any layout. Luma the blur can read in place is not
+    // copied; the U/V planes of YUV frames feed colorEdges on full-resolution frames.
+    // `meta` (optional) carries capture/enqueue times in and receives the frame id and
+    // processing times. `edgesOut` (optional) receives a view of the (stabilized, when
+    // enabled) edge map that stays valid until the next call on this context.
+    // With a latency budget the frame scheduler may degrade or drop the frame;
+    // `decision` (optional) receives its choice and a dropped frame returns false.
+    bool process(const FrameView& frame, FrameMeta* meta = nullptr, cv::Mat* edgesOut = nullptr,
+                 FrameDecision* decision = nullptr);
+    // Same for a pixel-contiguous Y plane
+    bool process(const uint8_t* data, int width, int height, int rowStride,
+                 FrameMeta* meta = nullptr, cv::Mat* edgesOut = nullptr,
+                 FrameDecision* decision = nullptr);
+
+    // Entry points for engines that produce edge maps outside process() (G-API
+    // streaming): assign the frame id, publish to the packed cache and count the
+    // frame; then queue an edge map for encoding when someone is watching. Both apply
+    // stabilizeFrames like process(); `stabilizedOut` (optional) receives a copy of the
+    // stabilized map, or is released when stabilization is off.
+    uint64_t publishExternal(const cv::Mat& edges, FrameMeta& meta, cv::Mat* stabilizedOut = nullptr);
+    void encodeExternal(const cv::Mat& edges, const FrameMeta& meta);
+
+    void setParams(const StreamParams& params);
+    StreamParams params() const;
+    StreamStats stats() const;
+    FrameScheduler::Stats schedulerStats() const { return scheduler.stats(); }
+    std::string statsJson() const;
+    // Tracked line segments as JSON (SegmentTracker::toJson); empty while the segment
+    // stage is off
+    std::string segmentsJson() const;
+    // Statistics of the latest published edge map (EdgeFrameStats::toJson); empty
+    // before the first frame
+    std::string edgeStatsJson() const;
+
+    // Encoding runs only while someone is subscribed or polled recently
+    void setSubscribed(bool subscribed);
+    void touchViewer();
+    bool wantsEncode() const;
+
+    PackedFrameCache& packedCache() { return packed; }
+    EncodedFrameCache& jpegCache() { return *jpeg; }
+
+private:
+    friend class StreamRegistry;
+
+    const int streamId;
+    mutable std::mutex paramsMutex;
+    StreamParams currentParams;
+
+    // Serializes processing; buffers are reused across frames
+    std::mutex processMutex;
+    cv::Mat blurBuffer;
+    cv::Mat edgesBuffer;
+    // Luma of frames that cannot be read in place (packed colour, strided samples)
+    cv::Mat ingestBuffer;
+    FrameScheduler scheduler;
+    // Scratch for the degraded (half-resolution / partial) paths
+    cv::Mat halfGray;
+    cv::Mat halfBlur;
+    cv::Mat halfEdges;
+    cv::Mat bandBlur;
+    cv::Mat bandEdges;
+    // Created on first use of the G-API engine
+    std::unique_ptr<GapiEdgeGraph> gapiGraph;
+    // Stabilizes edgesBuffer into the output while it is published; edgesBuffer
+    // itself stays the raw detection the scheduler's reuse and partial paths build on
+    TemporalFilter temporal;
+
+    // Segment stage; `image` is what the edges were detected on
+    void trackSegments(const cv::Mat& image, uint64_t frameId);
+    std::vector<LineSegment> detectedSegments;
+    mutable std::mutex segmentsMutex;
+    SegmentTracker segmentTracker;
+    SegmentTiming segmentTiming;
+    cv::Size segmentsSize;
+
+    mutable std::mutex statsMutex;
+    StreamStats counters;
+    uint64_t nextFrameId = 1;
+    // Packed generation of the newest externally published frame
+    uint64_t externalGeneration = 0;
+
+    std::atomic<bool> subscribed{false};
+    std::atomic<int64_t> lastViewerPollMs{0};
+
+    PackedFrameCache packed;
+    // Shared with queued encode jobs, which may finish after the stream is removed
+    std::shared_ptr<EncodedFrameCache> jpeg = std::make_shared<EncodedFrameCache>();
+
+    // Latest-frame-wins input slot used by StreamRegistry::submit. The slot has its own
+    // lock so a frame copy never holds up other streams; `scheduled` is the registry's.
+    std::mutex slotMutex;
+    std::vector<uint8_t> pendingFrame;
+    int pendingWidth = 0;
+    int pendingHeight = 0;
+    FrameMeta pendingMeta;
+    bool hasPending = false;
+    std::vector<uint8_t> workingFrame;
+    bool scheduled = false;
+};
+
+// Registry of concurrent streams sharing one detection worker pool and the encode pool.
+class StreamRegistry {
+public:
+    static StreamRegistry& instance();
+
+    explicit StreamRegistry(int workers = 0);
+    ~StreamRegistry();
+
+    std::shared_ptr<StreamContext> getOrCreate(int id);
+    std::shared_ptr<StreamContext> find(int id) const;
+    bool remove(int id);
+    std::vector<int> ids() const;
+
+    // Copy a Y plane into the stream's input slot and schedule it on the shared workers.
+    // A frame still waiting in the slot is replaced (and counted as dropped).
+    bool submit(int id, const uint8_t* data, int width, int height, int rowStride,
+                int64_t sensorTimestampNs = 0);
+
+    // Wait until no submitted frame is pending or being processed
+    void drain();
+    int workerCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    void startWorkers();
+    void workerLoop();
+
+    int requestedWorkers;
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::map<int, std::shared_ptr<StreamContext>> streams;
+    std::deque<std::shared_ptr<StreamContext>> ready;
+    int busyWorkers = 0;
+    // Submits copying into a slot outside the registry lock
+    int submitting = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+
+#endif // STREAM_REGISTRY_H
@@ -0,0 +1,41 @@
+#ifndef SYNTHETIC_SOURCE_H
+#define SYNTHETIC_SOURCE_H
+
+#include <opencv2/opencv.hpp>
+
+// Deterministic synthetic camera for host benchmarks and test rigs:
+// moving shapes over a gradient plus sensor-like noise, as an 8-bit Y plane.
+class SyntheticSource {
+public:
+    SyntheticSource(int width, int height, int seed = 0)
+        : width(width), height(height), seed(seed), rng(static_cast<uint64_t>(seed) + 1) {}
+
+    int frameWidth() const { return width; }
+    int frameHeight() const { return height; }
+
+    void render(cv::Mat& frame, int index) {
+        frame.create(height, width, CV_8UC1);
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = frame.ptr<uint8_t>(y);
+            for (int x = 0; x < width; x++) {
+                row[x] = static_cast<uint8_t>((x + y + index + seed * 17) & 0x7F);
+            }
+        }
+        int shift = (index * 7 + seed * 31) % (width / 6 + 1);
+        cv::rectangle(frame, cv::Rect(width / 12 + shift, height / 7, width / 4, height / 4), cv::Scalar(220), cv::FILLED);
+        cv::circle(frame, cv::Point(width * 5 / 8 - shift, height * 5 / 9), height / 5, cv::Scalar(30), cv::FILLED);
+        cv::line(frame, cv::Point(0, height * 9 / 10), cv::Point(width, height * 5 / 6 - shift), cv::Scalar(255), 3);
+        noise.create(height, width, CV_8UC1);
+        rng.fill(noise, cv::RNG::UNIFORM, 0, 12);
+        frame += noise;
+    }
+
+private:
+    int width;
+    int height;
+    int seed;
+    cv::RNG rng;
+    cv::Mat noise;
+};
+
+#endif // SYNTHETIC_SOURCE_H
@@ -0,0 +1,238 @@
+#include "task_scheduler.h"
+#include "cpu_topology.h"
+#include "edge_log.h"
+#include <algorithm>
+
+#define LOG_TAG "TaskScheduler"
+#define LOGI(...) EDGE_LOGI(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) EDGE_LOGE(LOG_TAG, __VA_ARGS__)
+
+// Worker index of the current thread within its scheduler, -1 for other threads
+static thread_local const TaskScheduler* currentScheduler = nullptr;
+static thread_local int currentWorker = -1;
+
+// Idle rounds a waiter spins (yielding) before it blocks on its group
+static const int kSpinRounds = 64;
+
+static uint32_t nextRandom() {
+    // xorshift32, seeded per thread
+    static thread_local uint32_t state =
+        static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+TaskScheduler::TaskScheduler(int count) {
+    if (count <= 0) {
+        // Workers run as latency threads, so size from the cores those may use (the
+        // performance cores under Split) rather than every core in the system
+        std::vector<int> cpus = ThreadPlacement::instance().cpusFor(ThreadRole::Latency);
+        int cores = cpus.empty() ? static_cast<int>(std::thread::hardware_concurrency())
+                                 : static_cast<int>(cpus.size());
+        count = std::max(1, cores - 1);
+    }
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < count; i++) {
+        threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+    LOGI("Started %d task worker(s)", count);
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (auto& t : threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+void TaskScheduler::spawn(TaskGroup& group, std::function<void()> run) {
+    if (group.pending.fetch_add(1, std::memory_order_relaxed) == 0) {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        group.finished = false;
+    }
+    spawned.fetch_add(1, std::memory_order_relaxed);
+
+    // Workers push to their own deque; other threads spread tasks round-robin
+    int index = currentScheduler == this ? currentWorker
+                                         : static_cast<int>(nextExternal.fetch_add(1) % workers.size());
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(Task{std::move(run), &group});
+    }
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+bool TaskScheduler::popLocal(int index, Task& task) {
+    Worker& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    // LIFO for the owner: the most recently split tile is still hot in cache
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool TaskScheduler::steal(Task& task, bool block) {
+    int count = static_cast<int>(workers.size());
+    int start = static_cast<int>(nextRandom() % count);
+    for (int i = 0; i < count; i++) {
+        int victim = (start + i) % count;
+        if (victim == currentWorker && currentScheduler == this) {
+            continue;
+        }
+        Worker& worker = *workers[victim];
+        std::unique_lock<std::mutex> lock(worker.mutex, std::defer_lock);
+        if (block) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            continue;
+        }
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        // FIFO for thieves: the oldest task is usually the largest remaining piece
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::findTask(Task& task, bool block) {
+    if (currentScheduler == this && popLocal(currentWorker, task)) {
+        return true;
+    }
+    return queued.load(std::memory_order_relaxed) > 0 && steal(task, block);
+}
+
+void TaskScheduler::execute(Task& task) {
+    try {
+        task.run();
+    } catch (...) {
+        // Recorded before the group counts down, so wait() always sees it
+        std::lock_guard<std::mutex> lock(task.group->mutex);
+        if (!task.group->error) {
+            task.group->error = std::current_exception();
+        }
+    }
+    executed.fetch_add(1, std::memory_order_relaxed);
+    TaskGroup& group = *task.group;
+    if (group.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Last task: the group may be destroyed as soon as the waiter sees `finished`
+        std::lock_guard<std::mutex> lock(group.mutex);
+        group.finished = true;
+        group.finishedCv.notify_all();
+    }
+}
+
+void TaskScheduler::workerLoop(int index) {
+    ThreadPlacement::Scope placement(ThreadRole::Latency);
+    currentScheduler = this;
+    currentWorker = index;
+    Task task;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        // The blocking pass catches tasks in deques the try_lock pass skipped, so a
+        // worker never sleeps while a task is queued
+        if (findTask(task) || findTask(task, true)) {
+            execute(task);
+            continue;
+        }
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] {
+                return stopping.load() || queued.load(std::memory_order_seq_cst) > 0;
+            });
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void TaskScheduler::wait(TaskGroup& group) {
+    Task task;
+    int idleRounds = 0;
+    while (!group.done()) {
+        if (findTask(task) || (idleRounds >= kSpinRounds && findTask(task, true))) {
+            execute(task);
+            helped.fetch_add(1, std::memory_order_relaxed);
+            idleRounds = 0;
+        } else if (++idleRounds < kSpinRounds) {
+            std::this_thread::yield();
+        } else {
+            // Nothing left to run: the remaining tasks are running on other threads
+            break;
+        }
+    }
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.finishedCv.wait(lock, [&group] { return group.finished; });
+        error.swap(group.error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskScheduler::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    grain = std::max(1, grain);
+    if (end - begin <= grain) {
+        body(begin, end);
+        return;
+    }
+    TaskGroup group;
+    // The caller runs the first chunk itself
+    for (int start = begin + grain; start < end; start += grain) {
+        int stop = std::min(end, start + grain);
+        spawn(group, [&body, start, stop] { body(start, stop); });
+    }
+    try {
+        body(begin, std::min(end, begin + grain));
+    } catch (...) {
+        // Spawned chunks reference `body`; let them finish before unwinding. The
+        // caller's own exception wins over any of theirs.
+        try {
+            wait(group);
+        } catch (...) {
+        }
+        throw;
+    }
+    wait(group);
+}
+
+TaskScheduler::Stats TaskScheduler::stats() const {
+    Stats s;
+    s.workers = workerCount();
+    s.spawned = spawned.load(std::memory_order_relaxed);
+    s.executed = executed.load(std::memory_order_relaxed);
+    s.stolen = stolen.load(std::memory_order_relaxed);
+    s.helped = helped.load(std::memory_order_relaxed);
+    return s;
+}
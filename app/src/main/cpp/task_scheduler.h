@@ -0,0 +1,110 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Completion counter for a set of spawned tasks; the first exception a task throws
+// is kept and rethrown by TaskScheduler::wait. A group may take new tasks once
+// wait() has returned.
+class TaskGroup {
+public:
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskScheduler;
+    std::atomic<int> pending{0};
+    // Guards `finished` and `error`
+    std::mutex mutex;
+    // Set by the thread that finishes the last task, so wait() never returns while
+    // that thread still touches the group
+    bool finished = true;
+    std::condition_variable finishedCv;
+    std::exception_ptr error;
+};
+
+// Work-stealing scheduler for short tile jobs shared by every processing context.
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back, idle
+// workers steal from the front of a randomly chosen victim. Threads that wait on a
+// TaskGroup (workers or not) run queued tasks while they wait, so nested and
+// concurrent fork/join from several streams never idles a core at a join barrier
+// and the worker count stays fixed. Once nothing is left to run they block on the
+// group until its last task finishes; idle workers block until a task is spawned.
+class TaskScheduler {
+public:
+    struct Stats {
+        int workers = 0;
+        uint64_t spawned = 0;
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+        // Tasks run by a thread while it waited on a group
+        uint64_t helped = 0;
+    };
+
+    // workers <= 0: one per core latency threads may run on (all cores with placement off)
+    // minus one, since the waiting caller helps
+    explicit TaskScheduler(int workers = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Process-wide scheduler used by the stream contexts
+    static TaskScheduler& instance();
+
+    void spawn(TaskGroup& group, std::function<void()> task);
+    // Run queued tasks until every task of the group has finished, then rethrow the
+    // first exception one of them threw
+    void wait(TaskGroup& group);
+
+    // Split [begin, end) into chunks of `grain` and run them in parallel; returns when all finished
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    int workerCount() const { return static_cast<int>(threads.size()); }
+    Stats stats() const;
+
+private:
+    struct Task {
+        std::function<void()> run;
+        TaskGroup* group = nullptr;
+    };
+
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal(int index, Task& task);
+    // `block`: wait for busy deques instead of skipping them
+    bool steal(Task& task, bool block);
+    bool findTask(Task& task, bool block = false);
+    void execute(Task& task);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Tasks sitting in any deque; idle workers sleep while it is zero
+    std::atomic<int> queued{0};
+    std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint32_t> nextExternal{0};
+
+    std::atomic<uint64_t> spawned{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<uint64_t> helped{0};
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,56 @@
+#include "temporal_filter.h"
+#include <algorithm>
+
+namespace {
+
+// State byte: score in the low six bits, last raw edge bit, emitted bit
+const uint8_t kScoreMask = 0x3F;
+const uint8_t kRawBit = 0x40;
+const uint8_t kOnBit = 0x80;
+
+}  // namespace
+
+void TemporalFilter::setFrames(int frames) {
+    frames = std::max(0, std::min(frames, kMaxFrames));
+    if (frames != persistFrames) {
+        persistFrames = frames;
+        reset();
+    }
+}
+
+void TemporalFilter::reset() {
+    state.release();
+    stabilized.release();
+    fresh = true;
+}
+
+void TemporalFilter::begin(int width, int height) {
+    if (state.cols != width || state.rows != height) {
+        state.create(height, width, CV_8UC1);
+        state.setTo(0);
+        stabilized.create(height, width, CV_8UC1);
+        fresh = true;
+    } else {
+        fresh = false;
+    }
+    toggles = 0;
+}
+
+void TemporalFilter::filterRow(int y, const uint8_t* raw) {
+    uint8_t* s = state.ptr<uint8_t>(y);
+    uint8_t* out = stabilized.ptr<uint8_t>(y);
+    const uint8_t top = static_cast<uint8_t>(persistFrames);
+    int changed = 0;
+    // Branch-free select so the compiler can vectorize the row
+    for (int x = 0; x < state.cols; x++) {
+        uint8_t v = s[x];
+        uint8_t edge = raw[x] != 0;
+        uint8_t score = v & kScoreMask;
+        score = edge ? static_cast<uint8_t>(score + (score < top)) : static_cast<uint8_t>(score - (score > 0));
+        uint8_t on = score >= top ? kOnBit : (score == 0 ? 0 : (v & kOnBit));
+        changed += ((v & kRawBit) != 0) != edge;
+        s[x] = static_cast<uint8_t>(score | (edge ? kRawBit : 0) | on);
+        out[x] = on ? 255 : 0;
+    }
+    toggles += changed;
+}
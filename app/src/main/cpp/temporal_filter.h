@@ -0,0 +1,42 @@
+#ifndef TEMPORAL_FILTER_H
+#define TEMPORAL_FILTER_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+// Temporal hysteresis on a stream of edge maps, against Canny flicker at marginal
+// edges. Every pixel keeps one state byte: a score saturating at `frames`, raised
+// by each frame the pixel is an edge and lowered by each frame it is not. A pixel
+// is emitted once its score reaches `frames` and stays emitted until the score
+// drains to zero, so an edge appears after persisting that many frames and an
+// emitted edge survives a dropout of one frame less.
+class TemporalFilter {
+public:
+    static constexpr int kMaxFrames = 63;
+
+    // 0 or 1 passes edges through; a change restarts from an empty state
+    void setFrames(int frames);
+    int frames() const { return persistFrames; }
+    bool enabled() const { return persistFrames > 1; }
+    void reset();
+
+    // Start a frame; the state restarts when the geometry changes
+    void begin(int width, int height);
+    // Stabilize row y of the raw edge map into row y of output()
+    void filterRow(int y, const uint8_t* raw);
+    // Stabilized edge map (0 / 255) of the last frame; valid until the next begin()
+    const cv::Mat& output() const { return stabilized; }
+
+    // Pixels whose raw edge state changed since the previous frame; -1 on a frame
+    // the state restarted
+    int64_t rawToggles() const { return fresh ? -1 : toggles; }
+
+private:
+    int persistFrames = 0;
+    cv::Mat state;
+    cv::Mat stabilized;
+    int64_t toggles = 0;
+    bool fresh = true;
+};
+
+#endif // TEMPORAL_FILTER_H
@@ -0,0 +1,1295 @@
+// Host benchmark for the native processing core.
+//
+// Build on Linux with a system OpenCV:
+//   cmake -S app/src/main/cpp -B build-host && cmake --build build-host
+//   ./build-host/edge_bench <mode> [frames]
+
+#include "async_processor.h"
+#include "batch_processor.h"
+#include "buffer_pool.h"
+#include "contour_encoder.h"
+#include "cpu_topology.h"
+#include "edge_detector.h"
+#include "edge_encoder.h"
+#include "encode_pool.h"
+#include "fixed_point_filter.h"
+#include "frame_pipeline.h"
+#include "frame_scheduler.h"
+#include "frame_view.h"
+#include "gapi_backend.h"
+#include "gapi_streaming.h"
+#include "pipeline_variants.h"
+#include "segment_tracker.h"
+#include "stream_registry.h"
+#include "synthetic_source.h"
+#include "task_scheduler.h"
+#include "union_find_canny.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static const int kWidth = 1280;
+static const int kHeight = 720;
+
+static std::vector<cv::Mat> makeFrames(int count, int seed = 0) {
+    SyntheticSource source(kWidth, kHeight, seed);
+    std::vector<cv::Mat> frames(count);
+    for (int i = 0; i < count; i++) {
+        source.render(frames[i], i);
+    }
+    return frames;
+}
+
+static void detect(const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges) {
+    cv::GaussianBlur(gray, blur, cv::Size(5, 5), 1.4);
+    cv::Canny(blur, edges, 30.0, 80.0);
+}
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void report(const char* name, int frames, double ms) {
+    printf("%-28s %6d frames %9.1f ms %8.2f ms/frame %8.1f fps\n",
+           name, frames, ms, ms / frames, frames * 1000.0 / ms);
+}
+
+// Inline encode (previous design) vs. detection overlapped with the encode workers;
+// pipelined rows report the frames actually encoded, not those submitted
+static void benchEncode(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    cv::Mat blur, edges;
+    std::vector<uint8_t> jpeg;
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, 70};
+
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        detect(inputs[i % inputs.size()], blur, edges);
+        cv::imencode(".jpg", edges, jpeg, params);
+    }
+    report("serial detect+encode", frames, elapsedMs(start));
+
+    for (int workers = 1; workers <= 2; workers++) {
+        EncodePool::Config config;
+        config.workers = workers;
+        EncodePool pool(config);
+        auto cache = std::make_shared<EncodedFrameCache>();
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            detect(inputs[i % inputs.size()], blur, edges);
+            pool.submit(edges, static_cast<uint64_t>(i + 1), FrameMeta(), cache);
+        }
+        pool.drain();
+        double ms = elapsedMs(start);
+        // The queue drops the oldest frame when full, so only encoded frames count
+        EncodePool::Stats s = pool.stats();
+        std::string name = "pipelined, " + std::to_string(workers) + " encode worker(s)";
+        report(name.c_str(), static_cast<int>(std::max<uint64_t>(1, s.encoded)), ms);
+        printf("%-28s submitted=%d encoded=%llu dropped=%llu avgEncode=%.2f ms\n", "", frames,
+               (unsigned long long)s.encoded, (unsigned long long)s.dropped, s.avgEncodeMs);
+    }
+
+    EncodePool pool(EncodePool::Config{});
+    pool.setEnabled(false);
+    auto cache = std::make_shared<EncodedFrameCache>();
+    start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        detect(inputs[i % inputs.size()], blur, edges);
+        pool.submit(edges, static_cast<uint64_t>(i + 1), FrameMeta(), cache);
+    }
+    report("no viewer (encode skipped)", frames, elapsedMs(start));
+}
+
+// Lossless 1-bit formats vs. the JPEG stream on the same edge maps: bytes and encode
+// time per frame for JPEG quality 70, the packed bitmap and 1-bit PNG at a few deflate
+// levels. Packed and PNG times include packing the edge map.
+static void benchLossless(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const int count = static_cast<int>(inputs.size());
+    cv::Mat blur;
+    std::vector<cv::Mat> edges(count);
+    for (int i = 0; i < count; i++) {
+        detect(inputs[i], blur, edges[i]);
+    }
+
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> packed;
+    for (int format = 0; format < 5; format++) {
+        const int pngLevels[] = {0, 0, 1, 6, 9};
+        double bytes = 0;
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            const cv::Mat& map = edges[i % count];
+            if (format == 0) {
+                cv::imencode(".jpg", map, out, {cv::IMWRITE_JPEG_QUALITY, 70});
+                bytes += out.size();
+            } else {
+                EdgeEncoder::packBits(map, packed);
+                if (format == 1) {
+                    bytes += packed.size();
+                } else {
+                    EdgeEncoder::encodePng1bpp(packed.data(), kWidth, kHeight, out, pngLevels[format]);
+                    bytes += out.size();
+                }
+            }
+        }
+        double ms = elapsedMs(start);
+        char name[64];
+        if (format == 0) {
+            snprintf(name, sizeof(name), "jpeg q70");
+        } else if (format == 1) {
+            snprintf(name, sizeof(name), "packed 1 bpp");
+        } else {
+            snprintf(name, sizeof(name), "png 1 bpp level %d", pngLevels[format]);
+        }
+        report(name, frames, ms);
+        printf("%-28s %.0f B/frame encode=%.3f ms/frame\n", "", bytes / frames, ms / frames);
+    }
+}
+
+// N synthetic sources feeding the registry's shared workers as fast as they can
+static void benchMultiStream(int frames) {
+    const int maxStreams = 4;
+    std::vector<std::vector<cv::Mat>> inputs;
+    for (int s = 0; s < maxStreams; s++) {
+        inputs.push_back(makeFrames(4, s));
+    }
+
+    for (int streamCount = 1; streamCount <= maxStreams; streamCount++) {
+        StreamRegistry registry;
+        for (int s = 0; s < streamCount; s++) {
+            registry.getOrCreate(s);
+        }
+        std::atomic<bool> running{true};
+        std::vector<std::thread> producers;
+        auto start = Clock::now();
+        for (int s = 0; s < streamCount; s++) {
+            producers.emplace_back([&, s] {
+                int i = 0;
+                while (running.load()) {
+                    const cv::Mat& frame = inputs[s][i++ % inputs[s].size()];
+                    registry.submit(s, frame.data, frame.cols, frame.rows, static_cast<int>(frame.step));
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        // Run until every stream processed its share
+        while (true) {
+            bool done = true;
+            for (int s = 0; s < streamCount; s++) {
+                done = done && registry.find(s)->stats().processed >= static_cast<uint64_t>(frames);
+            }
+            if (done) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        running = false;
+        for (auto& t : producers) {
+            t.join();
+        }
+        registry.drain();
+        double ms = elapsedMs(start);
+
+        uint64_t processed = 0;
+        for (int s = 0; s < streamCount; s++) {
+            processed += registry.find(s)->stats().processed;
+        }
+        std::string name = std::to_string(streamCount) + " stream(s), " +
+                           std::to_string(registry.workerCount()) + " workers";
+        report(name.c_str(), static_cast<int>(processed), ms);
+    }
+}
+
+// Serial detect+encode+publish vs. the staged pipeline with overlapping stages
+static void benchPipeline(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+
+    // Not subscribed, so process() leaves the shared encode pool alone and encoding stays inline
+    auto serial = std::make_shared<StreamContext>(0);
+    std::vector<uint8_t> jpeg;
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, 70};
+    cv::Mat edges;
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        const cv::Mat& frame = inputs[i % inputs.size()];
+        FrameMeta meta;
+        serial->process(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), &meta, &edges);
+        cv::imencode(".jpg", edges, jpeg, params);
+    }
+    report("serial", frames, elapsedMs(start));
+
+    const int layouts[][2] = {{1, 1}, {2, 1}, {2, 2}};
+    for (const auto& layout : layouts) {
+        FramePipeline::Config config;
+        config.detectWorkers = layout[0];
+        config.encodeWorkers = layout[1];
+        config.dropWhenFull = false;
+        auto stream = std::make_shared<StreamContext>(0);
+        stream->setSubscribed(true);
+        FramePipeline pipeline(stream, config);
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            const cv::Mat& frame = inputs[i % inputs.size()];
+            pipeline.submit(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step));
+        }
+        pipeline.drain();
+        double ms = elapsedMs(start);
+        std::string name = "pipeline " + std::to_string(layout[0]) + " detect/" +
+                           std::to_string(layout[1]) + " encode";
+        report(name.c_str(), frames, ms);
+
+        FramePipeline::Stats s = pipeline.stats();
+        for (const auto& stage : s.stages) {
+            printf("  %-8s x%d busy=%8.1f ms stall=%8.1f ms starve=%8.1f ms util=%.2f\n", stage.name.c_str(),
+                   stage.workers, stage.busyMs, stage.stallMs, stage.starveMs, stage.utilization);
+        }
+        for (const auto& queue : s.queues) {
+            printf("  queue %-8s capacity=%d avg=%.2f max=%d\n", queue.name.c_str(), queue.capacity,
+                   queue.avgOccupancy, queue.maxOccupancy);
+        }
+    }
+}
+
+// Row-band blur tiles on cv::parallel_for_ (fork/join per call) vs. the shared
+// work-stealing scheduler, with 1-4 streams detecting concurrently
+static void benchScheduler(int frames) {
+    const int maxStreams = 4;
+    const int tileRows = 96;
+    std::vector<std::vector<cv::Mat>> inputs;
+    for (int s = 0; s < maxStreams; s++) {
+        inputs.push_back(makeFrames(4, s));
+    }
+    StreamParams params;
+
+    auto parallelForDetect = [&](const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges) {
+        blur.create(gray.rows, gray.cols, CV_8UC1);
+        int tiles = (gray.rows + tileRows - 1) / tileRows;
+        cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range& range) {
+            for (int t = range.start; t < range.end; t++) {
+                int begin = t * tileRows;
+                int end = std::min(gray.rows, begin + tileRows);
+                cv::Mat band = blur.rowRange(begin, end);
+                cv::GaussianBlur(gray.rowRange(begin, end), band, cv::Size(params.blurSize, params.blurSize),
+                                 params.blurSigma);
+            }
+        });
+        cv::Canny(blur, edges, params.lowThreshold, params.highThreshold);
+    };
+    auto schedulerDetect = [&](const cv::Mat& gray, cv::Mat& blur, cv::Mat& edges) {
+        StreamContext::detect(gray, blur, edges, params);
+    };
+
+    using DetectFn = std::function<void(const cv::Mat&, cv::Mat&, cv::Mat&)>;
+    const std::pair<const char*, DetectFn> variants[] = {
+        {"parallel_for_", parallelForDetect},
+        {"work-stealing", schedulerDetect},
+    };
+    for (int streamCount = 1; streamCount <= maxStreams; streamCount++) {
+        for (const auto& variant : variants) {
+            TaskScheduler::Stats before = TaskScheduler::instance().stats();
+            std::vector<std::thread> streams;
+            auto start = Clock::now();
+            for (int s = 0; s < streamCount; s++) {
+                streams.emplace_back([&, s] {
+                    cv::Mat blur, edges;
+                    for (int i = 0; i < frames; i++) {
+                        variant.second(inputs[s][i % inputs[s].size()], blur, edges);
+                    }
+                });
+            }
+            for (auto& t : streams) {
+                t.join();
+            }
+            double ms = elapsedMs(start);
+            std::string name = std::to_string(streamCount) + " stream(s), " + variant.first;
+            report(name.c_str(), frames * streamCount, ms);
+            if (variant.first == std::string("work-stealing")) {
+                TaskScheduler::Stats after = TaskScheduler::instance().stats();
+                printf("%-28s workers=%d tiles=%llu stolen=%llu helped=%llu\n", "", after.workers,
+                       (unsigned long long)(after.spawned - before.spawned),
+                       (unsigned long long)(after.stolen - before.stolen),
+                       (unsigned long long)(after.helped - before.helped));
+            }
+        }
+    }
+}
+
+// Pool counters across steady-state processing: after warm-up, frames should be
+// served entirely from cached blocks (no system allocations)
+static void benchMemory(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(4);
+    auto stream = std::make_shared<StreamContext>(0);
+    auto run = [&](int count) {
+        for (int i = 0; i < count; i++) {
+            const cv::Mat& frame = inputs[i % inputs.size()];
+            stream->process(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step));
+        }
+    };
+
+    BufferPool& pool = BufferPool::instance();
+    run(10);
+    BufferPool::Stats before = pool.stats();
+    auto start = Clock::now();
+    run(frames);
+    report("steady state", frames, elapsedMs(start));
+    BufferPool::Stats after = pool.stats();
+    printf("%-28s allocations=%llu poolHits=%llu systemAllocations=%llu\n", "",
+           (unsigned long long)(after.allocations - before.allocations),
+           (unsigned long long)(after.poolHits - before.poolHits),
+           (unsigned long long)(after.systemAllocations - before.systemAllocations));
+    printf("%-28s live=%.1f MB peak=%.1f MB cached=%.1f MB\n", "", after.liveBytes / 1048576.0,
+           after.peakBytes / 1048576.0, after.cachedBytes / 1048576.0);
+}
+
+// Simulated 30 FPS camera: the consumer always takes the newest captured frame (older
+// ones are overwritten, as in the frame ring). Fixed-interval throttling vs. the
+// deadline scheduler at several budgets; hit = capture-to-output within the budget.
+static void benchDeadline(int frames) {
+    const int64_t periodNs = 33333333;
+    std::vector<cv::Mat> inputs = makeFrames(30);
+    auto run = [&](const char* name, double budgetMs, int64_t minIntervalNs) {
+        auto stream = std::make_shared<StreamContext>(0);
+        StreamParams params = stream->params();
+        params.budgetMs = budgetMs;
+        stream->setParams(params);
+
+        int64_t t0 = frameClockNs();
+        int64_t lastStart = 0;
+        int last = -1;
+        int delivered = 0;
+        int hits = 0;
+        double latencySum = 0.0;
+        while (true) {
+            int64_t now = frameClockNs();
+            int newest = static_cast<int>((now - t0) / periodNs);
+            if (newest >= frames) {
+                break;
+            }
+            if (newest == last || now - lastStart < minIntervalNs) {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                continue;
+            }
+            last = newest;
+            lastStart = now;
+            const cv::Mat& frame = inputs[newest % inputs.size()];
+            FrameMeta meta;
+            meta.sensorTimestampNs = t0 + newest * periodNs;
+            if (stream->process(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), &meta)) {
+                double latencyMs = (meta.processEndNs - meta.sensorTimestampNs) / 1e6;
+                delivered++;
+                latencySum += latencyMs;
+                // The fixed-interval baseline is judged against the same 66 ms budget
+                hits += latencyMs <= (budgetMs > 0 ? budgetMs : 66.0);
+            }
+        }
+        double seconds = frames * periodNs / 1e9;
+        printf("%-28s delivered=%.1f fps hit=%.1f%% avgLatency=%.1f ms\n", name, delivered / seconds,
+               100.0 * hits / frames, delivered ? latencySum / delivered : 0.0);
+        if (budgetMs > 0) {
+            FrameScheduler::Stats s = stream->schedulerStats();
+            printf("%-28s", "");
+            for (int i = 0; i < static_cast<int>(FrameDecision::Count); i++) {
+                printf(" %s=%llu", frameDecisionName(static_cast<FrameDecision>(i)), (unsigned long long)s.decisions[i]);
+            }
+            printf("\n");
+        }
+    };
+
+    run("fixed 15 fps interval", 0.0, 66666666);
+    run("deadline 66 ms", 66.0, 0);
+    run("deadline 33 ms", 33.0, 0);
+    run("deadline 15 ms", 15.0, 0);
+}
+
+// Offline batch: per-frame StreamContext::process vs. processBatch on 1..N workers,
+// checking that every batch output matches the per-frame edge map exactly under the
+// default, fixed-point, union-find and colour-edge settings
+static void benchBatch(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(std::min(frames, 64));
+    const int count = static_cast<int>(inputs.size());
+    const int cw = (kWidth + 1) / 2;
+    const int ch = (kHeight + 1) / 2;
+    // I420 frames, so colour edges have chroma to read; the other settings ignore it
+    std::vector<cv::Mat> u(count);
+    std::vector<cv::Mat> v(count);
+    for (int i = 0; i < count; i++) {
+        u[i] = cv::Mat(ch, cw, CV_8UC1, cv::Scalar(128));
+        v[i] = cv::Mat(ch, cw, CV_8UC1, cv::Scalar(128));
+        cv::circle(u[i], cv::Point(cw / 3 + i, ch / 2), ch / 5, cv::Scalar(90), cv::FILLED);
+        cv::circle(v[i], cv::Point(2 * cw / 3 - i, ch / 2), ch / 5, cv::Scalar(170), cv::FILLED);
+    }
+    std::vector<FrameView> in(frames);
+    std::vector<cv::Mat> outputs(frames);
+    std::vector<MutableView> out(frames);
+    for (int i = 0; i < frames; i++) {
+        int f = i % count;
+        const cv::Mat& frame = inputs[f];
+        in[i] = FrameView::i420(frame.data, u[f].data, v[f].data, frame.cols, frame.rows,
+                                static_cast<int>(frame.step), static_cast<int>(u[f].step));
+        outputs[i].create(frame.rows, frame.cols, CV_8UC1);
+        out[i] = {outputs[i].data, frame.cols, frame.rows, static_cast<int>(outputs[i].step)};
+    }
+
+    StreamParams fixedPoint;
+    fixedPoint.engine = ProcessingEngine::FixedPoint;
+    StreamParams unionFind;
+    unionFind.hysteresis = HysteresisEngine::UnionFind;
+    StreamParams color;
+    color.colorEdges = true;
+    const struct {
+        const char* name;
+        StreamParams params;
+    } configs[] = {{"default", StreamParams()}, {"fixedpoint", fixedPoint}, {"unionfind", unionFind},
+                   {"color", color}};
+
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for (const auto& config : configs) {
+        auto stream = std::make_shared<StreamContext>(0);
+        stream->setParams(config.params);
+        std::vector<cv::Mat> expected(count);
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            cv::Mat edges;
+            stream->process(in[i], nullptr, &edges);
+            if (i < count) {
+                edges.copyTo(expected[i]);
+            }
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "%s per-frame process", config.name);
+        report(name, frames, elapsedMs(start));
+
+        // A scheduler always has at least one worker, so rows are labelled by worker count
+        // (the calling thread helps on top of them)
+        for (int workers = 1; workers <= cores; workers *= 2) {
+            TaskScheduler scheduler(workers);
+            // Cleared so a frame the batch skipped cannot pass on an earlier run's output
+            for (cv::Mat& output : outputs) {
+                output.setTo(cv::Scalar(0));
+            }
+            BatchProcessor::Result result =
+                BatchProcessor::processBatch(in.data(), out.data(), in.size(), config.params, scheduler);
+            int mismatches = 0;
+            for (int i = 0; i < frames; i++) {
+                mismatches += cv::norm(outputs[i], expected[i % count], cv::NORM_INF) != 0;
+            }
+            snprintf(name, sizeof(name), "%s batch %d worker(s)", config.name, workers);
+            report(name, static_cast<int>(result.processed), result.wallMs);
+            printf("%-28s failed=%zu mismatches=%d\n", "", result.failed, mismatches);
+        }
+
+        // The default scheduler, as the app uses it: frame tasks next to the shared tile scheduler
+        for (cv::Mat& output : outputs) {
+            output.setTo(cv::Scalar(0));
+        }
+        BatchProcessor::Result result =
+            BatchProcessor::processBatch(in.data(), out.data(), in.size(), config.params);
+        int mismatches = 0;
+        for (int i = 0; i < frames; i++) {
+            mismatches += cv::norm(outputs[i], expected[i % count], cv::NORM_INF) != 0;
+        }
+        snprintf(name, sizeof(name), "%s batch default", config.name);
+        report(name, static_cast<int>(result.processed), result.wallMs);
+        printf("%-28s failed=%zu mismatches=%d\n", "", result.failed, mismatches);
+    }
+}
+
+// Blocking per-frame processing vs. async submit: the producer only pays for the ring
+// copy while the completion thread runs detection
+static void benchAsync(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    auto blocking = std::make_shared<StreamContext>(0);
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        const cv::Mat& frame = inputs[i % inputs.size()];
+        blocking->process(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step));
+    }
+    double blockingMs = elapsedMs(start);
+    report("blocking process", frames, blockingMs);
+
+    FrameRing ring(3, static_cast<size_t>(kWidth) * kHeight);
+    AsyncProcessor processor(ring, std::make_shared<StreamContext>(1));
+    std::atomic<int> completions{0};
+    processor.start([&](const FrameCompletion&) { completions.fetch_add(1, std::memory_order_relaxed); });
+    // Submit at the rate the blocking path sustained, like a camera that just keeps up
+    auto period = std::chrono::duration<double, std::milli>(blockingMs / frames);
+    start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        const cv::Mat& frame = inputs[i % inputs.size()];
+        processor.submit(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), 1);
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(period * (i + 1)));
+    }
+    report("async submit", frames, elapsedMs(start));
+    processor.stop();
+    AsyncProcessor::Stats s = processor.stats();
+    printf("%-28s completed=%d avgSubmit=%.1f us maxSubmit=%.1f us avgComplete=%.2f ms\n", "",
+           completions.load(), s.avgSubmitUs, s.maxSubmitUs, s.avgCompleteMs);
+}
+
+// Stream throughput under each thread placement policy. Point EDGE_CPU_SYSFS_ROOT at a
+// fake sysfs tree to check the discovered big/little split on a host.
+static void benchPlacement(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(4);
+    ThreadPlacement& placement = ThreadPlacement::instance();
+    printf("%-28s %s\n", "topology", placement.topology().toJson().c_str());
+    printf("%-28s %d\n", "task workers", TaskScheduler::instance().workerCount());
+    for (PlacementPolicy policy : {PlacementPolicy::Off, PlacementPolicy::Split, PlacementPolicy::Performance}) {
+        placement.setPolicy(policy);
+        StreamRegistry registry;
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            const cv::Mat& frame = inputs[i % inputs.size()];
+            registry.submit(0, frame.data, frame.cols, frame.rows, static_cast<int>(frame.step));
+            registry.drain();
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "policy %s", ThreadPlacement::policyName(policy));
+        report(name, frames, elapsedMs(start));
+    }
+    printf("%-28s %s\n", "", placement.statsJson().c_str());
+    placement.setPolicy(PlacementPolicy::Split);
+}
+
+// Imperative blur + Canny vs. the G-API Fluid graph (full and half resolution); the
+// graph is compiled once per resolution, outside the timed loop
+static void benchGapi(int frames) {
+    if (!GapiEdgeGraph::available()) {
+        printf("OpenCV built without G-API; skipping\n");
+        return;
+    }
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    StreamParams params;
+    std::vector<cv::Mat> reference(inputs.size());
+    cv::Mat blur;
+    cv::Mat edges;
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        const cv::Mat& frame = inputs[i % inputs.size()];
+        StreamContext::detect(frame, blur, edges, params);
+        if (i < static_cast<int>(inputs.size())) {
+            edges.copyTo(reference[i]);
+        }
+    }
+    report("imperative", frames, elapsedMs(start));
+
+    for (int downscale : {1, 2}) {
+        GapiEdgeGraph::Config config;
+        config.downscale = downscale;
+        GapiEdgeGraph graph(config);
+        graph.apply(inputs[0], edges, params);
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            graph.apply(inputs[i % inputs.size()], edges, params);
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "gapi fluid 1/%d", downscale);
+        report(name, frames, elapsedMs(start));
+        if (downscale == 1) {
+            // Fluid blur rounds differently from cv::GaussianBlur in places
+            double differing = 0;
+            for (size_t i = 0; i < inputs.size(); i++) {
+                graph.apply(inputs[i], edges, params);
+                cv::Mat diff;
+                cv::compare(edges, reference[i], diff, cv::CMP_NE);
+                differing += cv::countNonZero(diff);
+            }
+            printf("%-28s compile=%.1f ms differing pixels=%.4f%%\n", "", graph.lastCompileMs(),
+                   100.0 * differing / (inputs.size() * static_cast<double>(kWidth) * kHeight));
+        } else {
+            printf("%-28s compile=%.1f ms\n", "", graph.lastCompileMs());
+        }
+    }
+}
+
+// The async submit path under each engine. The producer keeps up to three frames in
+// flight, so the streaming pipeline can overlap frames while the per-frame engines
+// process them one at a time on the completion thread.
+static void benchStreaming(int frames) {
+    if (!GapiStreamingPipeline::available()) {
+        printf("OpenCV built without G-API; skipping\n");
+        return;
+    }
+    const int kInFlight = 3;
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    for (ProcessingEngine engine :
+         {ProcessingEngine::Imperative, ProcessingEngine::Gapi, ProcessingEngine::GapiStreaming}) {
+        auto stream = std::make_shared<StreamContext>(0);
+        StreamParams params;
+        params.engine = engine;
+        stream->setParams(params);
+        FrameRing ring(kInFlight + 1, static_cast<size_t>(kWidth) * kHeight);
+        AsyncProcessor processor(ring, stream);
+        std::atomic<int> completions{0};
+        processor.start([&](const FrameCompletion&) { completions.fetch_add(1, std::memory_order_relaxed); });
+
+        // Warm up outside the timed loop: graph compilation happens on the first frame
+        const cv::Mat& first = inputs[0];
+        processor.submit(first.data, first.cols, first.rows, static_cast<int>(first.step), 1);
+        while (completions.load() < 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            while (i - (completions.load() - 1) >= kInFlight) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            const cv::Mat& frame = inputs[i % inputs.size()];
+            processor.submit(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), 1);
+        }
+        // Rejected or overwritten frames never complete; stop waiting once the tail is idle
+        int last = -1;
+        while (completions.load() != last) {
+            last = completions.load();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        double ms = elapsedMs(start);
+        processor.stop();
+
+        char name[64];
+        snprintf(name, sizeof(name), "async %s", processingEngineName(engine));
+        report(name, completions.load() - 1, ms);
+        AsyncProcessor::Stats s = processor.stats();
+        printf("%-28s submitted=%llu completed=%llu avgComplete=%.2f ms\n", "", (unsigned long long)s.submitted,
+               (unsigned long long)s.completed, s.avgCompleteMs);
+        if (engine == ProcessingEngine::GapiStreaming) {
+            GapiStreamingPipeline::Stats p = processor.streamingStats();
+            printf("%-28s rejected=%llu encodeFrames=%llu compile=%.1f ms\n", "", (unsigned long long)p.rejected,
+                   (unsigned long long)p.encodeFrames, p.lastCompileMs);
+        }
+    }
+}
+
+// Blur + each edge detector; the gradient detectors skip NMS and hysteresis entirely
+static void benchDetectors(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    StreamParams params;
+    cv::Mat blur;
+    cv::Mat edges;
+    for (EdgeDetectorType type : {EdgeDetectorType::Canny, EdgeDetectorType::Sobel, EdgeDetectorType::Scharr,
+                                  EdgeDetectorType::Laplacian, EdgeDetectorType::DoG}) {
+        params.detector = type;
+        double density = 0;
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            StreamContext::detect(inputs[i % inputs.size()], blur, edges, params);
+            if (i < static_cast<int>(inputs.size())) {
+                density += cv::countNonZero(edges);
+            }
+        }
+        report(edgeDetectorName(type), frames, elapsedMs(start));
+        int sampled = std::min(frames, static_cast<int>(inputs.size()));
+        printf("%-28s edge pixels=%.2f%%\n", "", 100.0 * density / (sampled * static_cast<double>(kWidth) * kHeight));
+    }
+}
+
+// Imperative blur + Canny vs. the fused fixed-point blur + Sobel feeding Canny, for
+// the two kernels the app uses. Outputs must match bit for bit.
+static void benchFixedPoint(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const struct {
+        int size;
+        double sigma;
+    } kernels[] = {{3, 0.8}, {5, 1.4}};
+    for (const auto& kernel : kernels) {
+        StreamParams params;
+        params.blurSize = kernel.size;
+        params.blurSigma = kernel.sigma;
+        std::vector<cv::Mat> referenceBlur(inputs.size());
+        std::vector<cv::Mat> referenceEdges(inputs.size());
+        cv::Mat blur;
+        cv::Mat edges;
+        char name[64];
+        for (ProcessingEngine engine : {ProcessingEngine::Imperative, ProcessingEngine::FixedPoint}) {
+            params.engine = engine;
+            auto start = Clock::now();
+            for (int i = 0; i < frames; i++) {
+                StreamContext::detect(inputs[i % inputs.size()], blur, edges, params);
+            }
+            snprintf(name, sizeof(name), "%s %dx%d/%.1f", processingEngineName(engine), kernel.size, kernel.size,
+                     kernel.sigma);
+            report(name, frames, elapsedMs(start));
+        }
+
+        double blurDiff = 0;
+        double edgeDiff = 0;
+        FixedPointFilter filter(kernel.size, kernel.sigma);
+        cv::Mat dx;
+        cv::Mat dy;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            cv::GaussianBlur(inputs[i], referenceBlur[i], cv::Size(kernel.size, kernel.size), kernel.sigma);
+            cv::Canny(referenceBlur[i], referenceEdges[i], params.lowThreshold, params.highThreshold);
+            filter.apply(inputs[i], blur, &dx, &dy);
+            cv::Canny(dx, dy, edges, params.lowThreshold, params.highThreshold);
+            cv::Mat diff;
+            cv::compare(blur, referenceBlur[i], diff, cv::CMP_NE);
+            blurDiff += cv::countNonZero(diff);
+            cv::compare(edges, referenceEdges[i], diff, cv::CMP_NE);
+            edgeDiff += cv::countNonZero(diff);
+        }
+        std::vector<uint16_t> q = FixedPointFilter::gaussianKernel(kernel.size, kernel.sigma);
+        std::string taps;
+        for (uint16_t c : q) {
+            taps += (taps.empty() ? "" : " ") + std::to_string(c);
+        }
+        printf("%-28s kernel=[%s]/256 differing blur=%.0f edges=%.0f pixels\n", "", taps.c_str(), blurDiff, edgeDiff);
+    }
+}
+
+// Generic GaussianBlur + Canny (+ cvtColor) vs. each compile-time specialized pipeline
+// variant, plus the cost of selecting a variant. Outputs must match bit for bit.
+static void benchVariants(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const struct {
+        int size;
+        double sigma;
+    } blurs[] = {{3, 0.8}, {5, 1.4}};
+    cv::Mat blur;
+    cv::Mat generic;
+    cv::Mat specialized;
+    for (const auto& b : blurs) {
+        for (int aperture : {3, 5}) {
+            for (bool l2 : {false, true}) {
+                for (EdgeOutputFormat format : {EdgeOutputFormat::Gray, EdgeOutputFormat::Rgba}) {
+                    StreamParams params;
+                    params.blurSize = b.size;
+                    params.blurSigma = b.sigma;
+                    params.cannyAperture = aperture;
+                    params.cannyL2 = l2;
+                    PipelineVariants::Variant variant = PipelineVariants::find(params, format);
+                    if (!variant) {
+                        continue;
+                    }
+                    auto start = Clock::now();
+                    for (int i = 0; i < frames; i++) {
+                        PipelineVariants::runGeneric(inputs[i % inputs.size()], blur, generic, params, format);
+                    }
+                    double genericMs = elapsedMs(start);
+                    start = Clock::now();
+                    for (int i = 0; i < frames; i++) {
+                        variant(inputs[i % inputs.size()], blur, specialized, params);
+                    }
+                    double specializedMs = elapsedMs(start);
+
+                    double differing = 0;
+                    for (const cv::Mat& input : inputs) {
+                        PipelineVariants::runGeneric(input, blur, generic, params, format);
+                        variant(input, blur, specialized, params);
+                        cv::Mat diff;
+                        cv::compare(generic.reshape(1), specialized.reshape(1), diff, cv::CMP_NE);
+                        differing += cv::countNonZero(diff);
+                    }
+                    printf("blur %dx%d/%.1f aperture %d %s %-4s generic %7.2f ms specialized %7.2f ms "
+                           "x%.2f differing=%.0f\n",
+                           b.size, b.size, b.sigma, aperture, l2 ? "L2" : "L1",
+                           format == EdgeOutputFormat::Gray ? "gray" : "rgba", genericMs / frames,
+                           specializedMs / frames, genericMs / specializedMs, differing);
+                }
+            }
+        }
+    }
+
+    // Selection is a table lookup; it must stay negligible next to a frame
+    StreamParams params;
+    const int lookups = 1000000;
+    int found = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < lookups; i++) {
+        params.cannyL2 = (i & 1) != 0;
+        found += PipelineVariants::find(params, (i & 2) ? EdgeOutputFormat::Rgba : EdgeOutputFormat::Gray) != nullptr;
+    }
+    printf("variant selection %.1f ns (%d found)\n", elapsedMs(start) * 1e6 / lookups, found);
+}
+
+// cv::Canny's flood-fill hysteresis vs. union-find connected components on 4K
+// gradients, with the union-find engine on 2, 4, 8... scheduler threads.
+// Edge maps must match exactly.
+static void benchHysteresis(int frames) {
+    const int width = 3840;
+    const int height = 2160;
+    SyntheticSource source(width, height, 0);
+    const int count = 4;
+    std::vector<cv::Mat> dx(count);
+    std::vector<cv::Mat> dy(count);
+    for (int i = 0; i < count; i++) {
+        cv::Mat gray;
+        cv::Mat blur;
+        source.render(gray, i);
+        cv::GaussianBlur(gray, blur, cv::Size(5, 5), 1.4);
+        cv::Sobel(blur, dx[i], CV_16S, 1, 0, 3, 1, 0, cv::BORDER_REPLICATE);
+        cv::Sobel(blur, dy[i], CV_16S, 0, 1, 3, 1, 0, cv::BORDER_REPLICATE);
+    }
+    // 4K frames take several times longer than the default 720p ones
+    frames = std::max(1, frames / 8);
+    StreamParams params;
+    std::vector<cv::Mat> reference(count);
+    cv::Mat edges;
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        cv::Canny(dx[i % count], dy[i % count], edges, params.lowThreshold, params.highThreshold);
+    }
+    report("opencv 3840x2160", frames, elapsedMs(start));
+    for (int i = 0; i < count; i++) {
+        cv::Canny(dx[i], dy[i], reference[i], params.lowThreshold, params.highThreshold);
+    }
+
+    int hardware = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int threads = 2; threads <= hardware; threads *= 2) {
+        // The waiting caller runs tasks too
+        TaskScheduler scheduler(threads - 1);
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            UnionFindCanny::run(dx[i % count], dy[i % count], edges, params.lowThreshold, params.highThreshold,
+                                false, scheduler);
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "unionfind %d threads", threads);
+        report(name, frames, elapsedMs(start));
+        if (threads == 2) {
+            double differing = 0;
+            for (int i = 0; i < count; i++) {
+                UnionFindCanny::run(dx[i], dy[i], edges, params.lowThreshold, params.highThreshold, false,
+                                    scheduler);
+                cv::Mat diff;
+                cv::compare(edges, reference[i], diff, cv::CMP_NE);
+                differing += cv::countNonZero(diff);
+            }
+            printf("%-28s differing pixels=%.0f\n", "", differing);
+        }
+    }
+}
+
+// Packed bitmap and PNG vs. the contour stream at several approxPolyDP tolerances:
+// trace + encode time, bytes and vertices. With epsilon 0 every polyline vertex is
+// an edge pixel, so redrawing the decoded points must give the edge map back.
+static void benchContours(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const int count = static_cast<int>(inputs.size());
+    std::vector<std::vector<uint8_t>> packed(count);
+    cv::Mat blur;
+    std::vector<cv::Mat> edges(count);
+    double packedBytes = 0;
+    double pngBytes = 0;
+    double edgePixels = 0;
+    std::vector<uint8_t> png;
+    for (int i = 0; i < count; i++) {
+        detect(inputs[i], blur, edges[i]);
+        EdgeEncoder::packBits(edges[i], packed[i]);
+        EdgeEncoder::encodePng1bpp(packed[i].data(), kWidth, kHeight, png, EdgeEncoder::pngCompressionLevel());
+        packedBytes += packed[i].size();
+        pngBytes += png.size();
+        edgePixels += cv::countNonZero(edges[i]);
+    }
+    printf("%-28s packed=%.0f B png=%.0f B edge pixels=%.0f per frame\n", "", packedBytes / count,
+           pngBytes / count, edgePixels / count);
+
+    std::vector<uint8_t> out;
+    std::vector<EdgePolyline> polylines;
+    for (double epsilon : {0.0, 1.0, 2.0, 4.0}) {
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            ContourEncoder::encodePacked(packed[i % count].data(), kWidth, kHeight, epsilon, out);
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "contours eps=%.1f", epsilon);
+        report(name, frames, elapsedMs(start));
+
+        double bytes = 0;
+        double lines = 0;
+        double vertices = 0;
+        double lost = 0;
+        for (int i = 0; i < count; i++) {
+            ContourEncoder::encodePacked(packed[i].data(), kWidth, kHeight, epsilon, out);
+            int width = 0;
+            int height = 0;
+            if (!ContourEncoder::decode(out.data(), out.size(), width, height, polylines)) {
+                printf("%-28s decode failed\n", "");
+                return;
+            }
+            bytes += out.size();
+            lines += polylines.size();
+            cv::Mat redrawn = cv::Mat::zeros(height, width, CV_8UC1);
+            for (const EdgePolyline& polyline : polylines) {
+                vertices += polyline.points.size();
+                for (const cv::Point& p : polyline.points) {
+                    redrawn.at<uint8_t>(p) = 255;
+                }
+            }
+            if (epsilon == 0.0) {
+                cv::Mat diff;
+                cv::compare(redrawn, edges[i], diff, cv::CMP_NE);
+                lost += cv::countNonZero(diff);
+            }
+        }
+        printf("%-28s bytes=%.0f (%.1f%% of packed) polylines=%.0f vertices=%.0f", "", bytes / count,
+               100.0 * bytes / packedBytes, lines / count, vertices / count);
+        if (epsilon == 0.0) {
+            printf(" differing pixels=%.0f", lost);
+        }
+        printf("\n");
+    }
+}
+
+// Segment stage on a moving synthetic sequence: per-stage time for blur + Canny, Hough,
+// gradient validation and tracking, with Canny's gradients reused vs. sampled from
+// the blurred frame, and how many tracks are stable
+static void benchSegments(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(30);
+    const int count = static_cast<int>(inputs.size());
+    cv::Mat blur;
+    cv::Mat edges;
+    std::vector<LineSegment> segments;
+    for (bool reuse : {true, false}) {
+        StreamParams params;
+        params.segments = reuse;
+        SegmentTracker tracker;
+        double detectMs = 0;
+        double houghMs = 0;
+        double validateMs = 0;
+        double trackMs = 0;
+        double detections = 0;
+        for (int i = 0; i < frames; i++) {
+            auto start = Clock::now();
+            UnionFindCanny::clearLastGradients();
+            StreamContext::detect(inputs[i % count], blur, edges, params);
+            detectMs += elapsedMs(start);
+            cv::Mat dx;
+            cv::Mat dy;
+            UnionFindCanny::lastGradients(dx, dy);
+            SegmentTiming timing;
+            SegmentDetector::detect(edges, dx, dy, blur, segments, &timing);
+            start = Clock::now();
+            tracker.update(segments, static_cast<uint64_t>(i + 1));
+            trackMs += elapsedMs(start);
+            houghMs += timing.houghMs;
+            validateMs += timing.validateMs;
+            detections += segments.size();
+        }
+        int stable = 0;
+        for (const TrackedSegment& track : tracker.tracks()) {
+            stable += track.hits >= SegmentTracker::kStableHits;
+        }
+        printf("%-28s detect=%.2f hough=%.2f validate=%.2f track=%.2f ms/frame\n",
+               reuse ? "segments, canny gradients" : "segments, sampled sobel", detectMs / frames,
+               houghMs / frames, validateMs / frames, trackMs / frames);
+        printf("%-28s segments=%.1f/frame tracks=%zu stable=%d\n", "", detections / frames,
+               tracker.tracks().size(), stable);
+    }
+}
+
+// Per-frame edge stats: packing alone, packing with the stats gathered per row (with
+// and without gradients), and packing followed by the countNonZero pass it replaces.
+// The stats' edge count must match countNonZero.
+static void benchStats(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const int count = static_cast<int>(inputs.size());
+    cv::Mat blur;
+    std::vector<cv::Mat> edges(count);
+    std::vector<cv::Mat> dx(count);
+    std::vector<cv::Mat> dy(count);
+    for (int i = 0; i < count; i++) {
+        detect(inputs[i], blur, edges[i]);
+        cv::Sobel(blur, dx[i], CV_16S, 1, 0, 3, 1, 0, cv::BORDER_REPLICATE);
+        cv::Sobel(blur, dy[i], CV_16S, 0, 1, 3, 1, 0, cv::BORDER_REPLICATE);
+    }
+    std::vector<uint8_t> packed;
+    EdgeFrameStats stats;
+    stats.gridCols = 8;
+    stats.gridRows = 8;
+
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        EdgeEncoder::packBits(edges[i % count], packed);
+    }
+    report("pack", frames, elapsedMs(start));
+
+    start = Clock::now();
+    uint64_t counted = 0;
+    for (int i = 0; i < frames; i++) {
+        EdgeEncoder::packBits(edges[i % count], packed);
+        counted += cv::countNonZero(edges[i % count]);
+    }
+    report("pack + countNonZero", frames, elapsedMs(start));
+
+    start = Clock::now();
+    uint64_t gathered = 0;
+    for (int i = 0; i < frames; i++) {
+        EdgeEncoder::packBits(edges[i % count], packed, &stats);
+        gathered += stats.edgeCount;
+    }
+    report("pack + stats 8x8", frames, elapsedMs(start));
+
+    start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        EdgeEncoder::packBits(edges[i % count], packed, &stats, &dx[i % count], &dy[i % count]);
+    }
+    report("pack + stats + gradient", frames, elapsedMs(start));
+    printf("%-28s edges=%.0f/frame bbox=%dx%d meanGradient=%.1f counts %s\n", "",
+           static_cast<double>(gathered) / frames, stats.boundingBox.width, stats.boundingBox.height,
+           stats.meanGradient, gathered == counted ? "match" : "DIFFER");
+}
+
+// Temporal stabilization over a noisy moving sequence: pack + stats time with the
+// filter fused in, edge density, and the output vs. raw toggle rate per persistence
+static void benchStabilize(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(30);
+    const int count = static_cast<int>(inputs.size());
+    cv::Mat blur;
+    std::vector<cv::Mat> edges(count);
+    for (int i = 0; i < count; i++) {
+        detect(inputs[i], blur, edges[i]);
+    }
+    for (int persist : {0, 2, 3, 5}) {
+        TemporalFilter filter;
+        filter.setFrames(persist);
+        std::vector<uint8_t> packed;
+        std::vector<uint8_t> previous;
+        EdgeFrameStats stats;
+        stats.gridCols = 8;
+        stats.gridRows = 8;
+        double ms = 0;
+        double density = 0;
+        double toggles = 0;
+        double rawToggles = 0;
+        int measured = 0;
+        for (int i = 0; i < frames; i++) {
+            auto start = Clock::now();
+            EdgeEncoder::packBits(edges[i % count], packed, &stats, nullptr, nullptr,
+                                  previous.empty() ? nullptr : previous.data(), &filter);
+            ms += elapsedMs(start);
+            previous.swap(packed);
+            density += stats.density();
+            if (stats.toggleCount >= 0) {
+                toggles += stats.toggleRate();
+                rawToggles += stats.rawToggleCount >= 0 ? stats.rawToggleRate() : stats.toggleRate();
+                measured++;
+            }
+        }
+        char name[64];
+        snprintf(name, sizeof(name), persist ? "stabilize k=%d" : "stabilize off", persist);
+        report(name, frames, ms);
+        printf("%-28s density=%.4f toggles=%.5f raw toggles=%.5f per pixel per frame\n", "", density / frames,
+               measured ? toggles / measured : 0.0, measured ? rawToggles / measured : 0.0);
+    }
+}
+
+// Colour-aware Canny: luma-only vs. luma + chroma gradients on frames with isoluminant
+// colour regions, from planar (I420) and interleaved (NV12) chroma
+static void benchColor(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(8);
+    const int count = static_cast<int>(inputs.size());
+    const int cw = (kWidth + 1) / 2;
+    const int ch = (kHeight + 1) / 2;
+    // Chroma discs drifting over a neutral background; the luma never sees them
+    std::vector<cv::Mat> u(count);
+    std::vector<cv::Mat> v(count);
+    std::vector<cv::Mat> uv(count);
+    for (int i = 0; i < count; i++) {
+        u[i] = cv::Mat(ch, cw, CV_8UC1, cv::Scalar(128));
+        v[i] = cv::Mat(ch, cw, CV_8UC1, cv::Scalar(128));
+        for (int k = 0; k < 6; k++) {
+            cv::Point center(cw * (k + 1) / 7 + 4 * i, ch / 2 + (k % 2 ? ch / 4 : -ch / 4));
+            cv::circle(u[i], center, ch / 6, cv::Scalar(k % 2 ? 90 : 170), cv::FILLED);
+            cv::circle(v[i], center, ch / 6, cv::Scalar(k % 3 ? 160 : 100), cv::FILLED);
+        }
+        cv::Mat planes[] = {u[i], v[i]};
+        cv::merge(planes, 2, uv[i]);
+    }
+
+    StreamParams params;
+    params.colorEdges = true;
+    cv::Mat blur;
+    cv::Mat edges;
+    cv::Mat luma;
+    for (int layout = 0; layout < 3; layout++) {
+        double ms = 0;
+        double density = 0;
+        double added = 0;
+        for (int i = 0; i < frames; i++) {
+            int f = i % count;
+            ChromaPlanes chroma;
+            chroma.width = cw;
+            chroma.height = ch;
+            if (layout == 1) {
+                chroma.u = u[f].data;
+                chroma.v = v[f].data;
+                chroma.rowStride = static_cast<int>(u[f].step);
+            } else if (layout == 2) {
+                chroma.u = uv[f].data;
+                chroma.v = uv[f].data + 1;
+                chroma.rowStride = static_cast<int>(uv[f].step);
+                chroma.pixelStride = 2;
+            }
+            auto start = Clock::now();
+            StreamContext::detect(inputs[f], blur, edges, params, layout ? &chroma : nullptr);
+            ms += elapsedMs(start);
+            density += cv::countNonZero(edges) / static_cast<double>(edges.total());
+            if (layout) {
+                StreamContext::detect(inputs[f], blur, luma, params);
+                cv::Mat gained = edges & ~luma;
+                added += cv::countNonZero(gained) / static_cast<double>(edges.total());
+            }
+        }
+        const char* names[] = {"luma only", "colour I420 (stride 1)", "colour NV12 (stride 2)"};
+        report(names[layout], frames, ms);
+        printf("%-28s density=%.4f colour-only edges=%.4f\n", "", density / frames, added / frames);
+    }
+}
+
+// Ingest per input layout: the luma view (or staging conversion) the blur starts from,
+// blur + Canny on it, and the copy into an async ring slot
+static void benchIngest(int frames) {
+    std::vector<cv::Mat> inputs = makeFrames(4);
+    const int count = static_cast<int>(inputs.size());
+    const int cw = (kWidth + 1) / 2;
+    const int ch = (kHeight + 1) / 2;
+    // Camera-style row padding
+    const int padded = kWidth + 64;
+
+    struct Input {
+        cv::Mat y;
+        cv::Mat u;
+        cv::Mat v;
+        cv::Mat uv;
+        cv::Mat yuyv;
+        cv::Mat rgba;
+        cv::Mat bgr;
+    };
+    std::vector<Input> sources(count);
+    for (int i = 0; i < count; i++) {
+        Input& in = sources[i];
+        in.y = cv::Mat(kHeight, padded, CV_8UC1, cv::Scalar(0));
+        inputs[i].copyTo(in.y.colRange(0, kWidth));
+        cv::resize(inputs[i], in.u, cv::Size(cw, ch), 0, 0, cv::INTER_AREA);
+        in.v = 255 - in.u;
+        cv::Mat planes[] = {in.u, in.v};
+        cv::merge(planes, 2, in.uv);
+        cv::Mat luma[] = {inputs[i], cv::Mat(kHeight, kWidth, CV_8UC1, cv::Scalar(128))};
+        cv::merge(luma, 2, in.yuyv);
+        cv::cvtColor(inputs[i], in.rgba, cv::COLOR_GRAY2RGBA);
+        cv::cvtColor(inputs[i], in.bgr, cv::COLOR_GRAY2BGR);
+    }
+    auto view = [&](int layout, const Input& in) {
+        const int yStride = static_cast<int>(in.y.step);
+        const int uvStride = static_cast<int>(in.uv.step);
+        switch (layout) {
+            case 0:
+                return FrameView::gray(in.y.data, kWidth, kHeight, yStride);
+            case 1:
+                return FrameView::gray(in.yuyv.data, kWidth, kHeight, static_cast<int>(in.yuyv.step), 2);
+            case 2:
+                // What the camera's YUV_420_888 planes usually are: NV12 memory behind three planes
+                return FrameView::yuv420(in.y.data, in.uv.data, in.uv.data + 1, kWidth, kHeight, yStride, 1,
+                                         uvStride, 2);
+            case 3:
+                return FrameView::nv12(in.y.data, in.uv.data, kWidth, kHeight, yStride, uvStride);
+            case 4:
+                return FrameView::nv21(in.y.data, in.uv.data, kWidth, kHeight, yStride, uvStride);
+            case 5:
+                return FrameView::i420(in.y.data, in.u.data, in.v.data, kWidth, kHeight, yStride,
+                                       static_cast<int>(in.u.step));
+            case 6:
+                return FrameView::rgba(in.rgba.data, kWidth, kHeight, static_cast<int>(in.rgba.step));
+            default:
+                return FrameView::bgr(in.bgr.data, kWidth, kHeight, static_cast<int>(in.bgr.step));
+        }
+    };
+    const char* names[] = {"gray (padded rows)", "gray (pixel stride 2)", "YUV_420_888", "NV12", "NV21",
+                           "I420", "RGBA", "BGR"};
+
+    StreamParams params;
+    FrameRing ring(3, static_cast<size_t>(kWidth) * kHeight * 3 / 2);
+    cv::Mat scratch;
+    cv::Mat blur;
+    cv::Mat edges;
+    for (int layout = 0; layout < 8; layout++) {
+        double ingestMs = 0;
+        double detectMs = 0;
+        double ringMs = 0;
+        bool direct = false;
+        for (int i = 0; i < frames; i++) {
+            FrameView frame = view(layout, sources[i % count]);
+            direct = frame.directLuma();
+            auto start = Clock::now();
+            cv::Mat gray = frame.luma(scratch);
+            ingestMs += elapsedMs(start);
+            start = Clock::now();
+            StreamContext::detect(gray, blur, edges, params);
+            detectMs += elapsedMs(start);
+            start = Clock::now();
+            ring.push(frame, FrameMeta());
+            ringMs += elapsedMs(start);
+            ring.release(ring.acquire(0));
+        }
+        report(names[layout], frames, ingestMs + detectMs);
+        printf("%-28s luma %s %.3f ms + detect %.2f ms; ring copy (with chroma) %.3f ms\n", "",
+               direct ? "view" : "copy", ingestMs / frames, detectMs / frames, ringMs / frames);
+    }
+}
+
+struct Mode {
+    const char* name;
+    std::function<void(int)> run;
+};
+
+int main(int argc, char** argv) {
+    // Same allocator as the app, so every mode runs on pooled buffers
+    PooledMatAllocator::install();
+    const Mode modes[] = {
+        {"encode", benchEncode},
+        {"lossless", benchLossless},
+        {"multistream", benchMultiStream},
+        {"pipeline", benchPipeline},
+        {"scheduler", benchScheduler},
+        {"memory", benchMemory},
+        {"deadline", benchDeadline},
+        {"batch", benchBatch},
+        {"async", benchAsync},
+        {"placement", benchPlacement},
+        {"gapi", benchGapi},
+        {"streaming", benchStreaming},
+        {"detectors", benchDetectors},
+        {"fixedpoint", benchFixedPoint},
+        {"variants", benchVariants},
+        {"hysteresis", benchHysteresis},
+        {"contours", benchContours},
+        {"segments", benchSegments},
+        {"stats", benchStats},
+        {"stabilize", benchStabilize},
+        {"color", benchColor},
+        {"ingest", benchIngest},
+    };
+    const char* selected = argc > 1 ? argv[1] : "all";
+    int frames = argc > 2 ? std::atoi(argv[2]) : 300;
+    if (frames <= 0) {
+        frames = 300;
+    }
+
+    bool ran = false;
+    for (const Mode& mode : modes) {
+        if (strcmp(selected, "all") == 0 || strcmp(selected, mode.name) == 0) {
+            printf("== %s (%dx%d) ==\n", mode.name, kWidth, kHeight);
+            mode.run(frames);
+            ran = true;
+        }
+    }
+    if (!ran) {
+        fprintf(stderr, "usage: %s [all", argv[0]);
+        for (const Mode& mode : modes) {
+            fprintf(stderr, "|%s", mode.name);
+        }
+        fprintf(stderr, "] [frames]\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,412 @@
+#include "union_find_canny.h"
+#include "stream_registry.h"
+#include "task_scheduler.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+const char* hysteresisEngineName(HysteresisEngine engine) {
+    switch (engine) {
+        case HysteresisEngine::OpenCV: return "opencv";
+        case HysteresisEngine::UnionFind: return "unionfind";
+        default: return "unknown";
+    }
+}
+
+bool parseHysteresisEngine(const std::string& name, HysteresisEngine& engine) {
+    for (HysteresisEngine candidate : {HysteresisEngine::OpenCV, HysteresisEngine::UnionFind}) {
+        if (name == hysteresisEngineName(candidate)) {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// Rows per band; each band is one labelling task and one seam to merge
+const int kBandRows = 64;
+
+// cv::Canny's fixed-point direction test: tan(22.5 deg) in Q15
+const int kCannyShift = 15;
+const int kTan22 = static_cast<int>(0.4142135623730950488016887242097 * (1 << kCannyShift) + 0.5);
+
+// Candidate states after non-maximum suppression, plus a flag on the root of each
+// band-local component
+const uint8_t kNone = 0;
+const uint8_t kWeak = 1;
+const uint8_t kStrong = 2;
+const uint8_t kKindMask = 3;
+const uint8_t kLocalRoot = 4;
+
+// Component flags, kept on roots
+const uint8_t kHasStrong = 1;  // on global roots: some pixel of the component is strong
+const uint8_t kIsEdge = 2;     // on band-local roots: their global component has kHasStrong
+
+struct Scratch {
+    cv::Mat state;
+    // Union-find parent of every candidate pixel, by pixel index; other entries are unused.
+    // After a band is labelled its pixels point straight at their band-local root.
+    std::unique_ptr<std::atomic<int>[]> parent;
+    std::unique_ptr<std::atomic<uint8_t>[]> flags;
+    size_t capacity = 0;
+    // Band-local roots of each band
+    std::vector<std::vector<int>> roots;
+
+    void reserve(int rows, int cols, int bands) {
+        state.create(rows, cols, CV_8UC1);
+        size_t pixels = static_cast<size_t>(rows) * cols;
+        if (pixels > capacity) {
+            parent.reset(new std::atomic<int>[pixels]);
+            flags.reset(new std::atomic<uint8_t>[pixels]);
+            capacity = pixels;
+        }
+        roots.resize(std::max(roots.size(), static_cast<size_t>(bands)));
+    }
+};
+
+// Root with path halving. Only roots are ever relinked, so a halving store always
+// points at an ancestor and stays valid while other bands merge.
+inline int findRoot(std::atomic<int>* parent, int x) {
+    int p = parent[x].load(std::memory_order_relaxed);
+    while (p != x) {
+        int grand = parent[p].load(std::memory_order_relaxed);
+        if (grand != p) {
+            parent[x].store(grand, std::memory_order_relaxed);
+        }
+        x = p;
+        p = grand;
+    }
+    return x;
+}
+
+// Inside a band only its own task touches the parents, so a plain store links roots
+inline void uniteLocal(std::atomic<int>* parent, int a, int b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a != b) {
+        parent[std::max(a, b)].store(std::min(a, b), std::memory_order_relaxed);
+    }
+}
+
+// Across bands: link the larger root under the smaller. A failed CAS means another
+// seam linked that root first, so retry from the new roots.
+inline void unite(std::atomic<int>* parent, int a, int b) {
+    for (;;) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b) {
+            return;
+        }
+        if (a < b) {
+            std::swap(a, b);
+        }
+        int expected = a;
+        if (parent[a].compare_exchange_weak(expected, b, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+// Gradient magnitude of row y with a zero column on each side; rows outside the
+// image are all zero, as in cv::Canny
+void magnitudeRow(const cv::Mat& dx, const cv::Mat& dy, int y, bool L2, int* mag) {
+    const int cols = dx.cols;
+    mag[-1] = mag[cols] = 0;
+    if (y < 0 || y >= dx.rows) {
+        std::fill(mag, mag + cols, 0);
+        return;
+    }
+    const short* gx = dx.ptr<short>(y);
+    const short* gy = dy.ptr<short>(y);
+    int x = 0;
+#if CV_SIMD
+    const int lanes = cv::VTraits<cv::v_int16>::vlanes();
+    const int half = cv::VTraits<cv::v_int32>::vlanes();
+    for (; x + lanes <= cols; x += lanes) {
+        cv::v_int32 x0, x1, y0, y1;
+        cv::v_expand(cv::vx_load(gx + x), x0, x1);
+        cv::v_expand(cv::vx_load(gy + x), y0, y1);
+        if (L2) {
+            cv::v_store(mag + x, cv::v_add(cv::v_mul(x0, x0), cv::v_mul(y0, y0)));
+            cv::v_store(mag + x + half, cv::v_add(cv::v_mul(x1, x1), cv::v_mul(y1, y1)));
+        } else {
+            cv::v_store(mag + x, cv::v_reinterpret_as_s32(cv::v_add(cv::v_abs(x0), cv::v_abs(y0))));
+            cv::v_store(mag + x + half, cv::v_reinterpret_as_s32(cv::v_add(cv::v_abs(x1), cv::v_abs(y1))));
+        }
+    }
+#endif
+    for (; x < cols; x++) {
+        mag[x] = L2 ? static_cast<int>(gx[x]) * gx[x] + static_cast<int>(gy[x]) * gy[x]
+                    : std::abs(static_cast<int>(gx[x])) + std::abs(static_cast<int>(gy[x]));
+    }
+}
+
+// Non-maximum suppression and labelling of rows [rowBegin, rowEnd). Only this band's
+// pixels are touched, so bands run concurrently.
+void labelBand(const cv::Mat& dx, const cv::Mat& dy, Scratch& s, int low, int high, bool L2,
+               int band, int rowBegin, int rowEnd) {
+    const int cols = dx.cols;
+    std::vector<int> buffer(3 * static_cast<size_t>(cols + 2));
+    int* prev = buffer.data() + 1;
+    int* cur = prev + cols + 2;
+    int* next = cur + cols + 2;
+    magnitudeRow(dx, dy, rowBegin - 1, L2, prev);
+    magnitudeRow(dx, dy, rowBegin, L2, cur);
+    std::atomic<int>* parent = s.parent.get();
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        magnitudeRow(dx, dy, y + 1, L2, next);
+        const short* gx = dx.ptr<short>(y);
+        const short* gy = dy.ptr<short>(y);
+        uint8_t* state = s.state.ptr<uint8_t>(y);
+        const uint8_t* above = y > rowBegin ? s.state.ptr<uint8_t>(y - 1) : nullptr;
+        const int base = y * cols;
+        std::memset(state, kNone, cols);
+
+        auto visit = [&](int x) {
+            int m = cur[x];
+            if (m <= low) {
+                return;
+            }
+            // Same comparisons (including which side is strict) as cv::Canny
+            int xs = gx[x];
+            int ys = gy[x];
+            int ax = std::abs(xs);
+            int ay = std::abs(ys) << kCannyShift;
+            int tg22x = ax * kTan22;
+            bool peak;
+            if (ay < tg22x) {
+                peak = m > cur[x - 1] && m >= cur[x + 1];
+            } else {
+                int tg67x = tg22x + (ax << (kCannyShift + 1));
+                if (ay > tg67x) {
+                    peak = m > prev[x] && m >= next[x];
+                } else {
+                    int sign = (xs ^ ys) < 0 ? -1 : 1;
+                    peak = m > prev[x - sign] && m > next[x + sign];
+                }
+            }
+            if (!peak) {
+                return;
+            }
+            state[x] = m > high ? kStrong : kWeak;
+
+            // First labelling pass: link to the 8-neighbours already visited
+            int index = base + x;
+            parent[index].store(index, std::memory_order_relaxed);
+            if (x > 0 && state[x - 1] != kNone) {
+                uniteLocal(parent, index, index - 1);
+            }
+            if (above) {
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, cols - 1); nx++) {
+                    if (above[nx] != kNone) {
+                        uniteLocal(parent, index, index - cols + nx - x);
+                    }
+                }
+            }
+        };
+
+        int x = 0;
+#if CV_SIMD
+        // Most pixels are below the low threshold; skip them a vector at a time
+        const int lanes = cv::VTraits<cv::v_int32>::vlanes();
+        const cv::v_int32 vlow = cv::vx_setall_s32(low);
+        for (; x + lanes <= cols; x += lanes) {
+            if (cv::v_check_any(cv::v_gt(cv::vx_load(cur + x), vlow))) {
+                for (int k = x; k < x + lanes; k++) {
+                    visit(k);
+                }
+            }
+        }
+#endif
+        for (; x < cols; x++) {
+            visit(x);
+        }
+        std::swap(prev, cur);
+        std::swap(cur, next);
+    }
+
+    // Second pass: point every pixel at its band-local root and collect the roots with
+    // whether their component has a strong pixel
+    std::vector<int>& roots = s.roots[band];
+    roots.clear();
+    for (int y = rowBegin; y < rowEnd; y++) {
+        uint8_t* state = s.state.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; x++) {
+            if (state[x] == kNone) {
+                continue;
+            }
+            int index = y * cols + x;
+            int root = findRoot(parent, index);
+            if (root == index) {
+                state[x] |= kLocalRoot;
+                roots.push_back(index);
+                s.flags[index].store(0, std::memory_order_relaxed);
+            } else {
+                parent[index].store(root, std::memory_order_relaxed);
+            }
+            if ((state[x] & kKindMask) == kStrong) {
+                // Roots precede their pixels in raster order, so the flag was reset already
+                s.flags[root].store(kHasStrong, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// Band-local root of a labelled candidate. Cross-band finds start from these, so the
+// pixels keep pointing at their band-local root and the output pass can rely on it.
+inline int localRoot(const Scratch& s, uint8_t state, int index) {
+    return (state & kLocalRoot) ? index : s.parent[index].load(std::memory_order_relaxed);
+}
+
+// Link the first row of a band to the last row of the band above
+void mergeSeam(Scratch& s, int row) {
+    const int cols = s.state.cols;
+    const uint8_t* state = s.state.ptr<uint8_t>(row);
+    const uint8_t* above = s.state.ptr<uint8_t>(row - 1);
+    std::atomic<int>* parent = s.parent.get();
+    for (int x = 0; x < cols; x++) {
+        if (state[x] == kNone) {
+            continue;
+        }
+        int index = row * cols + x;
+        int root = localRoot(s, state[x], index);
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, cols - 1); nx++) {
+            if (above[nx] != kNone) {
+                unite(parent, root, localRoot(s, above[nx], (row - 1) * cols + nx));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void UnionFindCanny::run(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, double low, double high, bool L2) {
+    run(dx, dy, edges, low, high, L2, TaskScheduler::instance());
+}
+
+void UnionFindCanny::run(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, double lowThresh,
+                         double highThresh, bool L2, TaskScheduler& scheduler) {
+    CV_Assert(dx.type() == CV_16SC1 && dy.type() == CV_16SC1 && dx.size() == dy.size());
+    const int rows = dx.rows;
+    const int cols = dx.cols;
+    edges.create(dx.size(), CV_8UC1);
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    // Thresholds exactly as cv::Canny derives them
+    if (lowThresh > highThresh) {
+        std::swap(lowThresh, highThresh);
+    }
+    if (L2) {
+        lowThresh = std::min(32767.0, lowThresh);
+        highThresh = std::min(32767.0, highThresh);
+        if (lowThresh > 0) {
+            lowThresh *= lowThresh;
+        }
+        if (highThresh > 0) {
+            highThresh *= highThresh;
+        }
+    }
+    const int low = cvFloor(lowThresh);
+    const int high = cvFloor(highThresh);
+
+    const int bands = (rows + kBandRows - 1) / kBandRows;
+    thread_local Scratch scratch;
+    scratch.reserve(rows, cols, bands);
+    // Tasks run on other threads, which must see this thread's scratch
+    Scratch* s = &scratch;
+    std::atomic<int>* parent = s->parent.get();
+    std::atomic<uint8_t>* flags = s->flags.get();
+
+    scheduler.parallelFor(0, bands, 1, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            labelBand(dx, dy, *s, low, high, L2, b, b * kBandRows, std::min(rows, (b + 1) * kBandRows));
+        }
+    });
+    scheduler.parallelFor(1, bands, 1, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            mergeSeam(*s, b * kBandRows);
+        }
+    });
+    // Strong components pass their flag up to the global root...
+    scheduler.parallelFor(0, bands, 1, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            for (int root : s->roots[b]) {
+                if (flags[root].load(std::memory_order_relaxed) & kHasStrong) {
+                    int global = findRoot(parent, root);
+                    if (global != root) {
+                        flags[global].fetch_or(kHasStrong, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+    });
+    // ...and every band-local root reads it back once, so its pixels need no find
+    scheduler.parallelFor(0, bands, 1, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            for (int root : s->roots[b]) {
+                if (flags[findRoot(parent, root)].load(std::memory_order_relaxed) & kHasStrong) {
+                    flags[root].fetch_or(kIsEdge, std::memory_order_relaxed);
+                }
+            }
+            for (int y = b * kBandRows; y < std::min(rows, (b + 1) * kBandRows); y++) {
+                const uint8_t* state = s->state.ptr<uint8_t>(y);
+                uint8_t* out = edges.ptr<uint8_t>(y);
+                for (int x = 0; x < cols; x++) {
+                    uint8_t st = state[x];
+                    if (st == kNone) {
+                        out[x] = 0;
+                        continue;
+                    }
+                    int root = localRoot(*s, st, y * cols + x);
+                    out[x] = (flags[root].load(std::memory_order_relaxed) & kIsEdge) ? 255 : 0;
+                }
+            }
+        }
+    });
+}
+
+namespace {
+
+thread_local cv::Mat lastDx;
+thread_local cv::Mat lastDy;
+
+}  // namespace
+
+void UnionFindCanny::rememberGradients(const cv::Mat& dx, const cv::Mat& dy) {
+    lastDx = dx;
+    lastDy = dy;
+}
+
+bool UnionFindCanny::lastGradients(cv::Mat& dx, cv::Mat& dy) {
+    if (lastDx.empty()) {
+        return false;
+    }
+    dx = lastDx;
+    dy = lastDy;
+    return true;
+}
+
+void UnionFindCanny::clearLastGradients() {
+    lastDx.release();
+    lastDy.release();
+}
+
+void UnionFindCanny::fromGradients(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, const StreamParams& p) {
+    rememberGradients(dx, dy);
+    if (p.hysteresis == HysteresisEngine::UnionFind) {
+        run(dx, dy, edges, p.lowThreshold, p.highThreshold, p.cannyL2);
+    } else {
+        cv::Canny(dx, dy, edges, p.lowThreshold, p.highThreshold, p.cannyL2);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef UNION_FIND_CANNY_H
+#define UNION_FIND_CANNY_H
+
+#include <opencv2/core.hpp>
+#include <string>
+
+class TaskScheduler;
+struct StreamParams;
+
+// How Canny links weak edge pixels to strong ones
+enum class HysteresisEngine {
+    OpenCV,     // cv::Canny's stack-based flood fill
+    UnionFind,  // parallel connected components (UnionFindCanny)
+};
+
+const char* hysteresisEngineName(HysteresisEngine engine);
+bool parseHysteresisEngine(const std::string& name, HysteresisEngine& engine);
+
+// Canny with hysteresis as parallel union-find connected components.
+//
+// Row bands run on the TaskScheduler. Each band computes the magnitudes and
+// non-maximum suppression exactly as cv::Canny does and labels its weak and strong
+// candidates with a two-row-window union-find pass. The band seams are then merged
+// concurrently with compare-and-swap links (roots always link to a smaller index,
+// so no locks and no cycles). A component survives when any of its pixels is
+// strong, which is the set cv::Canny's flood fill reaches, so the output is
+// identical to cv::Canny(dx, dy, ...).
+class UnionFindCanny {
+public:
+    // Same result as cv::Canny(dx, dy, edges, low, high, L2) for CV_16SC1 gradients;
+    // `edges` is allocated unless it already has the right size
+    static void run(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, double low, double high, bool L2);
+    static void run(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, double low, double high, bool L2,
+                    TaskScheduler& scheduler);
+
+    // Canny from precomputed gradients with the stream's thresholds, norm and hysteresis engine.
+    // Remembers the gradients for stages that run after detection (see lastGradients).
+    static void fromGradients(const cv::Mat& dx, const cv::Mat& dy, cv::Mat& edges, const StreamParams& params);
+
+    // Gradients the last Canny on this thread started from, as views of the detecting
+    // path's own buffers, so later stages reuse them instead of recomputing. Empty when
+    // that Canny computed its gradients internally, or after clearLastGradients().
+    // Valid until the thread detects again.
+    static void rememberGradients(const cv::Mat& dx, const cv::Mat& dy);
+    static bool lastGradients(cv::Mat& dx, cv::Mat& dy);
+    static void clearLastGradients();
+};
+
+#endif // UNION_FIND_CANNY_H
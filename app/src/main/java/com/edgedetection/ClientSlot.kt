@@ -0,0 +1,174 @@
+package com.edgedetection
+
+import java.io.InputStream
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Per-connection send slot for streaming clients.
+ *
+ * Holds at most one pending frame. Publishing a new frame while the previous one
+ * has not been picked up replaces it (latest-frame-wins) and counts a drop, so a
+ * slow client never stalls other clients and never holds more than one pending
+ * plus one in-flight frame regardless of how far behind it is.
+ */
+class ClientSlot(val id: Int, val remote: String) {
+
+    class Frame(val bytes: ByteArray, val publishedAtNs: Long, val info: LongArray? = null)
+
+    private val lock = Object()
+    private var pending: Frame? = null
+    @Volatile private var closed = false
+
+    val sentFrames = AtomicLong(0)
+    val droppedFrames = AtomicLong(0)
+    // Send latency: time from taking a frame out of the slot until the socket asked for the next one
+    @Volatile var lastSendMs: Double = 0.0
+        private set
+    @Volatile var avgSendMs: Double = 0.0
+        private set
+    // Age of the frame when it was taken out of the slot
+    @Volatile var lastQueueMs: Double = 0.0
+        private set
+
+    val isClosed: Boolean
+        get() = closed
+
+    fun offer(frame: Frame) {
+        synchronized(lock) {
+            if (closed) return
+            if (pending != null) {
+                droppedFrames.incrementAndGet()
+            }
+            pending = frame
+            lock.notifyAll()
+        }
+    }
+
+    // Blocks until a frame is available, the slot is closed or the timeout expires
+    fun take(timeoutMs: Long): Frame? {
+        synchronized(lock) {
+            val deadline = System.currentTimeMillis() + timeoutMs
+            while (pending == null && !closed) {
+                val remaining = deadline - System.currentTimeMillis()
+                if (remaining <= 0) return null
+                lock.wait(remaining)
+            }
+            val frame = pending
+            pending = null
+            if (frame != null) {
+                lastQueueMs = (System.nanoTime() - frame.publishedAtNs) / 1_000_000.0
+            }
+            return frame
+        }
+    }
+
+    fun recordSent(sendNs: Long) {
+        val ms = sendNs / 1_000_000.0
+        lastSendMs = ms
+        // Exponential moving average keeps the stat stable without storing history
+        avgSendMs = if (sentFrames.get() == 0L) ms else avgSendMs * 0.9 + ms * 0.1
+        sentFrames.incrementAndGet()
+    }
+
+    fun close() {
+        synchronized(lock) {
+            closed = true
+            pending = null
+            lock.notifyAll()
+        }
+    }
+
+    fun toJson(): String {
+        return "{\"id\":$id,\"remote\":\"$remote\",\"sent\":${sentFrames.get()}," +
+            "\"dropped\":${droppedFrames.get()},\"lastSendMs\":${"%.2f".format(lastSendMs)}," +
+            "\"avgSendMs\":${"%.2f".format(avgSendMs)},\"lastQueueMs\":${"%.2f".format(lastQueueMs)}}"
+    }
+}
+
+/**
+ * multipart/x-mixed-replace body fed from a [ClientSlot].
+ *
+ * NanoHTTPD pulls from this stream on the client's own connection thread, so
+ * blocking here only ever blocks that one client.
+ */
+class MjpegStream(
+    private val slot: ClientSlot,
+    private val onClose: (ClientSlot) -> Unit
+) : InputStream() {
+    companion object {
+        const val BOUNDARY = "edgeframe"
+        private const val IDLE_TIMEOUT_MS = 30_000L
+        private val TRAILER = "\r\n".toByteArray()
+    }
+
+    private var header: ByteArray = ByteArray(0)
+    private var body: ByteArray = ByteArray(0)
+    private var segment = 3 // 0 = header, 1 = body, 2 = trailer, 3 = need next frame
+    private var pos = 0
+    private var takenAtNs = 0L
+    private var closedOnce = false
+
+    private fun nextFrame(): Boolean {
+        if (takenAtNs != 0L) {
+            // Previous part has been fully handed to the socket
+            slot.recordSent(System.nanoTime() - takenAtNs)
+            takenAtNs = 0L
+        }
+        val deadline = System.currentTimeMillis() + IDLE_TIMEOUT_MS
+        while (!slot.isClosed) {
+            val frame = slot.take(1000)
+            if (frame != null) {
+                takenAtNs = System.nanoTime()
+                // Frame metadata travels as per-part headers
+                val meta = FrameServer.frameHeaders(frame.info).joinToString("") { (name, value) -> "$name: $value\r\n" }
+                header = ("--$BOUNDARY\r\nContent-Type: image/jpeg\r\n" +
+                    "Content-Length: ${frame.bytes.size}\r\n$meta\r\n").toByteArray()
+                body = frame.bytes
+                segment = 0
+                pos = 0
+                return true
+            }
+            if (System.currentTimeMillis() > deadline) break
+        }
+        return false
+    }
+
+    private fun current(): ByteArray = when (segment) {
+        0 -> header
+        1 -> body
+        else -> TRAILER
+    }
+
+    override fun read(): Int {
+        val one = ByteArray(1)
+        val n = read(one, 0, 1)
+        return if (n <= 0) -1 else (one[0].toInt() and 0xFF)
+    }
+
+    override fun read(b: ByteArray, off: Int, len: Int): Int {
+        if (len == 0) return 0
+        while (segment == 3 || pos >= current().size) {
+            if (segment == 3 || segment == 2) {
+                if (!nextFrame()) {
+                    close()
+                    return -1
+                }
+            } else {
+                segment++
+                pos = 0
+            }
+        }
+        val src = current()
+        val n = minOf(len, src.size - pos)
+        System.arraycopy(src, pos, b, off, n)
+        pos += n
+        return n
+    }
+
+    override fun close() {
+        if (closedOnce) return
+        closedOnce = true
+        slot.close()
+        onClose(slot)
+    }
+}
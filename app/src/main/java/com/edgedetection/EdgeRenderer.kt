@@ -533,8 +533,10 @@ class EdgeRenderer : GLSurfaceView.Renderer {
         }
     }
 
-    fun updateProcessedFrame(frameData: ByteArray, width: Int, height: Int) {
+    // Returns the frame this one replaces, which the renderer no longer reads
+    fun updateProcessedFrame(frameData: ByteArray, width: Int, height: Int): ByteArray? {
         synchronized(this) {
+            val previous = pendingProcessedFrameData
             try {
                 pendingProcessedFrameData = frameData
                 frameWidth = width
@@ -546,6 +548,7 @@ class EdgeRenderer : GLSurfaceView.Renderer {
                 Log.e(TAG, "updateProcessedFrame error: ${t.message}")
                 isProcessedFrameReady = false
             }
+            return if (previous !== frameData) previous else null
         }
     }
 
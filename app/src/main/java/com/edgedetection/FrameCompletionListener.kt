@@ -0,0 +1,7 @@
+package com.edgedetection
+
+// Receives processed frames on the native completion thread (see MainActivity.startAsyncProcessing).
+// `edges` may be handed back with MainActivity.releaseProcessedFrame once it is no longer read.
+interface FrameCompletionListener {
+    fun onFrameProcessed(ticket: Long, edges: ByteArray, width: Int, height: Int)
+}
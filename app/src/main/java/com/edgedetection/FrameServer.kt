@@ -1,27 +1,133 @@
 package com.edgedetection
 
+import android.os.SystemClock
 import android.util.Log
 import fi.iki.elonen.NanoHTTPD
 import fi.iki.elonen.NanoHTTPD.IHTTPSession
 import fi.iki.elonen.NanoHTTPD.Response
 import fi.iki.elonen.NanoHTTPD.Method
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
 import java.util.concurrent.atomic.AtomicReference
 
 class FrameServer(port: Int) : NanoHTTPD(port) {
     companion object {
         private const val TAG = "FrameServer"
+        // Each streaming client holds at most one pending + one in-flight frame
+        private const val MAX_STREAM_CLIENTS = 8
+        // A polling viewer counts as subscribed for this long after its last frame request
+        private const val VIEWER_TIMEOUT_MS = 3000L
+        // Legacy single-stream endpoints map to the camera preview stream
+        const val PRIMARY_STREAM_ID = 0
+        // Stream fed by the app's SyntheticFrameSource while "syntheticStream" is on
+        const val SYNTHETIC_STREAM_ID = 1
+        // Native frame info layout: [width, height, generation, frameId, sensorNs, enqueueNs,
+        // processStartNs, processEndNs, encodeEndNs]; timestamps on elapsedRealtimeNanos()
+        const val FRAME_INFO_SIZE = 9
+        private val FRAME_INFO_HEADERS = arrayOf(
+            "X-Frame-Width", "X-Frame-Height", "X-Frame-Generation", "X-Frame-Id",
+            "X-Frame-Sensor-Ns", "X-Frame-Enqueue-Ns", "X-Frame-Process-Start-Ns",
+            "X-Frame-Process-End-Ns", "X-Frame-Encode-End-Ns"
+        )
+        private const val SERVER_TIME_HEADER = "X-Server-Time-Ns"
+
+        // Frame metadata as header name/value pairs; zero (unrecorded) timestamps are omitted
+        fun frameHeaders(info: LongArray?): List<Pair<String, String>> {
+            val headers = ArrayList<Pair<String, String>>()
+            if (info != null) {
+                for (i in 0 until minOf(info.size, FRAME_INFO_SIZE)) {
+                    if (i < 3 || info[i] != 0L) {
+                        headers.add(FRAME_INFO_HEADERS[i] to info[i].toString())
+                    }
+                }
+            }
+            headers.add(SERVER_TIME_HEADER to SystemClock.elapsedRealtimeNanos().toString())
+            return headers
+        }
     }
 
-    // Callback to apply settings received from web viewer
-    var onSettings: ((Int, Int, Boolean) -> Unit)? = null
+    // Callback to apply settings received from web viewer: (low, high, edgesEnabled), each
+    // null when absent from the body so the current value is kept
+    var onSettings: ((Int?, Int?, Boolean?) -> Unit)? = null
+    // Per-stream thresholds from /stream/{id}/settings: (streamId, low, high), null when absent
+    var onStreamSettings: ((Int, Int?, Int?) -> Unit)? = null
+    // Optional "budgetMs" in /settings or /stream/{id}/settings: (streamId, budgetMs)
+    var onFrameBudget: ((Int, Int) -> Unit)? = null
+    // Optional "placement" in /settings: native thread placement policy name
+    var onPlacement: ((String) -> Unit)? = null
+    // Optional "syntheticStream" in /settings: start/stop the test-pattern source of SYNTHETIC_STREAM_ID
+    var onSyntheticStream: ((Boolean) -> Unit)? = null
+    // Optional "engine" in /settings or /stream/{id}/settings: (streamId, engine name)
+    var onEngine: ((Int, String) -> Unit)? = null
+    // Optional "detector" in /settings or /stream/{id}/settings: (streamId, detector name)
+    var onDetector: ((Int, String) -> Unit)? = null
+    // Optional "hysteresis" in /settings or /stream/{id}/settings: (streamId, hysteresis engine name)
+    var onHysteresis: ((Int, String) -> Unit)? = null
+    // Optional "contourEpsilon" in /settings or /stream/{id}/settings: (streamId, epsilon in pixels)
+    var onContourEpsilon: ((Int, Double) -> Unit)? = null
+    // Optional "segments" in /settings or /stream/{id}/settings: (streamId, enabled)
+    var onSegments: ((Int, Boolean) -> Unit)? = null
+    // Optional "stabilize" in /settings or /stream/{id}/settings: (streamId, persistence frames)
+    var onStabilize: ((Int, Int) -> Unit)? = null
+    // Optional "colorEdges" in /settings or /stream/{id}/settings: (streamId, enabled)
+    var onColorEdges: ((Int, Boolean) -> Unit)? = null
+    // Optional "statsGridCols" + "statsGridRows" in /settings or /stream/{id}/settings: (streamId, cols, rows)
+    var onStatsGrid: ((Int, Int, Int) -> Unit)? = null
+    // Native per-stream frame providers; fill info (FRAME_INFO_SIZE) with geometry and timing
+    var jpegProvider: ((Int, LongArray) -> ByteArray?)? = null
+    var pngProvider: ((Int, LongArray) -> ByteArray?)? = null
+    var packedProvider: ((Int, LongArray) -> ByteArray?)? = null
+    var contoursProvider: ((Int, LongArray) -> ByteArray?)? = null
+    // Native stream registry: ids and per-stream status JSON
+    var streamsProvider: (() -> IntArray)? = null
+    var streamStatusProvider: ((Int) -> String?)? = null
+    // Tracked line segments per stream (JSON)
+    var segmentsProvider: ((Int) -> String?)? = null
+    // Statistics of a stream's latest edge map (JSON)
+    var edgeStatsProvider: ((Int) -> String?)? = null
+    // Camera-to-processing frame ring counters (JSON)
+    var ingestStatsProvider: (() -> String?)? = null
+    // Native buffer pool usage (JSON)
+    var memoryStatsProvider: (() -> String?)? = null
+    // Native thread placement: CPU topology, policy and pinned threads (JSON)
+    var placementStatsProvider: (() -> String?)? = null
 
     // Latest processed frame as JPEG bytes
     private val latestJpeg: AtomicReference<ByteArray?> = AtomicReference(null)
+    private val latestJpegInfo: AtomicReference<LongArray?> = AtomicReference(null)
     // Latest status text
     private val latestStatus: AtomicReference<String> = AtomicReference("idle")
+    // Streaming clients, each with its own latest-frame-wins send slot
+    private val clients = ConcurrentHashMap<Int, ClientSlot>()
+    private val nextClientId = AtomicInteger(1)
+    @Volatile private var lastFramePollMs = 0L
 
-    fun updateFrameJpeg(jpeg: ByteArray?) {
+    fun updateFrameJpeg(jpeg: ByteArray?, info: LongArray? = null) {
+        latestJpegInfo.set(info)
         latestJpeg.set(jpeg)
+        if (jpeg == null || clients.isEmpty()) return
+        val frame = ClientSlot.Frame(jpeg, System.nanoTime(), info)
+        for (slot in clients.values) {
+            slot.offer(frame)
+        }
+    }
+
+    fun streamClientCount(): Int = clients.size
+
+    // True while a stream client is connected or /frame.jpg was polled recently
+    fun hasViewers(): Boolean {
+        return clients.isNotEmpty() || System.currentTimeMillis() - lastFramePollMs < VIEWER_TIMEOUT_MS
+    }
+
+    override fun stop() {
+        // Wake up blocked streaming clients so their connection threads can exit
+        synchronized(clients) {
+            for (slot in clients.values) {
+                slot.close()
+            }
+            clients.clear()
+        }
+        super.stop()
     }
 
     fun updateStatus(status: String) {
@@ -39,9 +145,16 @@ class FrameServer(port: Int) : NanoHTTPD(port) {
             val uri = session.uri
             when (uri) {
                 "/frame.jpg" -> serveFrame()
+                "/frame.png" -> serveNativeFrame(pngProvider, PRIMARY_STREAM_ID, "image/png")
+                "/frame.bin" -> serveNativeFrame(packedProvider, PRIMARY_STREAM_ID, "application/octet-stream")
+                "/contours" -> serveNativeFrame(contoursProvider, PRIMARY_STREAM_ID, "application/octet-stream")
+                "/segments" -> serveSegments(PRIMARY_STREAM_ID)
+                "/streams" -> serveStreams()
+                "/stream.mjpeg" -> serveStream(session)
+                "/clients" -> serveClients()
                 "/status" -> serveStatus()
                 "/settings" -> handleSettings(session)
-                else -> okText("Edge server running")
+                else -> if (uri.startsWith("/stream/")) serveStreamRoute(session, uri) else okText("Edge server running")
             }
         } catch (t: Throwable) {
             Log.e(TAG, "serve error: ${t.message}")
@@ -56,25 +169,178 @@ class FrameServer(port: Int) : NanoHTTPD(port) {
     }
 
     private fun serveStatus(): Response {
-        val res = newFixedLengthResponse(Response.Status.OK, "application/json", "{\"status\":\"${latestStatus.get()}\"}")
+        val ingest = ingestStatsProvider?.invoke()?.let { ",\"ingest\":$it" } ?: ""
+        val memory = memoryStatsProvider?.invoke()?.let { ",\"memory\":$it" } ?: ""
+        val placement = placementStatsProvider?.invoke()?.let { ",\"placement\":$it" } ?: ""
+        val edges = edgeStatsProvider?.invoke(PRIMARY_STREAM_ID)?.let { ",\"edges\":$it" } ?: ""
+        val res = newFixedLengthResponse(Response.Status.OK, "application/json",
+            "{\"status\":\"${latestStatus.get()}\",\"streamClients\":${clients.size}$ingest$memory$placement$edges}")
+        addCors(res)
+        return res
+    }
+
+    private fun serveClients(): Response {
+        val body = clients.values.sortedBy { it.id }.joinToString(",", "[", "]") { it.toJson() }
+        val res = newFixedLengthResponse(Response.Status.OK, "application/json", body)
+        addCors(res)
+        return res
+    }
+
+    private fun serveStream(session: IHTTPSession): Response {
+        // Check and add under one lock so concurrent connects cannot overshoot the limit
+        val slot = synchronized(clients) {
+            if (clients.size >= MAX_STREAM_CLIENTS) {
+                null
+            } else {
+                ClientSlot(nextClientId.getAndIncrement(), session.remoteIpAddress ?: "?").also { clients[it.id] = it }
+            }
+        }
+        if (slot == null) {
+            val res = newFixedLengthResponse(Response.Status.SERVICE_UNAVAILABLE, "text/plain", "too many clients")
+            addCors(res)
+            return res
+        }
+        Log.i(TAG, "stream client ${slot.id} connected from ${slot.remote}")
+        // Prime the slot so the client sees a frame immediately
+        latestJpeg.get()?.let { slot.offer(ClientSlot.Frame(it, System.nanoTime(), latestJpegInfo.get())) }
+        val stream = MjpegStream(slot) { closed ->
+            clients.remove(closed.id)
+            Log.i(TAG, "stream client ${closed.id} disconnected: sent=${closed.sentFrames.get()}, dropped=${closed.droppedFrames.get()}")
+        }
+        val res = newChunkedResponse(Response.Status.OK, "multipart/x-mixed-replace; boundary=${MjpegStream.BOUNDARY}", stream)
+        res.addHeader("Cache-Control", "no-cache")
         addCors(res)
         return res
     }
 
     private fun serveFrame(): Response {
+        lastFramePollMs = System.currentTimeMillis()
         val data = latestJpeg.get()
         if (data == null) {
             val res = newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "no frame")
             addCors(res)
             return res
         }
+        val info = latestJpegInfo.get()
         val res = newFixedLengthResponse(Response.Status.OK, "image/jpeg", data.inputStream(), data.size.toLong())
+        for ((name, value) in frameHeaders(info)) {
+            res.addHeader(name, value)
+        }
+        addCors(res)
+        return res
+    }
+
+    private fun serveStreams(): Response {
+        val ids = streamsProvider?.invoke() ?: IntArray(0)
+        val body = ids.joinToString(",", "[", "]") { streamStatusProvider?.invoke(it) ?: "{\"id\":$it}" }
+        val res = newFixedLengthResponse(Response.Status.OK, "application/json", body)
+        addCors(res)
+        return res
+    }
+
+    // /stream/{id}/frame.jpg | frame.png | frame.bin | contours | segments | status | settings
+    private fun serveStreamRoute(session: IHTTPSession, uri: String): Response {
+        val parts = uri.removePrefix("/stream/").split("/")
+        val id = parts[0].toIntOrNull()
+        if (id == null) {
+            val res = newFixedLengthResponse(Response.Status.BAD_REQUEST, "text/plain", "bad stream id")
+            addCors(res)
+            return res
+        }
+        return when (parts.getOrNull(1) ?: "status") {
+            "frame.jpg" -> serveNativeFrame(jpegProvider, id, "image/jpeg")
+            "frame.png" -> serveNativeFrame(pngProvider, id, "image/png")
+            "frame.bin" -> serveNativeFrame(packedProvider, id, "application/octet-stream")
+            "contours" -> serveNativeFrame(contoursProvider, id, "application/octet-stream")
+            "segments" -> serveSegments(id)
+            "settings" -> handleStreamSettings(session, id)
+            "status" -> {
+                val json = streamStatusProvider?.invoke(id)
+                val res = if (json != null) {
+                    newFixedLengthResponse(Response.Status.OK, "application/json", json)
+                } else {
+                    newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "no such stream")
+                }
+                addCors(res)
+                res
+            }
+            else -> {
+                val res = newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "not found")
+                addCors(res)
+                res
+            }
+        }
+    }
+
+    private fun handleStreamSettings(session: IHTTPSession, id: Int): Response {
+        return try {
+            val map = HashMap<String, String>()
+            session.parseBody(map)
+            val body = map["postData"] ?: ""
+            val low = extractInt(body, "lowThreshold")
+            val high = extractInt(body, "highThreshold")
+            if (low != null || high != null) {
+                onStreamSettings?.invoke(id, low, high)
+            }
+            extractInt(body, "budgetMs")?.let { onFrameBudget?.invoke(id, it) }
+            extractString(body, "engine")?.let { onEngine?.invoke(id, it) }
+            extractString(body, "detector")?.let { onDetector?.invoke(id, it) }
+            extractString(body, "hysteresis")?.let { onHysteresis?.invoke(id, it) }
+            extractDouble(body, "contourEpsilon")?.let { onContourEpsilon?.invoke(id, it) }
+            extractBoolean(body, "segments")?.let { onSegments?.invoke(id, it) }
+            extractInt(body, "stabilize")?.let { onStabilize?.invoke(id, it) }
+            extractBoolean(body, "colorEdges")?.let { onColorEdges?.invoke(id, it) }
+            applyStatsGrid(body, id)
+            val res = newFixedLengthResponse(Response.Status.OK, "application/json", "{\"ok\":true}")
+            addCors(res)
+            res
+        } catch (t: Throwable) {
+            Log.e(TAG, "handleStreamSettings error: ${t.message}")
+            val res = newFixedLengthResponse(Response.Status.BAD_REQUEST, "application/json", "{\"ok\":false}")
+            addCors(res)
+            res
+        }
+    }
+
+    // The grid is set as a whole, so both dimensions are required
+    private fun applyStatsGrid(body: String, id: Int) {
+        val cols = extractInt(body, "statsGridCols") ?: return
+        val rows = extractInt(body, "statsGridRows") ?: return
+        onStatsGrid?.invoke(id, cols, rows)
+    }
+
+    private fun serveSegments(id: Int): Response {
+        val json = segmentsProvider?.invoke(id)
+        val res = when {
+            json == null -> newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "no such stream")
+            // Native returns nothing while the segment stage is off
+            json.isEmpty() -> newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "segment stage is off")
+            else -> newFixedLengthResponse(Response.Status.OK, "application/json", json)
+        }
+        res.addHeader("Cache-Control", "no-cache")
+        addCors(res)
+        return res
+    }
+
+    private fun serveNativeFrame(provider: ((Int, LongArray) -> ByteArray?)?, streamId: Int, mime: String): Response {
+        val info = LongArray(FRAME_INFO_SIZE)
+        val data = provider?.invoke(streamId, info)
+        if (data == null) {
+            val res = newFixedLengthResponse(Response.Status.NOT_FOUND, "text/plain", "no frame")
+            addCors(res)
+            return res
+        }
+        val res = newFixedLengthResponse(Response.Status.OK, mime, data.inputStream(), data.size.toLong())
+        for ((name, value) in frameHeaders(info)) {
+            res.addHeader(name, value)
+        }
+        res.addHeader("Cache-Control", "no-cache")
         addCors(res)
         return res
     }
 
     private fun handleSettings(session: IHTTPSession): Response {
-        // Accept JSON with lowThreshold, highThreshold, edgesEnabled
+        // Partial JSON updates: only the fields present in the body are applied (see README)
         return try {
             val map = HashMap<String, String>()
             session.parseBody(map)
@@ -83,7 +349,20 @@ class FrameServer(port: Int) : NanoHTTPD(port) {
             val low = extractInt(body, "lowThreshold")
             val high = extractInt(body, "highThreshold")
             val enabled = extractBoolean(body, "edgesEnabled")
-            onSettings?.invoke(low ?: 0, high ?: 0, enabled ?: true)
+            if (low != null || high != null || enabled != null) {
+                onSettings?.invoke(low, high, enabled)
+            }
+            extractInt(body, "budgetMs")?.let { onFrameBudget?.invoke(PRIMARY_STREAM_ID, it) }
+            extractString(body, "placement")?.let { onPlacement?.invoke(it) }
+            extractBoolean(body, "syntheticStream")?.let { onSyntheticStream?.invoke(it) }
+            extractString(body, "engine")?.let { onEngine?.invoke(PRIMARY_STREAM_ID, it) }
+            extractString(body, "detector")?.let { onDetector?.invoke(PRIMARY_STREAM_ID, it) }
+            extractString(body, "hysteresis")?.let { onHysteresis?.invoke(PRIMARY_STREAM_ID, it) }
+            extractDouble(body, "contourEpsilon")?.let { onContourEpsilon?.invoke(PRIMARY_STREAM_ID, it) }
+            extractBoolean(body, "segments")?.let { onSegments?.invoke(PRIMARY_STREAM_ID, it) }
+            extractInt(body, "stabilize")?.let { onStabilize?.invoke(PRIMARY_STREAM_ID, it) }
+            extractBoolean(body, "colorEdges")?.let { onColorEdges?.invoke(PRIMARY_STREAM_ID, it) }
+            applyStatsGrid(body, PRIMARY_STREAM_ID)
             val res = newFixedLengthResponse(Response.Status.OK, "application/json", "{\"ok\":true}")
             addCors(res)
             res
@@ -111,6 +390,32 @@ class FrameServer(port: Int) : NanoHTTPD(port) {
         return sb.toString().toIntOrNull()
     }
 
+    private fun extractDouble(json: String, key: String): Double? {
+        val idx = json.indexOf("\"$key\"")
+        if (idx < 0) return null
+        val colon = json.indexOf(":", idx)
+        if (colon < 0) return null
+        var end = colon + 1
+        while (end < json.length && json[end].isWhitespace()) end++
+        val sb = StringBuilder()
+        while (end < json.length && (json[end].isDigit() || json[end] == '.' || json[end] == '-')) {
+            sb.append(json[end])
+            end++
+        }
+        return sb.toString().toDoubleOrNull()
+    }
+
+    private fun extractString(json: String, key: String): String? {
+        val idx = json.indexOf("\"$key\"")
+        if (idx < 0) return null
+        val colon = json.indexOf(":", idx)
+        if (colon < 0) return null
+        val start = json.indexOf("\"", colon + 1)
+        if (start < 0) return null
+        val end = json.indexOf("\"", start + 1)
+        if (end < 0) return null
+        return json.substring(start + 1, end)
+    }
     private fun extractBoolean(json: String, key: String): Boolean? {
         val idx = json.indexOf("\"$key\"")
         if (idx < 0) return null
@@ -129,5 +434,6 @@ class FrameServer(port: Int) : NanoHTTPD(port) {
         response.addHeader("Access-Control-Allow-Origin", "*")
         response.addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS")
         response.addHeader("Access-Control-Allow-Headers", "Content-Type")
+        response.addHeader("Access-Control-Expose-Headers", (FRAME_INFO_HEADERS + SERVER_TIME_HEADER).joinToString(", "))
     }
 }
\ No newline at end of file
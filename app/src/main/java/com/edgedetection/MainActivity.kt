@@ -19,15 +19,11 @@ import android.widget.Button
 import android.widget.SeekBar
 import android.widget.TextView
 import android.widget.Toast
-import android.graphics.Bitmap
-import java.io.ByteArrayOutputStream
 import androidx.appcompat.app.AppCompatActivity
 import androidx.core.app.ActivityCompat
 import androidx.core.content.ContextCompat
 import org.opencv.android.OpenCVLoader
 import java.nio.ByteBuffer
-import java.util.concurrent.BlockingQueue
-import java.util.concurrent.LinkedBlockingQueue
 import java.util.concurrent.atomic.AtomicLong
 import kotlin.math.min
 
@@ -36,13 +32,75 @@ class MainActivity : AppCompatActivity() {
     companion object {
         private const val CAMERA_PERMISSION_REQUEST_CODE = 200
         private var isNativeLibraryLoaded = false
+        // Capture-to-output latency budget of the primary stream; the native frame scheduler
+        // degrades or drops frames to stay within it instead of throttling to a fixed FPS
+        private const val DEFAULT_FRAME_BUDGET_MS = 66
         
         // Native methods for frame processing
         external fun stringFromJNI(): String
         external fun processFrameNative(frameData: ByteArray, width: Int, height: Int, rowStride: Int, pixelStride: Int)
-        external fun processFrameAndReturn(frameData: ByteArray, width: Int, height: Int, rowStride: Int, pixelStride: Int): ByteArray?
+        // Timestamps are elapsedRealtimeNanos(); sensorTimestampNs is 0 when the camera clock is not comparable
+        external fun processFrameAndReturn(frameData: ByteArray, width: Int, height: Int, rowStride: Int, pixelStride: Int,
+                                           sensorTimestampNs: Long, enqueueTimeNs: Long): ByteArray?
         external fun initializeOpenCV(): Boolean
         external fun setCannyThresholds(low: Double, high: Double)
+        // Async camera processing: submitFrame copies into the native frame ring and returns a ticket
+        // (0 if rejected); results arrive on a native completion thread via the listener. The U/V
+        // planes are only read while the stream has colour edges on.
+        external fun submitFrame(yBuffer: ByteBuffer, width: Int, height: Int, rowStride: Int, pixelStride: Int,
+                                 sensorTimestampNs: Long, uBuffer: ByteBuffer?, vBuffer: ByteBuffer?,
+                                 uvRowStride: Int, uvPixelStride: Int): Long
+        external fun startAsyncProcessing(listener: FrameCompletionListener): Boolean
+        external fun stopAsyncProcessing()
+        // Return an edge array from onFrameProcessed for reuse by a later completion
+        external fun releaseProcessedFrame(edges: ByteArray)
+        external fun getFrameRingStats(): String
+        // Native buffer pool: live/peak bytes and allocation counts
+        external fun getMemoryStats(): String
+        // Per-stream outputs; info receives [width, height, generation]
+        external fun getStreamJpeg(streamId: Int, info: LongArray): ByteArray?
+        external fun getStreamPng(streamId: Int, info: LongArray): ByteArray?
+        external fun getStreamPacked(streamId: Int, info: LongArray): ByteArray?
+        // Edge chains simplified with approxPolyDP, as varint/delta-coded polylines
+        external fun getStreamContours(streamId: Int, info: LongArray): ByteArray?
+        external fun awaitEncodedJpeg(streamId: Int, lastGeneration: Long, timeoutMs: Int, info: LongArray): ByteArray?
+        // Native JPEG encoding runs only for subscribed (or recently polled) streams
+        external fun setStreamSubscribed(streamId: Int, subscribed: Boolean)
+        // Stream registry: additional sources (e.g. SyntheticFrameSource) are processed on the
+        // shared native workers
+        external fun submitStreamFrame(streamId: Int, frameData: ByteArray, width: Int, height: Int, rowStride: Int,
+                                       sensorTimestampNs: Long): Boolean
+        // A negative threshold leaves that one unchanged
+        external fun setStreamThresholds(streamId: Int, low: Double, high: Double)
+        external fun setFrameBudget(streamId: Int, budgetMs: Int)
+        // Native worker placement on big.LITTLE: "off", "split" (default) or "performance"
+        external fun setThreadPlacement(policy: String): Boolean
+        external fun getThreadPlacementStats(): String
+        // Detection engine per stream: "imperative", "gapi" (G-API graph on the Fluid backend)
+        // "streaming" (pipelined G-API streaming graph behind submitFrame) or "fixed"
+        // (fused integer blur + Sobel, bit-exact with "imperative")
+        external fun setProcessingEngine(streamId: Int, engine: String): Boolean
+        // Edge detector per stream: "canny" (default), "sobel", "scharr", "laplacian" or "dog"
+        external fun setEdgeDetector(streamId: Int, detector: String): Boolean
+        // Canny weak-edge linking per stream: "opencv" (default) or "unionfind" (parallel
+        // connected components, same output)
+        external fun setHysteresisEngine(streamId: Int, engine: String): Boolean
+        // approxPolyDP tolerance in pixels for getStreamContours (<= 0 keeps every pixel)
+        external fun setContourEpsilon(streamId: Int, epsilon: Double)
+        // Line segments (HoughLinesP validated by Canny's gradients, tracked across frames)
+        external fun setSegmentsEnabled(streamId: Int, enabled: Boolean)
+        external fun getStreamSegments(streamId: Int): String?
+        // Per-frame edge stats (count, bounding box, grid densities, mean gradient), gathered
+        // while the edge map is packed
+        external fun setStatsGrid(streamId: Int, cols: Int, rows: Int)
+        // Temporal stabilization: frames an edge must persist for before it is output (0 = off)
+        external fun setEdgeStabilization(streamId: Int, frames: Int)
+        // Colour-aware Canny from the U/V planes (async camera path only)
+        external fun setColorEdges(streamId: Int, enabled: Boolean)
+        external fun getStreamEdgeStats(streamId: Int): String?
+        external fun removeStream(streamId: Int): Boolean
+        external fun listStreams(): IntArray
+        external fun getStreamStatus(streamId: Int): String?
         
         fun loadNativeLibrary(): Boolean {
             if (!isNativeLibraryLoaded) {
@@ -76,39 +134,44 @@ class MainActivity : AppCompatActivity() {
     private var backgroundThread: HandlerThread? = null
     private var backgroundHandler: Handler? = null
     private var isEdgeDetectionEnabled = false
+    // U/V planes are handed to native only while the primary stream uses colour edges
+    @Volatile private var primaryColorEdges = false
     private var activeCameraId: String? = null
+    // Camera timestamps share the elapsedRealtimeNanos() clock only with a REALTIME source
+    private var sensorTimestampsComparable = false
     private lateinit var fpsTextView: TextView
     private var uiHandler: Handler? = null
     // HTTP frame server
     private var frameServer: FrameServer? = null
+    // Moves JPEGs from the native encode workers into the frame server
+    private var publisherThread: Thread? = null
+    @Volatile private var isPublisherRunning = false
+    
+    // Secondary stream from a test pattern, toggled through /settings "syntheticStream"
+    private val syntheticSource = SyntheticFrameSource(FrameServer.SYNTHETIC_STREAM_ID)
     
     // Frame capture components
     private var imageReader: ImageReader? = null
     private val frameWidth = 1280
     private val frameHeight = 720
     
-    // Processing thread components
-    private var processingThread: HandlerThread? = null
-    private var processingHandler: Handler? = null
-    private val frameQueue: BlockingQueue<FrameData> = LinkedBlockingQueue(1) // Limit queue size to 1 for stronger backpressure
+    // Called on the native completion thread for every processed camera frame
+    private val frameCompletionListener = object : FrameCompletionListener {
+        override fun onFrameProcessed(ticket: Long, edges: ByteArray, width: Int, height: Int) {
+            processedFrameCount.incrementAndGet()
+            // The renderer keeps one frame; the one it lets go of is reused natively
+            edgeRenderer.updateProcessedFrame(edges, width, height)?.let { releaseProcessedFrame(it) }
+            // JPEG encoding runs on native workers; see startPublisherThread()
+            frameServer?.updateStatus("running")
+            // Skip native JPEG encoding entirely when nobody is watching
+            setStreamSubscribed(FrameServer.PRIMARY_STREAM_ID, frameServer?.hasViewers() == true)
+        }
+    }
     
     // Performance monitoring
     private val frameCount = AtomicLong(0)
     private val processedFrameCount = AtomicLong(0)
     private var lastFpsTime = System.currentTimeMillis()
-    private var lastProcessTime = System.currentTimeMillis()
-    private val targetFps = 15.0 // Target ~15 FPS for processing only to stabilize under load
-    private val minFrameInterval = (1000.0 / targetFps).toLong() // ~66ms between processed frames when targetFps=15
-    
-    // Frame data class for queue
-    data class FrameData(
-        val data: ByteArray,
-        val width: Int,
-        val height: Int,
-        val rowStride: Int,
-        val pixelStride: Int,
-        val timestamp: Long
-    )
     
     // OpenCV Manager callback
     // OpenCV is initialized via OpenCVLoader.initDebug() in onResume()
@@ -163,7 +226,6 @@ class MainActivity : AppCompatActivity() {
 
         // Setup ImageReader and processing
         setupImageReader()
-        startProcessingThread()
     }
 
     override fun onResume() {
@@ -179,6 +241,7 @@ class MainActivity : AppCompatActivity() {
         if (!ok) {
             Toast.makeText(this, "Failed to initialize edge detection.", Toast.LENGTH_LONG).show()
         }
+        startProcessing()
         // No TextureView. Open camera immediately.
         openCamera()
         glSurfaceView.onResume()
@@ -189,14 +252,17 @@ class MainActivity : AppCompatActivity() {
         uiHandler?.post(fpsUpdateRunnable)
         // Start HTTP frame server
         startFrameServer()
+        startPublisherThread()
     }
 
     override fun onPause() {
         glSurfaceView.onPause()
         closeCamera()
         stopBackgroundThread()
-        stopProcessingThread()
+        stopProcessing()
+        syntheticSource.stop()
         // Stop HTTP frame server
+        stopPublisherThread()
         stopFrameServer()
         super.onPause()
     }
@@ -211,6 +277,9 @@ class MainActivity : AppCompatActivity() {
         try {
             val cameraId = manager.cameraIdList[0]
             activeCameraId = cameraId
+            sensorTimestampsComparable = manager.getCameraCharacteristics(cameraId)
+                .get(CameraCharacteristics.SENSOR_INFO_TIMESTAMP_SOURCE) ==
+                CameraCharacteristics.SENSOR_INFO_TIMESTAMP_SOURCE_REALTIME
             manager.openCamera(cameraId, stateCallback, backgroundHandler)
         } catch (e: CameraAccessException) {
             e.printStackTrace()
@@ -250,13 +319,30 @@ class MainActivity : AppCompatActivity() {
     }
     
     private fun processFrame(image: Image) {
-        // Always enqueue/update original frame to renderer at full rate; throttle only processed frames
-        val currentTime = System.currentTimeMillis()
+        // Always enqueue/update original frame to renderer at full rate; the native frame
+        // scheduler decides how (and whether) each pushed frame is processed
         frameCount.incrementAndGet()
         try {
             val planes = image.planes
             val yPlane = planes[0]
             val yBuffer = yPlane.buffer
+            if (isEdgeDetectionEnabled) {
+                // Copied natively from the direct buffer into a preallocated ring slot and processed
+                // asynchronously; the ring overwrites the oldest unprocessed frame to minimize latency
+                val withChroma = primaryColorEdges
+                submitFrame(
+                    yBuffer,
+                    image.width,
+                    image.height,
+                    yPlane.rowStride,
+                    yPlane.pixelStride,
+                    if (sensorTimestampsComparable) image.timestamp else 0L,
+                    if (withChroma) planes[1].buffer else null,
+                    if (withChroma) planes[2].buffer else null,
+                    planes[1].rowStride,
+                    planes[1].pixelStride
+                )
+            }
             val ySize = yBuffer.remaining()
             val yArray = ByteArray(ySize)
             yBuffer.get(yArray)
@@ -267,24 +353,6 @@ class MainActivity : AppCompatActivity() {
                 image.height,
                 yPlane.rowStride
             )
-            // Clear pending processed to avoid showing stale frames when toggling rapidly
-            if (!isEdgeDetectionEnabled) {
-                // If disabled, do not enqueue processed frames
-            } else if (currentTime - lastProcessTime >= minFrameInterval) {
-                val frameData = FrameData(
-                    yArray,
-                    image.width,
-                    image.height,
-                    yPlane.rowStride,
-                    yPlane.pixelStride,
-                    currentTime
-                )
-                frameQueue.poll() // drop any queued older frame to minimize latency
-                if (!frameQueue.offer(frameData)) {
-                    android.util.Log.d("MainActivity", "Frame queue full, dropping processed frame")
-                }
-                lastProcessTime = currentTime
-            }
         } catch (e: Exception) {
             android.util.Log.e("MainActivity", "Error processing frame: ${e.message}")
         }
@@ -386,63 +454,24 @@ class MainActivity : AppCompatActivity() {
         imageReader = null
     }
 
-    private fun startProcessingThread() {
-        processingThread = HandlerThread("Frame Processing")
-        processingThread?.start()
-        processingHandler = Handler(processingThread?.looper!!)
-        
-        // Start the frame processing loop
-        processingHandler?.post(frameProcessingRunnable)
-    }
-    
-    private fun stopProcessingThread() {
-        frameQueue.clear()
-        processingThread?.quitSafely()
+    private fun startProcessing() {
         try {
-            processingThread?.join()
-            processingThread = null
-            processingHandler = null
-        } catch (e: InterruptedException) {
-            e.printStackTrace()
+            setFrameBudget(FrameServer.PRIMARY_STREAM_ID, DEFAULT_FRAME_BUDGET_MS)
+            // Detection runs on a native completion thread; no Java processing thread is needed
+            if (!startAsyncProcessing(frameCompletionListener)) {
+                android.util.Log.w("MainActivity", "Async processing already running")
+            }
+        } catch (t: Throwable) {
+            android.util.Log.e("MainActivity", "startAsyncProcessing error: ${t.message}")
         }
     }
     
-    private val frameProcessingRunnable = object : Runnable {
-        override fun run() {
-            try {
-                val frameData = frameQueue.take()
-                if (isEdgeDetectionEnabled) {
-                    try {
-                        val nativeResult = processFrameAndReturn(
-                            frameData.data,
-                            frameData.width,
-                            frameData.height,
-                            frameData.rowStride,
-                            frameData.pixelStride
-                        )
-                        if (nativeResult != null) {
-                            edgeRenderer.updateProcessedFrame(nativeResult, frameData.width, frameData.height)
-                            // Publish JPEG to HTTP server
-                            val jpeg = grayscaleToJpeg(nativeResult, frameData.width, frameData.height)
-                            frameServer?.updateFrameJpeg(jpeg)
-                            frameServer?.updateStatus("running")
-                        }
-                    } catch (e: Exception) {
-                        android.util.Log.e("MainActivity", "Native processing error: ${e.message}")
-                        frameServer?.updateStatus("error: ${e.message}")
-                    }
-                }
-                // Throttle re-posting to approximate target processed FPS under load
-                val delayMs = minFrameInterval
-                processingHandler?.postDelayed(this, delayMs)
-                processedFrameCount.incrementAndGet()
-            } catch (e: InterruptedException) {
-                android.util.Log.d("MainActivity", "Processing thread interrupted")
-            } catch (e: Exception) {
-                android.util.Log.e("MainActivity", "Error in processing thread: ${e.message}")
-                // Reschedule with delay to avoid tight loop on errors
-                processingHandler?.postDelayed(this, minFrameInterval)
-            }
+    private fun stopProcessing() {
+        // Joins the completion thread and drops frames still in the ring
+        try {
+            stopAsyncProcessing()
+        } catch (t: Throwable) {
+            android.util.Log.e("MainActivity", "stopAsyncProcessing error: ${t.message}")
         }
     }
 
@@ -508,42 +537,194 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
-    private fun grayscaleToJpeg(gray: ByteArray, width: Int, height: Int, quality: Int = 70): ByteArray? {
-    return try {
-        val rgbaSize = width * height * 4
-        val rgba = ByteArray(rgbaSize)
-        var dst = 0
-        for (i in gray.indices) {
-            val g = gray[i].toInt() and 0xFF
-            val b = g.toByte()
-            rgba[dst] = b
-            rgba[dst + 1] = b
-            rgba[dst + 2] = b
-            rgba[dst + 3] = 0xFF.toByte()
-            dst += 4
+    private fun safeNativeFrame(block: () -> ByteArray?): ByteArray? {
+        return try {
+            block()
+        } catch (t: Throwable) {
+            android.util.Log.e("MainActivity", "native frame error: ${t.message}")
+            null
         }
-        val bmp = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
-        val buffer = java.nio.ByteBuffer.wrap(rgba)
-        bmp.copyPixelsFromBuffer(buffer)
-        val baos = ByteArrayOutputStream()
-        bmp.compress(Bitmap.CompressFormat.JPEG, quality, baos)
-        bmp.recycle()
-        baos.toByteArray()
-    } catch (t: Throwable) {
-        android.util.Log.e("MainActivity", "grayscaleToJpeg error: ${t.message}")
-        null
     }
-}
+
+    private fun startPublisherThread() {
+        if (publisherThread != null) return
+        isPublisherRunning = true
+        publisherThread = Thread({
+            val info = LongArray(FrameServer.FRAME_INFO_SIZE)
+            var lastGeneration = 0L
+            while (isPublisherRunning) {
+                try {
+                    val jpeg = awaitEncodedJpeg(FrameServer.PRIMARY_STREAM_ID, lastGeneration, 500, info)
+                    if (jpeg != null) {
+                        lastGeneration = info[2]
+                        frameServer?.updateFrameJpeg(jpeg, info.copyOf())
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "publisher error: ${t.message}")
+                    Thread.sleep(100)
+                }
+            }
+        }, "Frame Publisher")
+        publisherThread?.start()
+    }
+
+    private fun stopPublisherThread() {
+        isPublisherRunning = false
+        try {
+            publisherThread?.join()
+        } catch (e: InterruptedException) {
+            e.printStackTrace()
+        }
+        publisherThread = null
+    }
 
 private fun startFrameServer() {
     try {
         if (frameServer == null) {
             frameServer = FrameServer(8081)
-            frameServer?.onSettings = { low, high, enabled ->
+            frameServer?.jpegProvider = { id, info -> safeNativeFrame { getStreamJpeg(id, info) } }
+            frameServer?.pngProvider = { id, info -> safeNativeFrame { getStreamPng(id, info) } }
+            frameServer?.packedProvider = { id, info -> safeNativeFrame { getStreamPacked(id, info) } }
+            frameServer?.contoursProvider = { id, info -> safeNativeFrame { getStreamContours(id, info) } }
+            frameServer?.streamsProvider = {
+                try { listStreams() } catch (t: Throwable) { IntArray(0) }
+            }
+            frameServer?.streamStatusProvider = { id ->
+                try { getStreamStatus(id) } catch (t: Throwable) { null }
+            }
+            frameServer?.segmentsProvider = { id ->
+                try { getStreamSegments(id) } catch (t: Throwable) { null }
+            }
+            frameServer?.edgeStatsProvider = { id ->
+                try { getStreamEdgeStats(id) } catch (t: Throwable) { null }
+            }
+            frameServer?.ingestStatsProvider = {
+                try { getFrameRingStats() } catch (t: Throwable) { null }
+            }
+            frameServer?.memoryStatsProvider = {
+                try { getMemoryStats() } catch (t: Throwable) { null }
+            }
+            frameServer?.placementStatsProvider = {
+                try { getThreadPlacementStats() } catch (t: Throwable) { null }
+            }
+            frameServer?.onEngine = { id, engine ->
+                try {
+                    if (!setProcessingEngine(id, engine)) {
+                        android.util.Log.w("MainActivity", "Processing engine not available: $engine")
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setProcessingEngine error: ${t.message}")
+                }
+            }
+            frameServer?.onDetector = { id, detector ->
+                try {
+                    if (!setEdgeDetector(id, detector)) {
+                        android.util.Log.w("MainActivity", "Unknown edge detector: $detector")
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setEdgeDetector error: ${t.message}")
+                }
+            }
+            frameServer?.onHysteresis = { id, engine ->
+                try {
+                    if (!setHysteresisEngine(id, engine)) {
+                        android.util.Log.w("MainActivity", "Unknown hysteresis engine: $engine")
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setHysteresisEngine error: ${t.message}")
+                }
+            }
+            frameServer?.onContourEpsilon = { id, epsilon ->
+                try {
+                    setContourEpsilon(id, epsilon)
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setContourEpsilon error: ${t.message}")
+                }
+            }
+            frameServer?.onSegments = { id, enabled ->
+                try {
+                    setSegmentsEnabled(id, enabled)
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setSegmentsEnabled error: ${t.message}")
+                }
+            }
+            frameServer?.onStabilize = { id, frames ->
+                try {
+                    setEdgeStabilization(id, frames)
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setEdgeStabilization error: ${t.message}")
+                }
+            }
+            frameServer?.onColorEdges = { id, enabled ->
+                try {
+                    setColorEdges(id, enabled)
+                    if (id == FrameServer.PRIMARY_STREAM_ID) {
+                        primaryColorEdges = enabled
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setColorEdges error: ${t.message}")
+                }
+            }
+            frameServer?.onStatsGrid = { id, cols, rows ->
+                try {
+                    setStatsGrid(id, cols, rows)
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setStatsGrid error: ${t.message}")
+                }
+            }
+            frameServer?.onPlacement = { policy ->
+                try {
+                    if (!setThreadPlacement(policy)) {
+                        android.util.Log.w("MainActivity", "Unknown thread placement policy: $policy")
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setThreadPlacement error: ${t.message}")
+                }
+            }
+            frameServer?.onSyntheticStream = { enabled ->
+                try {
+                    if (enabled) {
+                        syntheticSource.start()
+                    } else {
+                        syntheticSource.stop()
+                    }
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "synthetic stream error: ${t.message}")
+                }
+            }
+            frameServer?.onStreamSettings = { id, low, high ->
+                if (id == FrameServer.PRIMARY_STREAM_ID) {
+                    frameServer?.onSettings?.invoke(low, high, null)
+                } else {
+                    try {
+                        // Negative keeps the stream's current threshold
+                        setStreamThresholds(id, (low ?: -1).toDouble(), (high ?: -1).toDouble())
+                    } catch (t: Throwable) {
+                        android.util.Log.e("MainActivity", "setStreamThresholds error: ${t.message}")
+                    }
+                }
+            }
+            frameServer?.onFrameBudget = { id, budgetMs ->
+                try {
+                    setFrameBudget(id, budgetMs)
+                } catch (t: Throwable) {
+                    android.util.Log.e("MainActivity", "setFrameBudget error: ${t.message}")
+                }
+            }
+            frameServer?.onSettings = { newLow, newHigh, newEnabled ->
                 runOnUiThread {
                     try {
+                        // Fields missing from the request keep their current values
+                        val lowSeek = findViewById<SeekBar>(R.id.lowThresholdSeekBar)
+                        val highSeek = findViewById<SeekBar>(R.id.highThresholdSeekBar)
+                        val low = newLow ?: lowSeek.progress
+                        val high = newHigh ?: highSeek.progress
+                        val enabled = newEnabled ?: isEdgeDetectionEnabled
                         isEdgeDetectionEnabled = enabled
                         edgeRenderer.setShowProcessedFrame(enabled)
+                        // Keep the sliders in step, so they stay the current values
+                        lowSeek.progress = low
+                        highSeek.progress = high
                         safeSetCannyThresholds(low.toDouble(), high.toDouble())
                         // Update UI labels and toggle button text
                         findViewById<android.widget.TextView>(R.id.lowThresholdLabel).text = "Low Threshold: $low"
@@ -0,0 +1,85 @@
+package com.edgedetection
+
+import android.os.SystemClock
+import android.util.Log
+
+/**
+ * Test-pattern source for a secondary native stream.
+ *
+ * Renders a moving pattern (gradient, bars and a bouncing block) as a Y plane on its
+ * own thread and feeds it through submitStreamFrame, so the stream registry's shared
+ * workers, the per-stream endpoints and their settings can be exercised next to the
+ * camera without a second camera.
+ */
+class SyntheticFrameSource(
+    val streamId: Int,
+    private val width: Int = 640,
+    private val height: Int = 360,
+    private val fps: Int = 15
+) {
+    private var thread: Thread? = null
+    @Volatile private var running = false
+
+    val isRunning: Boolean
+        get() = running
+
+    fun start() {
+        if (running) return
+        running = true
+        thread = Thread({ loop() }, "synthetic-stream-$streamId").also { it.start() }
+        Log.i(TAG, "Started synthetic stream $streamId (${width}x$height @ $fps fps)")
+    }
+
+    fun stop() {
+        if (!running) return
+        running = false
+        thread?.join(1000)
+        thread = null
+        Log.i(TAG, "Stopped synthetic stream $streamId")
+    }
+
+    private fun loop() {
+        // One frame buffer for the lifetime of the source; the native side copies it
+        val frame = ByteArray(width * height)
+        val frameIntervalMs = 1000L / fps
+        var index = 0
+        while (running) {
+            val start = SystemClock.elapsedRealtime()
+            render(frame, index++)
+            try {
+                MainActivity.submitStreamFrame(streamId, frame, width, height, width, SystemClock.elapsedRealtimeNanos())
+            } catch (t: Throwable) {
+                Log.e(TAG, "submitStreamFrame error: ${t.message}")
+            }
+            val sleepMs = frameIntervalMs - (SystemClock.elapsedRealtime() - start)
+            if (sleepMs > 0) {
+                try {
+                    Thread.sleep(sleepMs)
+                } catch (e: InterruptedException) {
+                    break
+                }
+            }
+        }
+    }
+
+    private fun render(frame: ByteArray, index: Int) {
+        val blockSize = height / 4
+        val blockX = (index * 6) % (width - blockSize)
+        val blockY = (index * 4) % (height - blockSize)
+        for (y in 0 until height) {
+            val row = y * width
+            for (x in 0 until width) {
+                // Diagonal gradient with vertical bars drifting across it
+                var value = (x + y) / 4 + if (((x + index * 2) / 32) % 2 == 0) 0 else 96
+                if (x >= blockX && x < blockX + blockSize && y >= blockY && y < blockY + blockSize) {
+                    value = 240
+                }
+                frame[row + x] = value.coerceAtMost(255).toByte()
+            }
+        }
+    }
+
+    companion object {
+        private const val TAG = "SyntheticFrameSource"
+    }
+}